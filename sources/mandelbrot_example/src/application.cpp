@@ -1,13 +1,472 @@
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <charconv>
 #include "vk_computing.hpp"
+#include "tile_server.hpp"
 
-int main()
+namespace
 {
+void usage(char const* program)
+{
+    std::cerr << "Usage : " << program << " [--interieur] [--periodicite] [--taille largeur hauteur] [--centre x y]" << std::endl
+              << "        [--etendue e] [--iterations M] [--zooms N] [--reprise M2] [--profond x y e]" << std::endl
+              << "        [--precision] [--sortie rgba32f|rgba8|iterations16|carte] [--lisse] [--distance]" << std::endl
+              << "        [--couleurs] [--anticrenelage S] [--persistants] [--corendu] [--animation N F]" << std::endl
+              << "        [--serveur port] [--fractale mandelbrot|julia|bateau] [--puissance d] [--julia x y]" << std::endl
+              << "        [--geante largeur hauteur] [--instrumentation] [--subdivision]" << std::endl
+              << "        [--verification]" << std::endl;
+}
+// Lit un nombre (entier ou réel selon le type de value) occupant tout le texte
+template<typename T> bool parse_number(std::string_view text, T& value)
+{
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size() && not text.empty();
+}
+}
+
+int main(int nargs, char* argv[])
+{
+    // Options : --interieur (test cardioïde/bourgeon) et --periodicite (détection de cycle), combinables
+    //           --taille, --centre, --etendue et --iterations pour les paramètres du rendu
+    //           --zooms N pour enchaîner N rendus GPU supplémentaires (zoom x2 à chaque fois) avec le même pipeline
+    //           --reprise M2 pour reprendre le calcul jusqu'à M2 itérations (seulement les pixels n'ayant pas divergé)
+    //           --profond x y e pour un zoom profond par perturbation centré en (x, y) (décimaux de précision
+    //                           arbitraire) et d'étendue e (taille et nombre d'itérations donnés par --taille et --iterations)
+    //           --precision pour comparer les arithmétiques simple, double simple (émulée) et double sur la fenêtre
+    //                       demandée (centre et étendue lus en double précision) et choisir la mieux adaptée
+    //           --sortie f pour le format de l'image calculée (couleurs en flottants ou sur 4 octets, ou nombres
+    //                      d'itérations sur 2 octets) par le noyau CPU et le shader principal
+    //           --lisse pour la coloration continue (nombre d'itérations normalisé) du calcul CPU et du shader principal
+    //           --distance pour assombrir les couleurs près du bord d'après l'estimation de la distance (dérivée dz/dc
+    //                      itérée avec z), ce qui fait apparaître les filaments sans suréchantillonnage
+    //           --couleurs pour un rendu en deux passes : carte des nombres d'itérations calculée une fois puis mise en
+    //                      couleur avec plusieurs palettes (dont l'égalisation d'histogramme), sur CPU et sur GPU
+    //           --anticrenelage S pour un anticrénelage adaptatif : SxS points dans les seuls pixels des bords, comparé
+    //                             au suréchantillonnage uniforme
+    //           --persistants pour comparer sur GPU la répartition statique des tuiles à des threads persistants
+    //                         prenant les tuiles dans un compteur atomique
+    //           --corendu pour calculer l'image à la fois sur CPU et sur GPU (bandes de lignes partagées)
+    //           --animation N F pour une animation de zoom de N images calculées sur GPU avec F images en vol
+    //           --serveur port pour servir des tuiles calculées sur GPU en HTTP sur 127.0.0.1:port (jusqu'à GET /arret)
+    //           --fractale, --puissance d et --julia x y pour calculer une autre fractale de la famille (julia de
+    //                       constante x + iy, burning ship, exposant d) avec le noyau CPU générique et le shader principal
+    //           --geante L H pour calculer sur GPU une image L x H par bandes écrites au fur et à mesure dans le png
+    //                        (mémoire indépendante de la hauteur de l'image)
+    //           --instrumentation pour relever le coût de chaque tuile (CPU et GPU) et la charge de chaque thread CPU,
+    //                             exportés en cartes de chaleur et en résumé JSON
+    //           --subdivision pour calculer l'image CPU par subdivision de Mariani-Silver (comparée au calcul pixel
+    //                         par pixel)
+    //           --verification pour comparer aussi sur CPU le noyau générique des familles de fractales aux noyaux
+    //                          dédiés à l'ensemble de mandelbrot usuel
+    unsigned shortcuts = mandelbrot::no_shortcut;
+    mandelbrot::View view;
+    int nb_zooms = 0;
+    int resume_max_iter = 0;
+    bool deep_zoom = false;
+    bool compare_precisions = false;
+    mandelbrot::PreciseView precise_view;
+    mandelbrot::DeepView deep_view;
+    mandelbrot::OutputFormat output_format = mandelbrot::OutputFormat::rgba8;
+    bool smooth_coloring = false;
+    bool distance_estimation = false;
+    mandelbrot::FractalFamily fractal;
+    bool recolor = false;
+    int antialiasing_samples = 0;
+    bool persistent_threads = false;
+    bool co_rendering = false;
+    bool profiling = false;
+    bool subdivision = false;
+    bool verification = false;
+    int nb_animation_frames = 0;
+    int frames_in_flight = 0;
+    int server_port = 0;
+    mandelbrot::View giant_view{0, 0};
+    for (int i = 1; i < nargs; ++i)
+    {
+        std::string arg(argv[i]);
+        bool valid = true; // Faux si l'option est inconnue ou si l'un de ses nombres est illisible
+        if (arg == "--interieur")
+            shortcuts |= mandelbrot::interior_test;
+        else if (arg == "--periodicite")
+            shortcuts |= mandelbrot::periodicity_test;
+        else if (arg == "--taille" && i + 2 < nargs)
+        {
+            valid = parse_number(argv[++i], view.width) &&
+                    parse_number(argv[++i], view.height);
+        }
+        else if (arg == "--centre" && i + 2 < nargs)
+        {
+            valid = parse_number(argv[++i], precise_view.center_x) &&
+                    parse_number(argv[++i], precise_view.center_y);
+            view.center_x = float(precise_view.center_x);
+            view.center_y = float(precise_view.center_y);
+        }
+        else if (arg == "--etendue" && i + 1 < nargs)
+        {
+            valid = parse_number(argv[++i], precise_view.extent);
+            view.extent = float(precise_view.extent);
+        }
+        else if (arg == "--iterations" && i + 1 < nargs)
+            valid = parse_number(argv[++i], view.max_iter);
+        else if (arg == "--zooms" && i + 1 < nargs)
+            valid = parse_number(argv[++i], nb_zooms);
+        else if (arg == "--reprise" && i + 1 < nargs)
+            valid = parse_number(argv[++i], resume_max_iter);
+        else if (arg == "--precision")
+            compare_precisions = true;
+        else if (arg == "--lisse")
+            smooth_coloring = true;
+        else if (arg == "--distance")
+            distance_estimation = true;
+        else if (arg == "--couleurs")
+            recolor = true;
+        else if (arg == "--persistants")
+            persistent_threads = true;
+        else if (arg == "--corendu")
+            co_rendering = true;
+        else if (arg == "--instrumentation")
+            profiling = true;
+        else if (arg == "--subdivision")
+            subdivision = true;
+        else if (arg == "--verification")
+            verification = true;
+        else if (arg == "--geante" && i + 2 < nargs)
+        {
+            valid = parse_number(argv[++i], giant_view.width) &&
+                    parse_number(argv[++i], giant_view.height);
+        }
+        else if (arg == "--serveur" && i + 1 < nargs)
+            valid = parse_number(argv[++i], server_port);
+        else if (arg == "--animation" && i + 2 < nargs)
+        {
+            valid = parse_number(argv[++i], nb_animation_frames) &&
+                    parse_number(argv[++i], frames_in_flight);
+        }
+        else if (arg == "--anticrenelage" && i + 1 < nargs)
+            valid = parse_number(argv[++i], antialiasing_samples);
+        else if (arg == "--fractale" && i + 1 < nargs)
+        {
+            std::string name(argv[++i]);
+            bool known = false;
+            for (auto kind : {mandelbrot::Fractal::mandelbrot, mandelbrot::Fractal::julia, mandelbrot::Fractal::burning_ship})
+                if (name == mandelbrot::fractal_name(kind)) { fractal.kind = kind; known = true; }
+            if (not known)
+            {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--puissance" && i + 1 < nargs)
+            valid = parse_number(argv[++i], fractal.power);
+        else if (arg == "--julia" && i + 2 < nargs)
+        {
+            fractal.kind    = mandelbrot::Fractal::julia;
+            valid = parse_number(argv[++i], fractal.julia_x) &&
+                    parse_number(argv[++i], fractal.julia_y);
+        }
+        else if (arg == "--sortie" && i + 1 < nargs)
+        {
+            std::string name(argv[++i]);
+            bool known = false;
+            for (auto format : {mandelbrot::OutputFormat::rgba32f, mandelbrot::OutputFormat::rgba8, mandelbrot::OutputFormat::iterations16,
+                                mandelbrot::OutputFormat::iteration_map})
+                if (name == mandelbrot::output_format_name(format)) { output_format = format; known = true; }
+            if (not known)
+            {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--profond" && i + 3 < nargs)
+        {
+            deep_zoom = true;
+            deep_view.center_x = argv[++i];
+            deep_view.center_y = argv[++i];
+            valid = parse_number(argv[++i], deep_view.extent);
+        }
+        else
+            valid = false;
+        if (not valid)
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (view.width <= 0 || view.height <= 0 || view.max_iter <= 0 || (resume_max_iter != 0 && resume_max_iter < view.max_iter) ||
+        (deep_zoom && not (deep_view.extent > 0.)) || antialiasing_samples < 0 || (nb_animation_frames > 0 && frames_in_flight <= 0) ||
+        server_port < 0 || server_port > 65535 || fractal.power < 2 || fractal.power > mandelbrot::max_fractal_power ||
+        giant_view.width < 0 || giant_view.height < 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (server_port > 0)
+    {
+        // Serveur de tuiles : un seul pipeline (format rgba8) répond à toutes les requêtes jusqu'à GET /arret
+        vulkan::ComputingPipeline tile_pipeline;
+        tile_pipeline.set_shortcuts(shortcuts);
+        tile_pipeline.set_smooth_coloring(smooth_coloring);
+        tile_pipeline.set_distance_estimation(distance_estimation);
+        tile_pipeline.set_fractal(fractal);
+        tile_pipeline.initialize();
+        {
+            // Un répertoire du cache par jeu d'options : une tuile n'est relue que si elle a été calculée de la même façon
+            std::filesystem::path cache_directory = std::filesystem::path("cache_tuiles") /
+                mandelbrot::tile_cache_name(fractal, shortcuts, smooth_coloring, distance_estimation);
+            mandelbrot::TileServer server(tile_pipeline, server_port, 1024, cache_directory);
+            std::cout << "Serveur de tuiles sur http://127.0.0.1:" << server_port << "/z/x/y.png" << std::endl << std::flush;
+            server.serve();
+            server.print_report(std::cout);
+        }
+        tile_pipeline.clean_up();
+        return EXIT_SUCCESS;
+    }
+
+    if (giant_view.width > 0 && giant_view.height > 0)
+    {
+        // Image géante : seules deux bandes de l'image sont en mémoire à la fois (format rgba8), l'image entière n'est
+        // ni calculée sur CPU ni gardée en mémoire
+        giant_view.center_x = view.center_x;
+        giant_view.center_y = view.center_y;
+        giant_view.extent   = view.extent;
+        giant_view.max_iter = view.max_iter;
+        vulkan::ComputingPipeline giant_pipeline;
+        giant_pipeline.set_shortcuts(shortcuts);
+        giant_pipeline.set_smooth_coloring(smooth_coloring);
+        giant_pipeline.set_distance_estimation(distance_estimation);
+        giant_pipeline.set_fractal(fractal);
+        giant_pipeline.initialize();
+        std::cout << "Rendu en bandes d'une image " << giant_view.width << "x" << giant_view.height << " sur GPU" << std::endl << std::flush;
+        giant_pipeline.render_streamed(giant_view, "mandelbrot_geante.png");
+        giant_pipeline.clean_up();
+        return EXIT_SUCCESS;
+    }
+
     vulkan::ComputingPipeline pipeline;
+    pipeline.set_shortcuts(shortcuts);
+    pipeline.set_view(view);
+    pipeline.set_output_format(output_format);
+    pipeline.set_smooth_coloring(smooth_coloring);
+    pipeline.set_distance_estimation(distance_estimation);
+    pipeline.set_fractal(fractal);
+    pipeline.set_subdivision(subdivision);
+    pipeline.set_verification(verification);
     std::cout << "Calcul mandelbrot sur CPU" << std::endl << std::flush;
     pipeline.cpu_computation();
     std::cout << "=============================================================================================================" << std::endl;
     std::cout << "Calcul mandelbrot sur GPU" << std::endl << std::flush;
-    pipeline.run();
+    if (shortcuts != mandelbrot::no_shortcut)
+    {
+        // Calcul de référence sans raccourci (son image n'est pas sauvegardée), puis, après chaque calcul chronométré,
+        // nombre d'itérations calculées relevé par le shader instrumenté (coût des tuiles, voir render_profiled)
+        vulkan::ComputingPipeline brute_pipeline;
+        brute_pipeline.set_view(view);
+        brute_pipeline.set_output_format(output_format);
+        brute_pipeline.set_smooth_coloring(smooth_coloring);
+        brute_pipeline.set_distance_estimation(distance_estimation);
+        brute_pipeline.set_fractal(fractal);
+        brute_pipeline.initialize();
+        double brute_time = brute_pipeline.render(view);
+        mandelbrot::IterationProfile brute_profile;
+        brute_pipeline.render_profiled(view, brute_profile);
+        brute_pipeline.clean_up();
+
+        pipeline.initialize();
+        double time = pipeline.render(view);
+        pipeline.save_gpu_image("mandelbrot_gpu.png");
+        mandelbrot::IterationProfile profile;
+        pipeline.render_profiled(view, profile);
+        pipeline.clean_up();
+        std::cout << "Accélération sur GPU due aux raccourcis : " << brute_time/time << std::endl;
+        std::cout << "Itérations calculées sur gpu : " << profile.work << " au lieu de " << brute_profile.work << " ("
+                  << 100.*double(brute_profile.work - profile.work)/double(brute_profile.work) << "% économisées)" << std::endl;
+    }
+    else
+        pipeline.run();
+
+    if (nb_zooms > 0)
+    {
+        // Série de zooms : le pipeline et le buffer sont créés une seule fois, seules les constantes poussées changent
+        std::cout << "=============================================================================================================" << std::endl;
+        std::cout << "Série de " << nb_zooms << " zooms sur GPU" << std::endl << std::flush;
+        pipeline.initialize();
+        mandelbrot::View zoom = view;
+        for (int k = 1; k <= nb_zooms; ++k)
+        {
+            zoom.extent *= 0.5f;
+            pipeline.render(zoom);
+            pipeline.save_gpu_image("mandelbrot_gpu_zoom_" + std::to_string(k) + ".png");
+        }
+        pipeline.clean_up();
+    }
+
+    if (nb_animation_frames > 0)
+    {
+        // Animation : instance, périphérique et pipeline sont créés une seule fois pour toutes les images
+        std::cout << "=============================================================================================================" << std::endl;
+        std::cout << "Animation de " << nb_animation_frames << " images sur GPU" << std::endl << std::flush;
+        pipeline.initialize();
+        pipeline.render_animation(view, nb_animation_frames, frames_in_flight, "mandelbrot_animation_");
+        pipeline.clean_up();
+    }
+
+    if (persistent_threads)
+    {
+        // Équilibrage de charge : un nombre fixe de groupes de travail prennent les tuiles une à une dans un compteur atomique
+        std::cout << "=============================================================================================================" << std::endl;
+        std::cout << "Threads persistants contre répartition statique sur GPU" << std::endl << std::flush;
+        pipeline.initialize();
+        uint32_t nb_workgroups = pipeline.benchmark_persistent(view);
+        if (nb_workgroups > 0)
+        {
+            pipeline.render_persistent(view, nb_workgroups);
+            pipeline.save_gpu_image("mandelbrot_gpu_persistants.png");
+        }
+        pipeline.clean_up();
+    }
+
+    if (co_rendering)
+    {
+        // Co-rendu : les threads CPU et le GPU se partagent les bandes de lignes d'une même image (format rgba8)
+        std::cout << "=============================================================================================================" << std::endl;
+        std::cout << "Co-rendu sur CPU et GPU" << std::endl << std::flush;
+        vulkan::ComputingPipeline co_pipeline;
+        co_pipeline.set_shortcuts(shortcuts);
+        co_pipeline.set_view(view);
+        co_pipeline.initialize();
+        co_pipeline.co_rendering_computation();
+        co_pipeline.clean_up();
+    }
+
+    if (profiling)
+    {
+        // Instrumentation : coût de chaque tuile sur CPU et sur GPU, charge de chaque thread sous schedule(dynamic)
+        std::cout << "=============================================================================================================" << std::endl;
+        std::cout << "Calcul instrumenté sur CPU et GPU" << std::endl << std::flush;
+        vulkan::ComputingPipeline profiling_pipeline;
+        profiling_pipeline.set_shortcuts(shortcuts);
+        profiling_pipeline.set_view(view);
+        profiling_pipeline.initialize();
+        profiling_pipeline.profiling_computation();
+        profiling_pipeline.clean_up();
+    }
+
+    if (recolor)
+    {
+        // Rendu en deux passes : la carte des nombres d'itérations est calculée une seule fois, puis mise en couleur
+        // (linéairement, par égalisation d'histogramme, avec plusieurs parcours de la palette) sans itérer de nouveau
+        using mandelbrot::ColorMapping;
+        std::vector<mandelbrot::Coloring> colorings{ {ColorMapping::linear, 1.f, 0.f}, {ColorMapping::equalized, 1.f, 0.f},
+                                                     {ColorMapping::linear, 8.f, 0.f}, {ColorMapping::equalized, 1.f, 0.5f} };
+        std::cout << "=============================================================================================================" << std::endl;
+        std::cout << "Rendu en deux passes sur CPU" << std::endl << std::flush;
+        pipeline.cpu_recolor_computation(colorings);
+        std::cout << "Rendu en deux passes sur GPU" << std::endl << std::flush;
+        vulkan::ComputingPipeline map_pipeline;
+        map_pipeline.set_shortcuts(shortcuts);
+        map_pipeline.set_smooth_coloring(smooth_coloring);
+        map_pipeline.set_output_format(mandelbrot::OutputFormat::iteration_map);
+        map_pipeline.initialize();
+        map_pipeline.render(view);
+        for (std::size_t k = 0; k < colorings.size(); ++k)
+        {
+            map_pipeline.recolor(colorings[k]);
+            map_pipeline.save_recolored_image("mandelbrot_gpu_couleurs_" + std::to_string(k + 1) + ".png");
+        }
+        map_pipeline.clean_up();
+    }
+
+    if (antialiasing_samples > 0)
+    {
+        // Anticrénelage adaptatif : seuls les pixels dont un voisin a un autre nombre d'itérations sont suréchantillonnés
+        std::cout << "=============================================================================================================" << std::endl;
+        std::cout << "Anticrénelage adaptatif " << antialiasing_samples << "x" << antialiasing_samples << " sur CPU" << std::endl << std::flush;
+        pipeline.cpu_antialiased_computation(antialiasing_samples);
+        std::cout << "Anticrénelage adaptatif " << antialiasing_samples << "x" << antialiasing_samples << " sur GPU" << std::endl << std::flush;
+        vulkan::ComputingPipeline antialiasing_pipeline;
+        antialiasing_pipeline.set_shortcuts(shortcuts);
+        antialiasing_pipeline.initialize();
+        double uniform_time = antialiasing_pipeline.render_antialiased(view, antialiasing_samples, false);
+        double adaptive_time = antialiasing_pipeline.render_antialiased(view, antialiasing_samples);
+        std::cout << "Coût de l'anticrénelage adaptatif sur GPU par rapport au suréchantillonnage uniforme : "
+                  << 100.*adaptive_time/uniform_time << "% du temps" << std::endl;
+        antialiasing_pipeline.save_gpu_image("mandelbrot_gpu_anticrenelage.png");
+        antialiasing_pipeline.clean_up();
+    }
+
+    if (resume_max_iter > 0)
+    {
+        std::cout << "=============================================================================================================" << std::endl;
+        std::cout << "Reprise du calcul de " << view.max_iter << " à " << resume_max_iter << " itérations sur CPU" << std::endl << std::flush;
+        pipeline.cpu_resume_computation(resume_max_iter);
+        std::cout << "Reprise du calcul de " << view.max_iter << " à " << resume_max_iter << " itérations sur GPU" << std::endl << std::flush;
+        // Pipeline sans raccourci, pour comparer la reprise au calcul complet
+        vulkan::ComputingPipeline resume_pipeline;
+        resume_pipeline.initialize();
+        resume_pipeline.render_resumable(view);
+        mandelbrot::View refined = view;
+        refined.max_iter = resume_max_iter;
+        double resume_time = resume_pipeline.render_resumable(refined);
+        resume_pipeline.save_gpu_image("mandelbrot_gpu_reprise.png");
+        double brute_time = resume_pipeline.render(refined);
+        std::cout << "Accélération de la reprise sur GPU : " << brute_time/resume_time << std::endl;
+        resume_pipeline.clean_up();
+    }
+
+    if (compare_precisions)
+    {
+        using mandelbrot::Precision;
+        precise_view.width    = view.width;
+        precise_view.height   = view.height;
+        precise_view.max_iter = view.max_iter;
+        std::cout << "=============================================================================================================" << std::endl;
+        std::cout << "Comparaison des arithmétiques sur CPU" << std::endl << std::flush;
+        long long nb_iterations = pipeline.cpu_precision_computation(precise_view);
+        std::cout << "Comparaison des arithmétiques sur GPU" << std::endl << std::flush;
+        vulkan::ComputingPipeline precision_pipeline;
+        precision_pipeline.initialize();
+        if (not precision_pipeline.supports_float64())
+            std::cout << "Le périphérique ne propose pas la double précision (shaderFloat64) : seule l'émulation est possible" << std::endl;
+        // Débit de chaque arithmétique disponible, puis choix parmi celles assez précises de la plus rapide
+        Precision chosen = precision_pipeline.choose_precision(precise_view);
+        double chosen_time = -1.;
+        for (Precision precision : {Precision::single, Precision::double_single, Precision::native_double})
+        {
+            if (precision == Precision::native_double && not precision_pipeline.supports_float64()) continue;
+            double time = precision_pipeline.render_precise(precise_view, precision);
+            bool precise_enough = mandelbrot::is_precise_enough(precision, precise_view);
+            std::cout << "    débit : " << double(nb_iterations)/(time*1.E6) << " G itérations/s"
+                      << (precise_enough ? "" : " (précision insuffisante pour cette fenêtre)") << std::endl;
+            if (precise_enough && (chosen_time < 0. || time < chosen_time))
+            {
+                chosen = precision;
+                chosen_time = time;
+            }
+        }
+        if (chosen_time < 0.)
+            std::cout << "Aucune arithmétique n'est assez précise pour cette fenêtre : utiliser --profond" << std::endl;
+        std::cout << "Arithmétique retenue : " << mandelbrot::precision_name(chosen) << std::endl;
+        precision_pipeline.render_precise(precise_view, chosen);
+        precision_pipeline.save_gpu_image("mandelbrot_gpu_precision.png");
+        precision_pipeline.clean_up();
+    }
+
+    if (deep_zoom)
+    {
+        deep_view.width    = view.width;
+        deep_view.height   = view.height;
+        deep_view.max_iter = view.max_iter;
+        std::cout << "=============================================================================================================" << std::endl;
+        std::cout << "Zoom profond par perturbation (étendue " << deep_view.extent << ") sur CPU" << std::endl << std::flush;
+        pipeline.cpu_perturbation_computation(deep_view);
+        std::cout << "Zoom profond par perturbation (étendue " << deep_view.extent << ") sur GPU" << std::endl << std::flush;
+        vulkan::ComputingPipeline deep_pipeline;
+        deep_pipeline.initialize();
+        deep_pipeline.render_perturbation(deep_view);
+        deep_pipeline.save_gpu_image("mandelbrot_gpu_profond.png");
+        deep_pipeline.clean_up();
+    }
     return EXIT_SUCCESS;
 }
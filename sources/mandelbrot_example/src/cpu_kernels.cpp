@@ -0,0 +1,1524 @@
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <immintrin.h>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "cpu_kernels.hpp"
+
+namespace mandelbrot
+{
+namespace
+{
+// Premier indice d'itération où l'on mémorise l'itéré pour la détection de cycle (doublé à chaque mémorisation)
+constexpr const int first_periodicity_save = 8;
+// ....................................................................................................................
+// Test analytique d'appartenance à la cardioïde principale ou au bourgeon de période 2
+inline bool is_in_main_bulbs(float cx, float cy)
+{
+    float xq = cx - 0.25f;
+    float q  = xq*xq + cy*cy;
+    float xb = cx + 1.f;
+    return (q*(q + xq) <= 0.25f*cy*cy) || (xb*xb + cy*cy <= 0.0625f);
+}
+// ....................................................................................................................
+// Nombre d'itérations avant divergence du point c = cx + i.cy. work est incrémenté du nombre d'itérations calculées.
+// zr_end, zi_end reçoivent le dernier itéré calculé (le premier itéré hors du disque si le point diverge).
+inline int escape_time(float cx, float cy, int max_iter, unsigned shortcuts, long long& work, float& zr_end, float& zi_end)
+{
+    zr_end = zi_end = 0.0f;
+    if ((shortcuts & interior_test) && is_in_main_bulbs(cx, cy)) return max_iter;
+    float zr =  0.0f;
+    float zi =  0.0f;
+    float zr_old = 0.f, zi_old = 0.f;
+    int next_save = first_periodicity_save;
+    int n = 0;
+    int iter = 0;
+    for (; iter < max_iter; ++iter)
+    {
+        float temp = zr*zr - zi*zi + cx;
+        zi = 2*zr*zi + cy;
+        zr = temp;
+        if (zi*zi + zr*zr > 2) break;
+        n += 1;
+        if (shortcuts & periodicity_test)
+        {
+            if (std::abs(zr - zr_old) + std::abs(zi - zi_old) < periodicity_tolerance) { n = max_iter; break; }
+            if (iter + 1 == next_save) { zr_old = zr; zi_old = zi; next_save *= 2; }
+        }
+    }
+    work += (iter < max_iter ? iter + 1 : max_iter);
+    zr_end = zr; zi_end = zi;
+    return n;
+}
+
+inline int escape_time(float cx, float cy, int max_iter, unsigned shortcuts, long long& work)
+{
+    float zr, zi;
+    return escape_time(cx, cy, max_iter, shortcuts, work, zr, zi);
+}
+// ....................................................................................................................
+// Nombre d'itérations continu d'un point ayant divergé après n itérations puis k itérés supplémentaires jusqu'à z (voir
+// compute_iterations_smooth). Partagé par les noyaux scalaire et vectoriels pour des résultats identiques.
+inline float smooth_count_from_radius(int n, int k, float zr, float zi, int max_iter)
+{
+    const float radius2 = smooth_escape_radius*smooth_escape_radius;
+    float norm2 = std::max(zr*zr + zi*zi, radius2);
+    float mu = float(n + 1 + k) - std::log2(std::log2(norm2)/std::log2(radius2));
+    return std::clamp(mu, 0.f, float(max_iter));
+}
+// ....................................................................................................................
+// Même chose à partir du premier itéré z hors du disque (n < max_iter) : on calcule d'abord les itérés supplémentaires
+inline float smooth_iteration_count(int n, float zr, float zi, float cx, float cy, int max_iter)
+{
+    // |z|^2 > 2 ne garantit pas la divergence : on itère jusqu'à un rayon assez grand pour que log2|z| double à chaque
+    // itération (si l'orbite y revient malgré tout, on se contente du rayon smooth_escape_radius)
+    const float radius2 = smooth_escape_radius*smooth_escape_radius;
+    int k = 0;
+    for (; k < smooth_max_extra_iterations && zr*zr + zi*zi <= radius2; ++k)
+    {
+        float temp = zr*zr - zi*zi + cx;
+        zi = 2*zr*zi + cy;
+        zr = temp;
+    }
+    return smooth_count_from_radius(n, k, zr, zi, max_iter);
+}
+// ....................................................................................................................
+// Nombre d'itérations continu du point c (voir compute_iterations_smooth)
+inline float smooth_escape_time(float cx, float cy, int max_iter, unsigned shortcuts, long long& work)
+{
+    float zr, zi;
+    int n = escape_time(cx, cy, max_iter, shortcuts, work, zr, zi);
+    return n >= max_iter ? float(max_iter) : smooth_iteration_count(n, zr, zi, cx, cy, max_iter);
+}
+// ....................................................................................................................
+// Nombre d'itérations avant divergence du point c en itérant aussi la dérivée dz/dc (même suite z que escape_time).
+// zr_end, zi_end reçoivent le dernier itéré calculé et dr_end, di_end sa dérivée.
+inline int derivative_escape_time(float cx, float cy, int max_iter, unsigned shortcuts, long long& work,
+                                  float& zr_end, float& zi_end, float& dr_end, float& di_end)
+{
+    zr_end = zi_end = dr_end = di_end = 0.f;
+    if ((shortcuts & interior_test) && is_in_main_bulbs(cx, cy)) return max_iter;
+    float zr = 0.f, zi = 0.f;
+    float dr = 0.f, di = 0.f; // dz/dc
+    float zr_old = 0.f, zi_old = 0.f;
+    int next_save = first_periodicity_save;
+    int n = 0;
+    int iter = 0;
+    for (; iter < max_iter; ++iter)
+    {
+        // La dérivée utilise l'itéré précédent : elle est mise à jour avant z
+        float temp_d = 2*(zr*dr - zi*di) + 1;
+        di = 2*(zr*di + zi*dr);
+        dr = temp_d;
+        float temp = zr*zr - zi*zi + cx;
+        zi = 2*zr*zi + cy;
+        zr = temp;
+        if (zi*zi + zr*zr > 2) break;
+        n += 1;
+        if (shortcuts & periodicity_test)
+        {
+            if (std::abs(zr - zr_old) + std::abs(zi - zi_old) < periodicity_tolerance) { n = max_iter; break; }
+            if (iter + 1 == next_save) { zr_old = zr; zi_old = zi; next_save *= 2; }
+        }
+    }
+    work += (iter < max_iter ? iter + 1 : max_iter);
+    zr_end = zr; zi_end = zi; dr_end = dr; di_end = di;
+    return n;
+}
+// ....................................................................................................................
+// Distance au bord (en pixels) d'un point dont l'itéré z, de dérivée dz/dc, est hors du disque de rayon
+// smooth_escape_radius. Près du bord, |dz| peut dépasser le plus grand flottant et z, dz devenir infinis : la distance
+// (nulle, infinie ou NaN) est alors comptée comme nulle.
+inline float boundary_distance(float zr, float zi, float dr, float di, float pixel_size)
+{
+    float norm = std::sqrt(zr*zr + zi*zi);
+    float distance = norm*std::log(norm)/(std::sqrt(dr*dr + di*di)*pixel_size);
+    return std::isfinite(distance) ? distance : 0.f;
+}
+// ....................................................................................................................
+// Nombre d'itérations continu et distance au bord d'un point c ayant divergé après n itérations (n < max_iter), z étant
+// le premier itéré hors du disque et dz sa dérivée : on calcule d'abord les itérés supplémentaires (z et dz)
+inline float distance_iteration_count(int n, float zr, float zi, float dr, float di, float cx, float cy, int max_iter,
+                                      float pixel_size, float& distance)
+{
+    const float radius2 = smooth_escape_radius*smooth_escape_radius;
+    int k = 0;
+    for (; k < smooth_max_extra_iterations && zr*zr + zi*zi <= radius2; ++k)
+    {
+        float temp_d = 2*(zr*dr - zi*di) + 1;
+        di = 2*(zr*di + zi*dr);
+        dr = temp_d;
+        float temp = zr*zr - zi*zi + cx;
+        zi = 2*zr*zi + cy;
+        zr = temp;
+    }
+    distance = boundary_distance(zr, zi, dr, di, pixel_size);
+    return smooth_count_from_radius(n, k, zr, zi, max_iter);
+}
+// ....................................................................................................................
+// Sorties des noyaux en plus des nombres d'itérations : nombre d'itérations continu (smooth_iterations) et distance au
+// bord (distances, la dérivée dz/dc est alors itérée avec z). Paramètre du patron des noyaux : le calcul des seuls
+// nombres d'itérations n'en paie pas le coût.
+enum class KernelOutput { counts, smooth, distance };
+// ....................................................................................................................
+template<KernelOutput Output = KernelOutput::counts>
+long long iterations_scalar(View const& view, unsigned shortcuts, int row_begin, int row_end, int* iterations,
+                            float* smooth_iterations = nullptr, float* distances = nullptr)
+{
+    const int width = view.width, height = view.height, max_iter = view.max_iter;
+    const float center_x = view.center_x, center_y = view.center_y, extent = view.extent;
+    const float pixel_size = extent/float(std::min(width, height));
+    long long work = 0;
+#   pragma omp parallel for schedule(dynamic) reduction(+:work)
+    for (int i = row_begin; i < row_end; ++i)
+    {
+        float y = float(i)/float(height);
+        float cy = center_y + (y-0.5f)*extent;
+        for (int j = 0; j < width; ++j)
+        {
+            float x  = float(j)/float(width);
+            float cx = center_x + (x-0.5f)*extent;
+            float zr, zi;
+            if constexpr (Output == KernelOutput::distance)
+            {
+                float dr, di;
+                int n = iterations[i*width+j] = derivative_escape_time(cx, cy, max_iter, shortcuts, work, zr, zi, dr, di);
+                distances[i*width+j] = -1.f;
+                smooth_iterations[i*width+j] = n >= max_iter ? float(max_iter) :
+                    distance_iteration_count(n, zr, zi, dr, di, cx, cy, max_iter, pixel_size, distances[i*width+j]);
+            }
+            else
+            {
+                int n = iterations[i*width+j] = escape_time(cx, cy, max_iter, shortcuts, work, zr, zi);
+                if constexpr (Output == KernelOutput::smooth)
+                    smooth_iterations[i*width+j] = n >= max_iter ? float(max_iter) : smooth_iteration_count(n, zr, zi, cx, cy, max_iter);
+            }
+        }
+    }
+    return work;
+}
+// ....................................................................................................................
+template<KernelOutput Output = KernelOutput::counts>
+__attribute__((target("avx2")))
+long long iterations_avx2(View const& view, unsigned shortcuts, int row_begin, int row_end, int* iterations,
+                          float* smooth_iterations = nullptr, float* distances = nullptr)
+{
+    const int width = view.width, height = view.height, max_iter = view.max_iter;
+    const float center_x = view.center_x, center_y = view.center_y, extent = view.extent;
+    const float pixel_size = extent/float(std::min(width, height));
+    const __m256 one    = _mm256_set1_ps(1.f);
+    const __m256 two    = _mm256_set1_ps(2.f);
+    const __m256 half   = _mm256_set1_ps(0.5f);
+    const __m256 vext   = _mm256_set1_ps(extent);
+    const __m256 vcx0   = _mm256_set1_ps(center_x);
+    const __m256 vwidth = _mm256_set1_ps(float(width));
+    const __m256 tol    = _mm256_set1_ps(periodicity_tolerance);
+    const __m256 no_sign= _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256i vmax  = _mm256_set1_epi32(max_iter);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    long long work = 0;
+#   pragma omp parallel for schedule(dynamic) reduction(+:work)
+    for (int i = row_begin; i < row_end; ++i)
+    {
+        float y = float(i)/float(height);
+        const __m256 cy = _mm256_set1_ps(center_y + (y-0.5f)*extent);
+        for (int j = 0; j < width; j += 8)
+        {
+            __m256 x  = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(j), lanes)), vwidth);
+            __m256 cx = _mm256_add_ps(vcx0, _mm256_mul_ps(_mm256_sub_ps(x, half), vext));
+            __m256 zr = _mm256_setzero_ps();
+            __m256 zi = _mm256_setzero_ps();
+            __m256 zr_old = _mm256_setzero_ps();
+            __m256 zi_old = _mm256_setzero_ps();
+            __m256 zr_escape = _mm256_setzero_ps(); // Premier itéré hors du disque de chaque voie (coloration continue)
+            __m256 zi_escape = _mm256_setzero_ps();
+            __m256 dr = _mm256_setzero_ps();        // Dérivée dz/dc (estimation de distance)
+            __m256 di = _mm256_setzero_ps();
+            __m256 dr_escape = _mm256_setzero_ps(); // Dérivée du premier itéré hors du disque
+            __m256 di_escape = _mm256_setzero_ps();
+            __m256i n = _mm256_setzero_si256();
+            __m256i w = _mm256_setzero_si256(); // Nombre d'itérations calculées par voie
+            // Masque des voies n'ayant pas encore divergé (tous les bits à 1 pour une voie active)
+            __m256 active = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            if (shortcuts & interior_test)
+            {
+                __m256 xq = _mm256_sub_ps(cx, _mm256_set1_ps(0.25f));
+                __m256 q  = _mm256_add_ps(_mm256_mul_ps(xq, xq), _mm256_mul_ps(cy, cy));
+                __m256 xb = _mm256_add_ps(cx, _mm256_set1_ps(1.f));
+                __m256 in_cardioid = _mm256_cmp_ps(_mm256_mul_ps(q, _mm256_add_ps(q, xq)),
+                                                   _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.25f), cy), cy), _CMP_LE_OQ);
+                __m256 in_bulb = _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(xb, xb), _mm256_mul_ps(cy, cy)),
+                                               _mm256_set1_ps(0.0625f), _CMP_LE_OQ);
+                __m256 interior = _mm256_or_ps(in_cardioid, in_bulb);
+                n = _mm256_blendv_epi8(n, vmax, _mm256_castps_si256(interior));
+                active = _mm256_andnot_ps(interior, active);
+            }
+            int next_save = first_periodicity_save;
+            for (int iter = 0; iter < max_iter && !_mm256_testz_ps(active, active); ++iter)
+            {
+                w = _mm256_sub_epi32(w, _mm256_castps_si256(active));
+                if constexpr (Output == KernelOutput::distance)
+                {
+                    // La dérivée utilise l'itéré précédent : elle est mise à jour avant z
+                    __m256 temp_d = _mm256_add_ps(_mm256_mul_ps(two, _mm256_sub_ps(_mm256_mul_ps(zr, dr), _mm256_mul_ps(zi, di))), one);
+                    di = _mm256_mul_ps(two, _mm256_add_ps(_mm256_mul_ps(zr, di), _mm256_mul_ps(zi, dr)));
+                    dr = temp_d;
+                }
+                __m256 temp = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(zr, zr), _mm256_mul_ps(zi, zi)), cx);
+                zi = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(two, zr), zi), cy);
+                zr = temp;
+                __m256 norm2 = _mm256_add_ps(_mm256_mul_ps(zi, zi), _mm256_mul_ps(zr, zr));
+                __m256 outside = _mm256_cmp_ps(norm2, two, _CMP_GT_OQ);
+                if constexpr (Output != KernelOutput::counts)
+                {
+                    // Les voies ayant divergé continuent d'itérer : on garde l'itéré de leur divergence
+                    __m256 escaped = _mm256_and_ps(outside, active);
+                    zr_escape = _mm256_blendv_ps(zr_escape, zr, escaped);
+                    zi_escape = _mm256_blendv_ps(zi_escape, zi, escaped);
+                    if constexpr (Output == KernelOutput::distance)
+                    {
+                        dr_escape = _mm256_blendv_ps(dr_escape, dr, escaped);
+                        di_escape = _mm256_blendv_ps(di_escape, di, escaped);
+                    }
+                }
+                active = _mm256_andnot_ps(outside, active);
+                // Une voie active vaut -1 en entier : on incrémente donc son compteur en le soustrayant
+                n = _mm256_sub_epi32(n, _mm256_castps_si256(active));
+                if (shortcuts & periodicity_test)
+                {
+                    __m256 dist = _mm256_add_ps(_mm256_and_ps(_mm256_sub_ps(zr, zr_old), no_sign),
+                                                _mm256_and_ps(_mm256_sub_ps(zi, zi_old), no_sign));
+                    __m256 periodic = _mm256_and_ps(_mm256_cmp_ps(dist, tol, _CMP_LT_OQ), active);
+                    n = _mm256_blendv_epi8(n, vmax, _mm256_castps_si256(periodic));
+                    active = _mm256_andnot_ps(periodic, active);
+                    if (iter + 1 == next_save) { zr_old = zr; zi_old = zi; next_save *= 2; }
+                }
+            }
+            alignas(32) int lane_work[8];
+            _mm256_store_si256((__m256i*)lane_work, w);
+            for (int k = 0; k < std::min(8, width - j); ++k) work += lane_work[k];
+            if (j + 8 <= width)
+                _mm256_storeu_si256((__m256i*)(iterations + i*width + j), n);
+            else
+            {
+                alignas(32) int tail[8];
+                _mm256_store_si256((__m256i*)tail, n);
+                for (int k = 0; k < width - j; ++k) iterations[i*width + j + k] = tail[k];
+            }
+            if constexpr (Output != KernelOutput::counts)
+            {
+                // Itérés supplémentaires des voies ayant divergé en vectoriel (mêmes opérations que smooth_iteration_count),
+                // puis logarithmes de mu voie par voie
+                const __m256 radius2 = _mm256_set1_ps(smooth_escape_radius*smooth_escape_radius);
+                __m256 extra = _mm256_castsi256_ps(_mm256_cmpgt_epi32(vmax, n));
+                __m256i k_extra = _mm256_setzero_si256();
+                for (int k = 0; k < smooth_max_extra_iterations; ++k)
+                {
+                    __m256 norm2 = _mm256_add_ps(_mm256_mul_ps(zr_escape, zr_escape), _mm256_mul_ps(zi_escape, zi_escape));
+                    extra = _mm256_and_ps(_mm256_cmp_ps(norm2, radius2, _CMP_LE_OQ), extra);
+                    if (_mm256_testz_ps(extra, extra)) break;
+                    if constexpr (Output == KernelOutput::distance)
+                    {
+                        __m256 temp_d = _mm256_add_ps(_mm256_mul_ps(two, _mm256_sub_ps(_mm256_mul_ps(zr_escape, dr_escape),
+                                                                                       _mm256_mul_ps(zi_escape, di_escape))), one);
+                        di_escape = _mm256_blendv_ps(di_escape, _mm256_mul_ps(two, _mm256_add_ps(_mm256_mul_ps(zr_escape, di_escape),
+                                                                                                 _mm256_mul_ps(zi_escape, dr_escape))), extra);
+                        dr_escape = _mm256_blendv_ps(dr_escape, temp_d, extra);
+                    }
+                    __m256 temp = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(zr_escape, zr_escape), _mm256_mul_ps(zi_escape, zi_escape)), cx);
+                    zi_escape = _mm256_blendv_ps(zi_escape, _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(two, zr_escape), zi_escape), cy), extra);
+                    zr_escape = _mm256_blendv_ps(zr_escape, temp, extra);
+                    k_extra = _mm256_sub_epi32(k_extra, _mm256_castps_si256(extra));
+                }
+                alignas(32) int   lane_n[8], lane_k[8];
+                alignas(32) float lane_zr[8], lane_zi[8], lane_dr[8], lane_di[8];
+                _mm256_store_si256((__m256i*)lane_n, n);
+                _mm256_store_si256((__m256i*)lane_k, k_extra);
+                _mm256_store_ps(lane_zr, zr_escape);
+                _mm256_store_ps(lane_zi, zi_escape);
+                _mm256_store_ps(lane_dr, dr_escape);
+                _mm256_store_ps(lane_di, di_escape);
+                for (int k = 0; k < std::min(8, width - j); ++k)
+                {
+                    const bool escaped = lane_n[k] < max_iter;
+                    smooth_iterations[i*width + j + k] = escaped ? smooth_count_from_radius(lane_n[k], lane_k[k], lane_zr[k], lane_zi[k], max_iter)
+                                                                 : float(max_iter);
+                    if constexpr (Output == KernelOutput::distance)
+                        distances[i*width + j + k] = escaped ? boundary_distance(lane_zr[k], lane_zi[k], lane_dr[k], lane_di[k], pixel_size)
+                                                             : -1.f;
+                }
+            }
+        }
+    }
+    return work;
+}
+// ....................................................................................................................
+template<KernelOutput Output = KernelOutput::counts>
+__attribute__((target("avx512f")))
+long long iterations_avx512(View const& view, unsigned shortcuts, int row_begin, int row_end, int* iterations,
+                            float* smooth_iterations = nullptr, float* distances = nullptr)
+{
+    const int width = view.width, height = view.height, max_iter = view.max_iter;
+    const float center_x = view.center_x, center_y = view.center_y, extent = view.extent;
+    const float pixel_size = extent/float(std::min(width, height));
+    const __m512 fone   = _mm512_set1_ps(1.f);
+    const __m512 two    = _mm512_set1_ps(2.f);
+    const __m512 half   = _mm512_set1_ps(0.5f);
+    const __m512 vext   = _mm512_set1_ps(extent);
+    const __m512 vcx0   = _mm512_set1_ps(center_x);
+    const __m512 vwidth = _mm512_set1_ps(float(width));
+    const __m512 tol    = _mm512_set1_ps(periodicity_tolerance);
+    const __m512i one   = _mm512_set1_epi32(1);
+    const __m512i vmax  = _mm512_set1_epi32(max_iter);
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    long long work = 0;
+#   pragma omp parallel for schedule(dynamic) reduction(+:work)
+    for (int i = row_begin; i < row_end; ++i)
+    {
+        float y = float(i)/float(height);
+        const __m512 cy = _mm512_set1_ps(center_y + (y-0.5f)*extent);
+        for (int j = 0; j < width; j += 16)
+        {
+            // Voies correspondant à des pixels de l'image (la dernière tranche d'une ligne peut être incomplète)
+            const __mmask16 valid = (j + 16 <= width ? __mmask16(0xFFFF) : __mmask16((1u << (width - j)) - 1u));
+            __m512 x  = _mm512_div_ps(_mm512_cvtepi32_ps(_mm512_add_epi32(_mm512_set1_epi32(j), lanes)), vwidth);
+            __m512 cx = _mm512_add_ps(vcx0, _mm512_mul_ps(_mm512_sub_ps(x, half), vext));
+            __m512 zr = _mm512_setzero_ps();
+            __m512 zi = _mm512_setzero_ps();
+            __m512 zr_old = _mm512_setzero_ps();
+            __m512 zi_old = _mm512_setzero_ps();
+            __m512 zr_escape = _mm512_setzero_ps(); // Premier itéré hors du disque de chaque voie (coloration continue)
+            __m512 zi_escape = _mm512_setzero_ps();
+            __m512 dr = _mm512_setzero_ps();        // Dérivée dz/dc (estimation de distance)
+            __m512 di = _mm512_setzero_ps();
+            __m512 dr_escape = _mm512_setzero_ps(); // Dérivée du premier itéré hors du disque
+            __m512 di_escape = _mm512_setzero_ps();
+            __m512i n = _mm512_setzero_si512();
+            __m512i w = _mm512_setzero_si512();
+            // Avec AVX-512, le masque des voies actives est un registre de masque (un bit par voie)
+            __mmask16 active = 0xFFFF;
+            if (shortcuts & interior_test)
+            {
+                __m512 xq = _mm512_sub_ps(cx, _mm512_set1_ps(0.25f));
+                __m512 q  = _mm512_add_ps(_mm512_mul_ps(xq, xq), _mm512_mul_ps(cy, cy));
+                __m512 xb = _mm512_add_ps(cx, _mm512_set1_ps(1.f));
+                __mmask16 interior = _mm512_cmp_ps_mask(_mm512_mul_ps(q, _mm512_add_ps(q, xq)),
+                                                        _mm512_mul_ps(_mm512_mul_ps(_mm512_set1_ps(0.25f), cy), cy), _CMP_LE_OQ) |
+                                     _mm512_cmp_ps_mask(_mm512_add_ps(_mm512_mul_ps(xb, xb), _mm512_mul_ps(cy, cy)),
+                                                        _mm512_set1_ps(0.0625f), _CMP_LE_OQ);
+                n = _mm512_mask_mov_epi32(n, interior, vmax);
+                active &= ~interior;
+            }
+            int next_save = first_periodicity_save;
+            for (int iter = 0; iter < max_iter && active != 0; ++iter)
+            {
+                w = _mm512_mask_add_epi32(w, active, w, one);
+                if constexpr (Output == KernelOutput::distance)
+                {
+                    // La dérivée utilise l'itéré précédent : elle est mise à jour avant z
+                    __m512 temp_d = _mm512_add_ps(_mm512_mul_ps(two, _mm512_sub_ps(_mm512_mul_ps(zr, dr), _mm512_mul_ps(zi, di))), fone);
+                    di = _mm512_mul_ps(two, _mm512_add_ps(_mm512_mul_ps(zr, di), _mm512_mul_ps(zi, dr)));
+                    dr = temp_d;
+                }
+                __m512 temp = _mm512_add_ps(_mm512_sub_ps(_mm512_mul_ps(zr, zr), _mm512_mul_ps(zi, zi)), cx);
+                zi = _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(two, zr), zi), cy);
+                zr = temp;
+                __m512 norm2 = _mm512_add_ps(_mm512_mul_ps(zi, zi), _mm512_mul_ps(zr, zr));
+                // Une voie active n'a que des itérés bornés (donc pas de NaN) : "non > 2" équivaut à "<= 2"
+                __mmask16 inside = _mm512_mask_cmp_ps_mask(active, norm2, two, _CMP_LE_OQ);
+                if constexpr (Output != KernelOutput::counts)
+                {
+                    zr_escape = _mm512_mask_mov_ps(zr_escape, active & ~inside, zr);
+                    zi_escape = _mm512_mask_mov_ps(zi_escape, active & ~inside, zi);
+                    if constexpr (Output == KernelOutput::distance)
+                    {
+                        dr_escape = _mm512_mask_mov_ps(dr_escape, active & ~inside, dr);
+                        di_escape = _mm512_mask_mov_ps(di_escape, active & ~inside, di);
+                    }
+                }
+                active = inside;
+                n = _mm512_mask_add_epi32(n, active, n, one);
+                if (shortcuts & periodicity_test)
+                {
+                    __m512 dist = _mm512_add_ps(_mm512_abs_ps(_mm512_sub_ps(zr, zr_old)), _mm512_abs_ps(_mm512_sub_ps(zi, zi_old)));
+                    __mmask16 periodic = _mm512_mask_cmp_ps_mask(active, dist, tol, _CMP_LT_OQ);
+                    n = _mm512_mask_mov_epi32(n, periodic, vmax);
+                    active &= ~periodic;
+                    if (iter + 1 == next_save) { zr_old = zr; zi_old = zi; next_save *= 2; }
+                }
+            }
+            work += _mm512_mask_reduce_add_epi32(valid, w);
+            _mm512_mask_storeu_epi32(iterations + i*width + j, valid, n);
+            if constexpr (Output != KernelOutput::counts)
+            {
+                // Itérés supplémentaires des voies ayant divergé en vectoriel (mêmes opérations que smooth_iteration_count),
+                // puis logarithmes de mu voie par voie
+                const __m512 radius2 = _mm512_set1_ps(smooth_escape_radius*smooth_escape_radius);
+                __mmask16 extra = _mm512_cmp_epi32_mask(n, vmax, _MM_CMPINT_LT) & valid;
+                __m512i k_extra = _mm512_setzero_si512();
+                for (int k = 0; k < smooth_max_extra_iterations; ++k)
+                {
+                    extra = _mm512_mask_cmp_ps_mask(extra, _mm512_add_ps(_mm512_mul_ps(zr_escape, zr_escape),
+                                                                         _mm512_mul_ps(zi_escape, zi_escape)), radius2, _CMP_LE_OQ);
+                    if (extra == 0) break;
+                    if constexpr (Output == KernelOutput::distance)
+                    {
+                        __m512 temp_d = _mm512_add_ps(_mm512_mul_ps(two, _mm512_sub_ps(_mm512_mul_ps(zr_escape, dr_escape),
+                                                                                       _mm512_mul_ps(zi_escape, di_escape))), fone);
+                        di_escape = _mm512_mask_mov_ps(di_escape, extra, _mm512_mul_ps(two, _mm512_add_ps(_mm512_mul_ps(zr_escape, di_escape),
+                                                                                                          _mm512_mul_ps(zi_escape, dr_escape))));
+                        dr_escape = _mm512_mask_mov_ps(dr_escape, extra, temp_d);
+                    }
+                    __m512 temp = _mm512_add_ps(_mm512_sub_ps(_mm512_mul_ps(zr_escape, zr_escape), _mm512_mul_ps(zi_escape, zi_escape)), cx);
+                    zi_escape = _mm512_mask_mov_ps(zi_escape, extra, _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(two, zr_escape), zi_escape), cy));
+                    zr_escape = _mm512_mask_mov_ps(zr_escape, extra, temp);
+                    k_extra = _mm512_mask_add_epi32(k_extra, extra, k_extra, one);
+                }
+                alignas(64) int   lane_n[16], lane_k[16];
+                alignas(64) float lane_zr[16], lane_zi[16], lane_dr[16], lane_di[16];
+                _mm512_store_si512(lane_n, n);
+                _mm512_store_si512(lane_k, k_extra);
+                _mm512_store_ps(lane_zr, zr_escape);
+                _mm512_store_ps(lane_zi, zi_escape);
+                _mm512_store_ps(lane_dr, dr_escape);
+                _mm512_store_ps(lane_di, di_escape);
+                for (int k = 0; k < std::min(16, width - j); ++k)
+                {
+                    const bool escaped = lane_n[k] < max_iter;
+                    smooth_iterations[i*width + j + k] = escaped ? smooth_count_from_radius(lane_n[k], lane_k[k], lane_zr[k], lane_zi[k], max_iter)
+                                                                 : float(max_iter);
+                    if constexpr (Output == KernelOutput::distance)
+                        distances[i*width + j + k] = escaped ? boundary_distance(lane_zr[k], lane_zi[k], lane_dr[k], lane_di[k], pixel_size)
+                                                             : -1.f;
+                }
+            }
+        }
+    }
+    return work;
+}
+// ....................................................................................................................
+// Subdivision de Mariani-Silver : les rectangles sont désignés par leurs bords (inclus) [x0, x1] x [y0, y1]
+struct Subdivision
+{
+    int width, height, max_iter;
+    float center_x, center_y, extent;
+    unsigned shortcuts;
+    int* iterations;
+
+    // Même calcul (et donc même résultat) que iterations_scalar pour le pixel (i, j)
+    int pixel(int i, int j, long long& work) const
+    {
+        return iterations[i*width+j] = escape_time(x_coordinate(j), y_coordinate(i), max_iter, shortcuts, work);
+    }
+
+    // Calcule les pixels de la ligne i entre les colonnes j0 et j1 (incluses)
+    void row(int i, int j0, int j1, long long& work) const
+    {
+        for (int j = j0; j <= j1; ++j) pixel(i, j, work);
+    }
+
+    // Calcule les pixels de la colonne j entre les lignes i0 et i1 (incluses)
+    void column(int j, int i0, int i1, long long& work) const
+    {
+        for (int i = i0; i <= i1; ++i) pixel(i, j, work);
+    }
+
+    float x_coordinate(int j) const { return center_x + (float(j)/float(width) - 0.5f)*extent; }
+    float y_coordinate(int i) const { return center_y + (float(i)/float(height) - 0.5f)*extent; }
+
+    // Renvoie vrai si tous les pixels du bord du rectangle sont dans la cardioïde principale, ou tous dans le bourgeon de
+    // période 2. Ce sont deux domaines de Jordan : l'intérieur du rectangle y est alors aussi, à la pointe de la
+    // cardioïde près (c = 1/4, où le complémentaire entre en coin entre deux pixels), que l'on exclut.
+    bool border_in_main_bulbs(int x0, int x1, int y0, int y1) const
+    {
+        const float cx0 = x_coordinate(x0), cx1 = x_coordinate(x1), cy0 = y_coordinate(y0), cy1 = y_coordinate(y1);
+        if (cx0 <= 0.25f && cx1 >= 0.25f && cy0 <= 0.f && cy1 >= 0.f) return false;
+        auto in_cardioid = [](float cx, float cy)
+        {
+            float xq = cx - 0.25f;
+            float q  = xq*xq + cy*cy;
+            return q*(q + xq) <= 0.25f*cy*cy;
+        };
+        auto in_bulb = [](float cx, float cy) { return (cx + 1.f)*(cx + 1.f) + cy*cy <= 0.0625f; };
+        auto on_border = [&](auto inside)
+        {
+            for (int j = x0; j <= x1; ++j)
+                if (not inside(x_coordinate(j), cy0) || not inside(x_coordinate(j), cy1)) return false;
+            for (int i = y0+1; i < y1; ++i)
+                if (not inside(cx0, y_coordinate(i)) || not inside(cx1, y_coordinate(i))) return false;
+            return true;
+        };
+        return on_border(in_cardioid) || on_border(in_bulb);
+    }
+
+    // Traite l'intérieur d'un rectangle dont le bord a déjà été calculé. Chaque appel n'écrit que dans l'intérieur strict
+    // de son rectangle : les tâches filles, qui ont des intérieurs disjoints, peuvent donc s'exécuter en parallèle.
+    long long process(int x0, int x1, int y0, int y1) const
+    {
+        constexpr const int min_size  = 8;  // En dessous de cette taille, on calcule directement l'intérieur
+        constexpr const int task_size = 64; // En dessous de cette taille, on ne crée plus de tâches OpenMP
+        long long work = 0;
+        if (x1 - x0 < 2 || y1 - y0 < 2) return work; // Pas d'intérieur
+        // Un bord uniforme ne suffit pas : un filament plus fin qu'un pixel peut passer entre deux pixels du bord et
+        // donner des pixels isolés d'un autre nombre d'itérations à l'intérieur. On ne remplit donc que les rectangles
+        // certainement dans l'ensemble.
+        if (border_in_main_bulbs(x0, x1, y0, y1))
+        {
+            for (int i = y0+1; i < y1; ++i)
+                for (int j = x0+1; j < x1; ++j) iterations[i*width+j] = max_iter;
+            return work;
+        }
+        if (x1 - x0 <= min_size || y1 - y0 <= min_size)
+        {
+            for (int i = y0+1; i < y1; ++i) row(i, x0+1, x1-1, work);
+            return work;
+        }
+        // On découpe en quatre le rectangle en calculant la ligne et la colonne médianes (bords des sous-rectangles)
+        const int xm = (x0 + x1)/2;
+        const int ym = (y0 + y1)/2;
+        row(ym, x0+1, x1-1, work);
+        column(xm, y0+1, ym-1, work);
+        column(xm, ym+1, y1-1, work);
+        long long sub_work[4] = {0, 0, 0, 0};
+        const bool spawn = (x1 - x0 > task_size) || (y1 - y0 > task_size);
+#       pragma omp task shared(sub_work) if(spawn)
+        sub_work[0] = process(x0, xm, y0, ym);
+#       pragma omp task shared(sub_work) if(spawn)
+        sub_work[1] = process(xm, x1, y0, ym);
+#       pragma omp task shared(sub_work) if(spawn)
+        sub_work[2] = process(x0, xm, ym, y1);
+#       pragma omp task shared(sub_work) if(spawn)
+        sub_work[3] = process(xm, x1, ym, y1);
+#       pragma omp taskwait
+        return work + sub_work[0] + sub_work[1] + sub_work[2] + sub_work[3];
+    }
+};
+// ....................................................................................................................
+// Reprise des itérations des nb pixels actifs (liste compacte) de l'itération begin_iter jusqu'à l'itération max_iter.
+// Les itérés zr, zi sont mis à jour et n reçoit le nombre d'itérations de chaque pixel (max_iter s'il n'a pas divergé).
+long long resume_scalar(int begin_iter, int max_iter, int nb, float const* cx, float const* cy, float* zr, float* zi, int* n)
+{
+    long long work = 0;
+#   pragma omp parallel for schedule(dynamic, 256) reduction(+:work)
+    for (int k = 0; k < nb; ++k)
+    {
+        float x = zr[k], y = zi[k];
+        int   count = begin_iter;
+        int   iter  = begin_iter;
+        for (; iter < max_iter; ++iter)
+        {
+            float temp = x*x - y*y + cx[k];
+            y = 2*x*y + cy[k];
+            x = temp;
+            if (y*y + x*x > 2) break;
+            count += 1;
+        }
+        work += (iter < max_iter ? iter + 1 : max_iter) - begin_iter;
+        zr[k] = x; zi[k] = y; n[k] = count;
+    }
+    return work;
+}
+// ....................................................................................................................
+__attribute__((target("avx2")))
+long long resume_avx2(int begin_iter, int max_iter, int nb, float const* cx, float const* cy, float* zr, float* zi, int* n)
+{
+    const __m256 two    = _mm256_set1_ps(2.f);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    long long work = 0;
+#   pragma omp parallel for schedule(dynamic, 32) reduction(+:work)
+    for (int k = 0; k < nb; k += 8)
+    {
+        // Masque des voies correspondant à des pixels actifs (la dernière tranche de la liste peut être incomplète)
+        const __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(nb - k), lanes);
+        const __m256 vcx = _mm256_maskload_ps(cx + k, valid);
+        const __m256 vcy = _mm256_maskload_ps(cy + k, valid);
+        __m256 x = _mm256_maskload_ps(zr + k, valid);
+        __m256 y = _mm256_maskload_ps(zi + k, valid);
+        __m256i count = _mm256_set1_epi32(begin_iter);
+        __m256i w     = _mm256_setzero_si256();
+        __m256 active = _mm256_castsi256_ps(valid);
+        for (int iter = begin_iter; iter < max_iter && !_mm256_testz_ps(active, active); ++iter)
+        {
+            w = _mm256_sub_epi32(w, _mm256_castps_si256(active));
+            __m256 temp = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), vcx);
+            y = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(two, x), y), vcy);
+            x = temp;
+            __m256 norm2 = _mm256_add_ps(_mm256_mul_ps(y, y), _mm256_mul_ps(x, x));
+            active = _mm256_andnot_ps(_mm256_cmp_ps(norm2, two, _CMP_GT_OQ), active);
+            count = _mm256_sub_epi32(count, _mm256_castps_si256(active));
+        }
+        alignas(32) int lane_work[8];
+        _mm256_store_si256((__m256i*)lane_work, w);
+        for (int l = 0; l < std::min(8, nb - k); ++l) work += lane_work[l];
+        _mm256_maskstore_ps(zr + k, valid, x);
+        _mm256_maskstore_ps(zi + k, valid, y);
+        _mm256_maskstore_epi32(n + k, valid, count);
+    }
+    return work;
+}
+// ....................................................................................................................
+__attribute__((target("avx512f")))
+long long resume_avx512(int begin_iter, int max_iter, int nb, float const* cx, float const* cy, float* zr, float* zi, int* n)
+{
+    const __m512 two  = _mm512_set1_ps(2.f);
+    const __m512i one = _mm512_set1_epi32(1);
+    long long work = 0;
+#   pragma omp parallel for schedule(dynamic, 16) reduction(+:work)
+    for (int k = 0; k < nb; k += 16)
+    {
+        const __mmask16 valid = (k + 16 <= nb ? __mmask16(0xFFFF) : __mmask16((1u << (nb - k)) - 1u));
+        const __m512 vcx = _mm512_maskz_loadu_ps(valid, cx + k);
+        const __m512 vcy = _mm512_maskz_loadu_ps(valid, cy + k);
+        __m512 x = _mm512_maskz_loadu_ps(valid, zr + k);
+        __m512 y = _mm512_maskz_loadu_ps(valid, zi + k);
+        __m512i count = _mm512_set1_epi32(begin_iter);
+        __m512i w     = _mm512_setzero_si512();
+        __mmask16 active = valid;
+        for (int iter = begin_iter; iter < max_iter && active != 0; ++iter)
+        {
+            w = _mm512_mask_add_epi32(w, active, w, one);
+            __m512 temp = _mm512_add_ps(_mm512_sub_ps(_mm512_mul_ps(x, x), _mm512_mul_ps(y, y)), vcx);
+            y = _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(two, x), y), vcy);
+            x = temp;
+            __m512 norm2 = _mm512_add_ps(_mm512_mul_ps(y, y), _mm512_mul_ps(x, x));
+            active = _mm512_mask_cmp_ps_mask(active, norm2, two, _CMP_LE_OQ);
+            count = _mm512_mask_add_epi32(count, active, count, one);
+        }
+        work += _mm512_mask_reduce_add_epi32(valid, w);
+        _mm512_mask_storeu_ps(zr + k, valid, x);
+        _mm512_mask_storeu_ps(zi + k, valid, y);
+        _mm512_mask_storeu_epi32(n + k, valid, count);
+    }
+    return work;
+}
+// ====================================================================================================================
+// Arithmétique double simple : un réel est la somme non évaluée hi + lo de deux flottants (algorithmes de Dekker et de
+// Knuth). Ces algorithmes reposent sur l'arrondi de chaque opération : la contraction en FMA doit être interdite (voir
+// CMakeLists.txt), comme dans le shader double_single.comp (qualificatif precise).
+struct DoubleSingle { float hi, lo; };
+// ....................................................................................................................
+inline DoubleSingle ds_from_double(double x)
+{
+    float hi = float(x);
+    return {hi, float(x - double(hi))};
+}
+// ....................................................................................................................
+// Somme exacte de deux flottants (Knuth)
+inline DoubleSingle two_sum(float a, float b)
+{
+    float s  = a + b;
+    float bb = s - a;
+    return {s, (a - (s - bb)) + (b - bb)};
+}
+// ....................................................................................................................
+// Somme exacte de deux flottants lorsque |a| >= |b| (Dekker)
+inline DoubleSingle quick_two_sum(float a, float b)
+{
+    float s = a + b;
+    return {s, b - (s - a)};
+}
+// ....................................................................................................................
+// Produit exact de deux flottants : découpage de chaque facteur en deux moitiés de 12 bits (Dekker)
+inline DoubleSingle two_prod(float a, float b)
+{
+    float p  = a*b;
+    float ta = 4097.f*a, tb = 4097.f*b;
+    float ah = ta - (ta - a), al = a - ah;
+    float bh = tb - (tb - b), bl = b - bh;
+    return {p, ((ah*bh - p) + ah*bl + al*bh) + al*bl};
+}
+// ....................................................................................................................
+inline DoubleSingle ds_add(DoubleSingle a, DoubleSingle b)
+{
+    DoubleSingle s = two_sum(a.hi, b.hi);
+    return quick_two_sum(s.hi, s.lo + (a.lo + b.lo));
+}
+// ....................................................................................................................
+inline DoubleSingle ds_mul(DoubleSingle a, DoubleSingle b)
+{
+    DoubleSingle p = two_prod(a.hi, b.hi);
+    return quick_two_sum(p.hi, p.lo + (a.hi*b.lo + a.lo*b.hi));
+}
+// ....................................................................................................................
+inline int escape_time_double_single(DoubleSingle cx, DoubleSingle cy, int max_iter)
+{
+    DoubleSingle zr{0.f, 0.f}, zi{0.f, 0.f};
+    int n = 0;
+    for (int iter = 0; iter < max_iter; ++iter)
+    {
+        DoubleSingle zr2 = ds_mul(zr, zr), zi2 = ds_mul(zi, zi), zri = ds_mul(zr, zi);
+        zr = ds_add(ds_add(zr2, {-zi2.hi, -zi2.lo}), cx);
+        zi = ds_add({2.f*zri.hi, 2.f*zri.lo}, cy);
+        if (zi.hi*zi.hi + zr.hi*zr.hi > 2) break;
+        n += 1;
+    }
+    return n;
+}
+// ....................................................................................................................
+inline int escape_time_double(double cx, double cy, int max_iter)
+{
+    double zr = 0., zi = 0.;
+    int n = 0;
+    for (int iter = 0; iter < max_iter; ++iter)
+    {
+        double temp = zr*zr - zi*zi + cx;
+        zi = 2*zr*zi + cy;
+        zr = temp;
+        if (zi*zi + zr*zr > 2) break;
+        n += 1;
+    }
+    return n;
+}
+// ====================================================================================================================
+// Un pas de la suite z <- z^Power + c de la famille F. Pour mandelbrot et julia de puissance 2, mêmes opérations que
+// escape_time.
+template<Fractal F, int Power>
+inline void family_step(float& zr, float& zi, float cr, float ci)
+{
+    if constexpr (F == Fractal::burning_ship)
+    {
+        zr = std::abs(zr);
+        zi = std::abs(zi);
+    }
+    if constexpr (Power == 2)
+    {
+        float temp = zr*zr - zi*zi + cr;
+        zi = 2*zr*zi + ci;
+        zr = temp;
+    }
+    else
+    {
+        float wr = zr, wi = zi;
+        for (int p = 1; p < Power; ++p)
+        {
+            float temp = wr*zr - wi*zi;
+            wi = wr*zi + wi*zr;
+            wr = temp;
+        }
+        zr = wr + cr;
+        zi = wi + ci;
+    }
+}
+// ....................................................................................................................
+// Nombres d'itérations (Count = int) ou nombres d'itérations continus (Count = float) de la famille F d'exposant Power
+template<Fractal F, int Power, typename Count>
+long long family_kernel(FractalFamily const& family, View const& view, unsigned shortcuts, Count* iterations)
+{
+    constexpr bool  standard = (F == Fractal::mandelbrot && Power == 2);
+    constexpr float escape2  = (F == Fractal::mandelbrot ? 2.f : 4.f);
+    const int width = view.width, height = view.height, max_iter = view.max_iter;
+    const float center_x = view.center_x, center_y = view.center_y, extent = view.extent;
+    const bool periodicity = (shortcuts & periodicity_test) != 0;
+    const float radius2 = smooth_escape_radius*smooth_escape_radius;
+    const float inv_log2_power = 1.f/std::log2(float(Power));
+    long long work = 0;
+#   pragma omp parallel for schedule(dynamic) reduction(+:work)
+    for (int i = 0; i < height; ++i)
+    {
+        float y = float(i)/float(height);
+        float py = center_y + (y-0.5f)*extent;
+        for (int j = 0; j < width; ++j)
+        {
+            float x  = float(j)/float(width);
+            float px = center_x + (x-0.5f)*extent;
+            Count& result = iterations[i*width+j];
+            if constexpr (standard)
+            {
+                if ((shortcuts & interior_test) && is_in_main_bulbs(px, py)) { result = Count(max_iter); continue; }
+            }
+            float cr = px, ci = py, zr = 0.f, zi = 0.f;
+            if constexpr (F == Fractal::julia)
+            {
+                cr = family.julia_x; ci = family.julia_y;
+                zr = px; zi = py;
+            }
+            float zr_old = 0.f, zi_old = 0.f;
+            int next_save = first_periodicity_save;
+            int n = 0;
+            int iter = 0;
+            for (; iter < max_iter; ++iter)
+            {
+                family_step<F, Power>(zr, zi, cr, ci);
+                if (zi*zi + zr*zr > escape2) break;
+                n += 1;
+                if (periodicity)
+                {
+                    if (std::abs(zr - zr_old) + std::abs(zi - zi_old) < periodicity_tolerance) { n = max_iter; break; }
+                    if (iter + 1 == next_save) { zr_old = zr; zi_old = zi; next_save *= 2; }
+                }
+            }
+            work += (iter < max_iter ? iter + 1 : max_iter);
+            if constexpr (std::is_same_v<Count, float>)
+            {
+                if (n >= max_iter) { result = float(max_iter); continue; }
+                int k = 0;
+                for (; k < smooth_max_extra_iterations && zr*zr + zi*zi <= radius2; ++k)
+                    family_step<F, Power>(zr, zi, cr, ci);
+                float norm2 = std::max(zr*zr + zi*zi, radius2);
+                float mu = float(n + 1 + k) - std::log2(std::log2(norm2)/std::log2(radius2))*inv_log2_power;
+                result = std::clamp(mu, 0.f, float(max_iter));
+            }
+            else
+                result = n;
+        }
+    }
+    return work;
+}
+// ....................................................................................................................
+// Choix (une fois par appel) de l'instanciation de family_kernel correspondant à l'exposant demandé
+template<Fractal F, typename Count, int Power = 2>
+long long dispatch_power(FractalFamily const& family, View const& view, unsigned shortcuts, Count* iterations)
+{
+    if constexpr (Power > max_fractal_power)
+        throw std::invalid_argument("Exposant de la fractale hors de [2, " + std::to_string(max_fractal_power) + "]");
+    else
+    {
+        if (family.power == Power) return family_kernel<F, Power>(family, view, shortcuts, iterations);
+        return dispatch_power<F, Count, Power + 1>(family, view, shortcuts, iterations);
+    }
+}
+
+template<typename Count>
+long long dispatch_family(FractalFamily const& family, View const& view, unsigned shortcuts, Count* iterations)
+{
+    switch(family.kind)
+    {
+    case Fractal::julia:
+        return dispatch_power<Fractal::julia>(family, view, shortcuts, iterations);
+    case Fractal::burning_ship:
+        return dispatch_power<Fractal::burning_ship>(family, view, shortcuts, iterations);
+    default:
+        return dispatch_power<Fractal::mandelbrot>(family, view, shortcuts, iterations);
+    }
+}
+}// End anonymous namespace
+// ====================================================================================================================
+Isa detect_isa()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Isa::avx512;
+    if (__builtin_cpu_supports("avx2"))    return Isa::avx2;
+    return Isa::scalar;
+}
+// --------------------------------------------------------------------------------------------------------------------
+char const* isa_name(Isa isa)
+{
+    switch(isa)
+    {
+    case Isa::avx512:
+        return "AVX-512";
+    case Isa::avx2:
+        return "AVX2";
+    default:
+        return "scalaire";
+    }
+}
+// --------------------------------------------------------------------------------------------------------------------
+long long compute_iterations(Isa isa, View const& view, unsigned shortcuts, int* iterations)
+{
+    return compute_iterations_rows(isa, view, shortcuts, 0, view.height, iterations);
+}
+// --------------------------------------------------------------------------------------------------------------------
+long long compute_iterations_rows(Isa isa, View const& view, unsigned shortcuts, int row_begin, int row_end, int* iterations)
+{
+    switch(isa)
+    {
+    case Isa::avx512:
+        return iterations_avx512(view, shortcuts, row_begin, row_end, iterations);
+    case Isa::avx2:
+        return iterations_avx2(view, shortcuts, row_begin, row_end, iterations);
+    default:
+        return iterations_scalar(view, shortcuts, row_begin, row_end, iterations);
+    }
+}
+// --------------------------------------------------------------------------------------------------------------------
+long long compute_iterations_profiled(View const& view, unsigned shortcuts, int* iterations, IterationProfile& profile)
+{
+    using clock = std::chrono::steady_clock;
+    const int width = view.width, height = view.height, max_iter = view.max_iter;
+    const float center_x = view.center_x, center_y = view.center_y, extent = view.extent;
+    const int tile_size = profile.tile_size;
+    profile.nb_tiles_x = (width  + tile_size - 1)/tile_size;
+    profile.nb_tiles_y = (height + tile_size - 1)/tile_size;
+    profile.tile_work.assign(std::size_t(profile.nb_tiles_x)*profile.nb_tiles_y, 0);
+    const int nb_threads = omp_get_max_threads();
+    profile.thread_busy_ms.assign(nb_threads, 0.);
+    profile.thread_rows.assign(nb_threads, 0);
+    profile.thread_work.assign(nb_threads, 0);
+
+    auto beg_time = clock::now();
+#   pragma omp parallel
+    {
+        const int thread = omp_get_thread_num();
+        double    busy_ms = 0.;
+        int       nb_rows = 0;
+        long long thread_work = 0;
+        // Une ligne de tuiles par ligne de pixels : deux threads ne partagent une tuile que s'ils calculent deux lignes
+        // de la même bande, d'où l'addition atomique
+        std::vector<long long> row_tile_work(profile.nb_tiles_x);
+#       pragma omp for schedule(dynamic)
+        for (int i = 0; i < height; ++i)
+        {
+            auto row_beg = clock::now();
+            std::fill(row_tile_work.begin(), row_tile_work.end(), 0);
+            float y = float(i)/float(height);
+            float cy = center_y + (y-0.5f)*extent;
+            for (int j = 0; j < width; ++j)
+            {
+                float x  = float(j)/float(width);
+                float cx = center_x + (x-0.5f)*extent;
+                iterations[i*width+j] = escape_time(cx, cy, max_iter, shortcuts, row_tile_work[j/tile_size]);
+            }
+            busy_ms += std::chrono::duration<double, std::milli>(clock::now() - row_beg).count();
+            ++nb_rows;
+            long long* tile_row = profile.tile_work.data() + std::size_t(i/tile_size)*profile.nb_tiles_x;
+            for (int t = 0; t < profile.nb_tiles_x; ++t)
+            {
+#               pragma omp atomic
+                tile_row[t] += row_tile_work[t];
+                thread_work += row_tile_work[t];
+            }
+        }
+        profile.thread_busy_ms[thread] = busy_ms;
+        profile.thread_rows[thread]    = nb_rows;
+        profile.thread_work[thread]    = thread_work;
+    }
+    profile.elapsed_ms = std::chrono::duration<double, std::milli>(clock::now() - beg_time).count();
+    profile.work = 0;
+    for (long long w : profile.thread_work) profile.work += w;
+    return profile.work;
+}
+// ====================================================================================================================
+char const* fractal_name(Fractal fractal)
+{
+    switch(fractal)
+    {
+    case Fractal::julia:
+        return "julia";
+    case Fractal::burning_ship:
+        return "bateau";
+    default:
+        return "mandelbrot";
+    }
+}
+
+long long compute_iterations_family(FractalFamily const& family, View const& view, unsigned shortcuts, int* iterations)
+{
+    return dispatch_family(family, view, shortcuts, iterations);
+}
+
+long long compute_iterations_family(FractalFamily const& family, View const& view, unsigned shortcuts, float* smooth_iterations)
+{
+    return dispatch_family(family, view, shortcuts, smooth_iterations);
+}
+// ====================================================================================================================
+long long compute_iterations_subdivision(View const& view, unsigned shortcuts, int* iterations)
+{
+    const int width = view.width, height = view.height;
+    Subdivision subdivision{width, height, view.max_iter, view.center_x, view.center_y, view.extent, shortcuts, iterations};
+    long long work = 0;
+#   pragma omp parallel
+#   pragma omp single
+    {
+        // Bord de l'image, puis subdivision récursive de toute l'image
+        subdivision.row(0, 0, width-1, work);
+        if (height > 1) subdivision.row(height-1, 0, width-1, work);
+        subdivision.column(0, 1, height-2, work);
+        if (width > 1) subdivision.column(width-1, 1, height-2, work);
+        work += subdivision.process(0, width-1, 0, height-1);
+    }
+    return work;
+}
+// ====================================================================================================================
+long long compute_iterations_resumable(Isa isa, View const& view, ResumeState& state, int* iterations)
+{
+    auto const& old = state.view;
+    bool resume = (old.width == view.width && old.height == view.height && old.center_x == view.center_x &&
+                   old.center_y == view.center_y && old.extent == view.extent && old.max_iter <= view.max_iter &&
+                   old.max_iter > 0);
+    if (not resume)
+    {
+        // Nouveau calcul : tous les pixels sont actifs et partent de z = 0 (même calcul de c que dans iterations_scalar)
+        const int nb_pixels = view.width * view.height;
+        state.index.resize(nb_pixels);
+        state.cx.resize(nb_pixels); state.cy.resize(nb_pixels);
+        state.zr.assign(nb_pixels, 0.f); state.zi.assign(nb_pixels, 0.f);
+#       pragma omp parallel for
+        for (int i = 0; i < view.height; ++i)
+        {
+            float y = float(i)/float(view.height);
+            float cy = view.center_y + (y-0.5f)*view.extent;
+            for (int j = 0; j < view.width; ++j)
+            {
+                float x = float(j)/float(view.width);
+                state.index[i*view.width+j] = i*view.width+j;
+                state.cx[i*view.width+j] = view.center_x + (x-0.5f)*view.extent;
+                state.cy[i*view.width+j] = cy;
+            }
+        }
+        state.view = view;
+        state.view.max_iter = 0;
+    }
+
+    const int begin_iter = state.view.max_iter;
+    const int nb = int(state.index.size());
+    std::vector<int> n(nb);
+    long long work;
+    switch(isa)
+    {
+    case Isa::avx512:
+        work = resume_avx512(begin_iter, view.max_iter, nb, state.cx.data(), state.cy.data(), state.zr.data(), state.zi.data(), n.data());
+        break;
+    case Isa::avx2:
+        work = resume_avx2(begin_iter, view.max_iter, nb, state.cx.data(), state.cy.data(), state.zr.data(), state.zi.data(), n.data());
+        break;
+    default:
+        work = resume_scalar(begin_iter, view.max_iter, nb, state.cx.data(), state.cy.data(), state.zr.data(), state.zi.data(), n.data());
+        break;
+    }
+
+    // Mise à jour de l'image puis compactage de la liste : on ne garde que les pixels qui n'ont pas divergé
+#   pragma omp parallel for
+    for (int k = 0; k < nb; ++k)
+        iterations[state.index[k]] = n[k];
+    int nb_active = 0;
+    for (int k = 0; k < nb; ++k)
+    {
+        if (n[k] < view.max_iter) continue;
+        state.index[nb_active] = state.index[k];
+        state.cx[nb_active] = state.cx[k]; state.cy[nb_active] = state.cy[k];
+        state.zr[nb_active] = state.zr[k]; state.zi[nb_active] = state.zi[k];
+        ++nb_active;
+    }
+    state.index.resize(nb_active);
+    state.cx.resize(nb_active); state.cy.resize(nb_active);
+    state.zr.resize(nb_active); state.zi.resize(nb_active);
+    state.view.max_iter = view.max_iter;
+    return work;
+}
+// ====================================================================================================================
+char const* precision_name(Precision precision)
+{
+    switch(precision)
+    {
+    case Precision::double_single:
+        return "double simple (émulée)";
+    case Precision::native_double:
+        return "double";
+    default:
+        return "simple";
+    }
+}
+// --------------------------------------------------------------------------------------------------------------------
+bool is_precise_enough(Precision precision, PreciseView const& view)
+{
+    const int mantissa_bits = (precision == Precision::single ? 24 : precision == Precision::double_single ? 48 : 53);
+    double magnitude = std::max(std::abs(view.center_x), std::abs(view.center_y)) + 0.5*view.extent;
+    double spacing   = view.extent / std::max(view.width, view.height);
+    return std::log2(magnitude/spacing) + 6. <= mantissa_bits;
+}
+// --------------------------------------------------------------------------------------------------------------------
+long long compute_iterations_precise(Precision precision, PreciseView const& view, int* iterations)
+{
+    const int width = view.width, height = view.height, max_iter = view.max_iter;
+    if (precision == Precision::single)
+        return iterations_scalar(View{width, height, float(view.center_x), float(view.center_y), float(view.extent), max_iter},
+                                 no_shortcut, 0, height, iterations);
+    // Comme dans les shaders, seul le centre est représenté avec la précision étendue : le décalage du pixel par rapport
+    // au centre, petit devant la distance entre pixels, est calculé en simple précision dans tous les modes
+    const DoubleSingle center_x = ds_from_double(view.center_x), center_y = ds_from_double(view.center_y);
+    const float extent = float(view.extent);
+    long long work = 0;
+#   pragma omp parallel for schedule(dynamic) reduction(+:work)
+    for (int i = 0; i < height; ++i)
+    {
+        float y = float(i)/float(height);
+        float dy = (y-0.5f)*extent;
+        for (int j = 0; j < width; ++j)
+        {
+            float x = float(j)/float(width);
+            float dx = (x-0.5f)*extent;
+            int n;
+            if (precision == Precision::double_single)
+                n = escape_time_double_single(ds_add(center_x, {dx, 0.f}), ds_add(center_y, {dy, 0.f}), max_iter);
+            else
+                n = escape_time_double(view.center_x + double(dx), view.center_y + double(dy), max_iter);
+            iterations[i*width+j] = n;
+            work += (n < max_iter ? n + 1 : max_iter);
+        }
+    }
+    return work;
+}
+// ====================================================================================================================
+long long compute_iterations_smooth(View const& view, unsigned shortcuts, float* smooth_iterations)
+{
+    const int width = view.width, height = view.height, max_iter = view.max_iter;
+    const float center_x = view.center_x, center_y = view.center_y, extent = view.extent;
+    long long work = 0;
+#   pragma omp parallel for schedule(dynamic) reduction(+:work)
+    for (int i = 0; i < height; ++i)
+    {
+        float y = float(i)/float(height);
+        float cy = center_y + (y-0.5f)*extent;
+        for (int j = 0; j < width; ++j)
+        {
+            float x  = float(j)/float(width);
+            float cx = center_x + (x-0.5f)*extent;
+            smooth_iterations[i*width+j] = smooth_escape_time(cx, cy, max_iter, shortcuts, work);
+        }
+    }
+    return work;
+}
+// --------------------------------------------------------------------------------------------------------------------
+long long compute_iterations_smooth(Isa isa, View const& view, unsigned shortcuts, int* iterations, float* smooth_iterations)
+{
+    switch(isa)
+    {
+    case Isa::avx512:
+        return iterations_avx512<KernelOutput::smooth>(view, shortcuts, 0, view.height, iterations, smooth_iterations);
+    case Isa::avx2:
+        return iterations_avx2<KernelOutput::smooth>(view, shortcuts, 0, view.height, iterations, smooth_iterations);
+    default:
+        return iterations_scalar<KernelOutput::smooth>(view, shortcuts, 0, view.height, iterations, smooth_iterations);
+    }
+}
+// ====================================================================================================================
+long long compute_distance_estimates(Isa isa, View const& view, unsigned shortcuts, int* iterations, float* smooth_iterations,
+                                     float* distances)
+{
+    switch(isa)
+    {
+    case Isa::avx512:
+        return iterations_avx512<KernelOutput::distance>(view, shortcuts, 0, view.height, iterations, smooth_iterations, distances);
+    case Isa::avx2:
+        return iterations_avx2<KernelOutput::distance>(view, shortcuts, 0, view.height, iterations, smooth_iterations, distances);
+    default:
+        return iterations_scalar<KernelOutput::distance>(view, shortcuts, 0, view.height, iterations, smooth_iterations, distances);
+    }
+}
+// ====================================================================================================================
+Palette const& cosine_palette()
+{
+    static const Palette palette = []
+    {
+        const float d[] = {0.3, 0.3, 0.5};
+        const float e[] = {-0.2, -0.3 ,-0.5};
+        const float f[] = {2.1, 2.0, 3.0};
+        const float g[] = {0.0, 0.1, 0.0};
+        Palette p;
+        for (int k = 0; k < Palette::size; ++k)
+        {
+            float t = float(k)/float(Palette::size-1);
+            p.colors[k].r = d[0] + e[0]*std::cos(6.28318f*(f[0]*t+g[0]));
+            p.colors[k].g = d[1] + e[1]*std::cos(6.28318f*(f[1]*t+g[1]));
+            p.colors[k].b = d[2] + e[2]*std::cos(6.28318f*(f[2]*t+g[2]));
+            p.colors[k].a = 1.f;
+        }
+        return p;
+    }();
+    return palette;
+}
+// --------------------------------------------------------------------------------------------------------------------
+namespace
+{
+// Comme packUnorm4x8 : chaque composante est bornée à [0, 1] puis arrondie au plus proche de c*255 (la valeur étant
+// positive, ajouter 0.5 et tronquer arrondit comme lround, mais se vectorise)
+inline std::uint32_t pack_unorm4x8(Pixel const& c)
+{
+    auto unorm8 = [](float x) { return std::uint32_t(255.f*std::clamp(x, 0.f, 1.f) + 0.5f); };
+    return unorm8(c.r) | (unorm8(c.g) << 8) | (unorm8(c.b) << 16) | (unorm8(c.a) << 24);
+}
+// ....................................................................................................................
+// Couleurs des nombres d'itérations entiers 0, ..., max_iter
+std::vector<Pixel> iteration_colors(int max_iter)
+{
+    Palette const& palette = cosine_palette();
+    std::vector<Pixel> colors(max_iter + 1);
+    for (int n = 0; n <= max_iter; ++n) colors[n] = palette(float(n)/float(max_iter));
+    return colors;
+}
+// ....................................................................................................................
+void colorize_counts(int nb_pixels, int max_iter, int const* iterations, Pixel* image)
+{
+    auto colors = iteration_colors(max_iter);
+#   pragma omp parallel for
+    for (int p = 0; p < nb_pixels; ++p)
+        image[p] = colors[std::clamp(iterations[p], 0, max_iter)];
+}
+
+void colorize_counts(int nb_pixels, int max_iter, float const* smooth_iterations, Pixel* image)
+{
+    Palette const& palette = cosine_palette();
+    const float inv_max_iter = 1.f/float(max_iter);
+#   pragma omp parallel for
+    for (int p = 0; p < nb_pixels; ++p)
+        image[p] = palette(smooth_iterations[p]*inv_max_iter);
+}
+// ....................................................................................................................
+void pack_counts(int nb_pixels, int max_iter, int const* iterations, std::uint32_t* image)
+{
+    auto colors = iteration_colors(max_iter);
+    std::vector<std::uint32_t> packed(colors.size());
+    for (std::size_t n = 0; n < colors.size(); ++n) packed[n] = pack_unorm4x8(colors[n]);
+#   pragma omp parallel for
+    for (int p = 0; p < nb_pixels; ++p)
+        image[p] = packed[std::clamp(iterations[p], 0, max_iter)];
+}
+
+void pack_counts(int nb_pixels, int max_iter, float const* smooth_iterations, std::uint32_t* image)
+{
+    Palette const& palette = cosine_palette();
+    const float inv_max_iter = 1.f/float(max_iter);
+#   pragma omp parallel for
+    for (int p = 0; p < nb_pixels; ++p)
+        image[p] = pack_unorm4x8(palette(smooth_iterations[p]*inv_max_iter));
+}
+// ....................................................................................................................
+template<typename Count>
+void store_counts(OutputFormat format, int nb_pixels, int max_iter, Count const* iterations, void* image)
+{
+    if (format == OutputFormat::rgba32f)
+    {
+        colorize_counts(nb_pixels, max_iter, iterations, static_cast<Pixel*>(image));
+        return;
+    }
+    if (format == OutputFormat::iteration_map)
+    {
+        auto* map = static_cast<float*>(image);
+#       pragma omp parallel for
+        for (int p = 0; p < nb_pixels; ++p) map[p] = float(iterations[p]);
+        return;
+    }
+    if (format == OutputFormat::iterations16)
+    {
+        // Octet de poids fort en premier (ordre des échantillons 16 bits d'un png)
+        auto* samples = static_cast<unsigned char*>(image);
+#       pragma omp parallel for
+        for (int p = 0; p < nb_pixels; ++p)
+        {
+            unsigned n = unsigned(std::min(iterations[p], Count(65535)));
+            samples[2*p]   = (unsigned char)(n >> 8);
+            samples[2*p+1] = (unsigned char)(n & 0xFF);
+        }
+        return;
+    }
+    pack_counts(nb_pixels, max_iter, iterations, static_cast<std::uint32_t*>(image));
+}
+}
+// --------------------------------------------------------------------------------------------------------------------
+void colorize(int nb_pixels, int max_iter, int const* iterations, Pixel* image)
+{
+    colorize_counts(nb_pixels, max_iter, iterations, image);
+}
+// --------------------------------------------------------------------------------------------------------------------
+void colorize(int nb_pixels, int max_iter, float const* smooth_iterations, Pixel* image)
+{
+    colorize_counts(nb_pixels, max_iter, smooth_iterations, image);
+}
+// --------------------------------------------------------------------------------------------------------------------
+char const* output_format_name(OutputFormat format)
+{
+    switch(format)
+    {
+    case OutputFormat::rgba8:
+        return "rgba8";
+    case OutputFormat::iterations16:
+        return "iterations16";
+    case OutputFormat::iteration_map:
+        return "carte";
+    default:
+        return "rgba32f";
+    }
+}
+// --------------------------------------------------------------------------------------------------------------------
+void store_image(OutputFormat format, int nb_pixels, int max_iter, int const* iterations, void* image)
+{
+    store_counts(format, nb_pixels, max_iter, iterations, image);
+}
+// --------------------------------------------------------------------------------------------------------------------
+void store_image(OutputFormat format, int nb_pixels, int max_iter, float const* smooth_iterations, void* image)
+{
+    store_counts(format, nb_pixels, max_iter, smooth_iterations, image);
+}
+// --------------------------------------------------------------------------------------------------------------------
+void store_image(OutputFormat format, int nb_pixels, int max_iter, float const* smooth_iterations, float const* distances,
+                 void* image)
+{
+    if (format != OutputFormat::rgba32f && format != OutputFormat::rgba8)
+    {
+        store_counts(format, nb_pixels, max_iter, smooth_iterations, image);
+        return;
+    }
+    Palette const& palette = cosine_palette();
+    const float inv_max_iter = 1.f/float(max_iter);
+#   pragma omp parallel for
+    for (int p = 0; p < nb_pixels; ++p)
+    {
+        Pixel color = palette(smooth_iterations[p]*inv_max_iter);
+        float shade = distance_shade(distances[p]);
+        color.r *= shade; color.g *= shade; color.b *= shade;
+        if (format == OutputFormat::rgba8)
+            static_cast<std::uint32_t*>(image)[p] = pack_unorm4x8(color);
+        else
+            static_cast<Pixel*>(image)[p] = color;
+    }
+}
+// ====================================================================================================================
+void colorize_map(Coloring const& coloring, int nb_pixels, int max_iter, float const* map, std::uint32_t* image)
+{
+    // Fonction de répartition des parties entières des pixels ayant divergé : cdf[k] = proportion de ces pixels ayant
+    // moins de k itérations, pour k = 0, ..., max_iter
+    std::vector<float> cdf(max_iter + 1, 0.f);
+    if (coloring.mapping == ColorMapping::equalized)
+    {
+        std::vector<long long> histogram(max_iter, 0);
+        long long* hist = histogram.data();
+#       pragma omp parallel for reduction(+:hist[:max_iter])
+        for (int p = 0; p < nb_pixels; ++p)
+            if (map[p] < float(max_iter)) hist[int(map[p])] += 1;
+        long long total = 0;
+        for (int k = 0; k < max_iter; ++k) total += histogram[k];
+        long long cumul = 0;
+        for (int k = 0; k <= max_iter; ++k)
+        {
+            cdf[k] = float(cumul)/float(std::max(total, 1LL));
+            if (k < max_iter) cumul += histogram[k];
+        }
+    }
+    // Position de chaque pixel dans la palette, puis mêmes opérations que Palette::operator() et pack_unorm4x8 sur des
+    // tableaux de flottants. Les deux boucles sont séparées et sans branchement pour que la première soit vectorisée
+    // (lectures de la fonction de répartition par gather)
+    std::vector<float> positions(nb_pixels);
+    float* position = positions.data();
+    const float* cumulative = cdf.data();
+    const bool  equalized = (coloring.mapping == ColorMapping::equalized);
+    const float density = coloring.density, offset = coloring.offset;
+#   pragma omp parallel for simd
+    for (int p = 0; p < nb_pixels; ++p)
+    {
+        float mu = map[p];
+        bool  escaped = (mu < float(max_iter));
+        int   n = int(std::min(std::max(mu, 0.f), float(max_iter - 1)));
+        float t_equalized = cumulative[n] + (cumulative[n+1] - cumulative[n])*(mu - float(n));
+        float t = equalized ? t_equalized : mu/float(max_iter);
+        t = t*density + offset;
+        // Repli dans ]0, 1] : ceil(t) - 1 est négatif ou nul tant que t <= 1
+        t -= std::max(std::ceil(t) - 1.f, 0.f);
+        t = escaped ? t : 1.f;
+        position[p] = std::min(std::max(t, 0.f), 1.f)*float(Palette::size-1);
+    }
+    const float* colors = &cosine_palette().colors[0].r;
+#   pragma omp parallel for
+    for (int p = 0; p < nb_pixels; ++p)
+    {
+        float s = position[p];
+        int   k = std::min(int(s), Palette::size-2);
+        float a = s - float(k);
+        std::uint32_t packed = 0;
+        for (int c = 0; c < 4; ++c)
+        {
+            float v = colors[4*k+c]*(1.f-a) + colors[4*k+4+c]*a;
+            packed |= std::uint32_t(255.f*std::min(std::max(v, 0.f), 1.f) + 0.5f) << (8*c);
+        }
+        image[p] = packed;
+    }
+}
+// ====================================================================================================================
+SupersamplingReport compute_antialiased(Isa isa, View const& view, unsigned shortcuts, int samples, std::uint32_t* image,
+                                        bool adaptive)
+{
+    const int width = view.width, height = view.height, max_iter = view.max_iter;
+    const float center_x = view.center_x, center_y = view.center_y, extent = view.extent;
+    const int nb_pixels = width * height;
+    SupersamplingReport report;
+
+    // Première passe : centre de chaque pixel
+    std::vector<int> iterations(nb_pixels);
+    report.work = compute_iterations(isa, view, shortcuts, iterations.data());
+    pack_counts(nb_pixels, max_iter, iterations.data(), image);
+
+    // Deuxième passe : détection des bords, puis liste compacte des pixels à suréchantillonner
+    std::vector<unsigned char> is_edge(nb_pixels);
+#   pragma omp parallel for
+    for (int i = 0; i < height; ++i)
+        for (int j = 0; j < width; ++j)
+        {
+            int  n = iterations[i*width+j];
+            bool edge = not adaptive;
+            for (int di = std::max(i-1, 0); di <= std::min(i+1, height-1); ++di)
+                for (int dj = std::max(j-1, 0); dj <= std::min(j+1, width-1); ++dj)
+                    edge |= (iterations[di*width+dj] != n);
+            is_edge[i*width+j] = edge;
+        }
+    std::vector<int> refined;
+    for (int p = 0; p < nb_pixels; ++p)
+        if (is_edge[p]) refined.push_back(p);
+    const int nb_refined = int(refined.size());
+
+    // Troisième passe : moyenne des couleurs de samples x samples points dans chaque pixel d'un bord. Les points sont
+    // rangés par paquets dans des listes compactes itérées par les noyaux vectoriels de la reprise (depuis z = 0, sans
+    // raccourci), ce qui borne la mémoire supplémentaire
+    constexpr const int pixels_per_chunk = 4096;
+    const int nb_sub = samples * samples;
+    std::vector<float> cx(pixels_per_chunk * nb_sub), cy(cx.size()), zr(cx.size()), zi(cx.size());
+    std::vector<int>   n(cx.size());
+    auto colors = iteration_colors(max_iter);
+    const float inv_nb_samples = 1.f/float(nb_sub);
+    long long refined_work = 0;
+    for (int first = 0; first < nb_refined; first += pixels_per_chunk)
+    {
+        const int nb_chunk = std::min(pixels_per_chunk, nb_refined - first);
+#       pragma omp parallel for
+        for (int r = 0; r < nb_chunk; ++r)
+        {
+            const int p = refined[first + r];
+            const int i = p / width, j = p - i * width;
+            for (int a = 0; a < samples; ++a)
+            {
+                float y = (float(i) + (float(a) + 0.5f)/float(samples) - 0.5f)/float(height);
+                for (int b = 0; b < samples; ++b)
+                {
+                    float x = (float(j) + (float(b) + 0.5f)/float(samples) - 0.5f)/float(width);
+                    const int k = r * nb_sub + a * samples + b;
+                    cx[k] = center_x + (x-0.5f)*extent;
+                    cy[k] = center_y + (y-0.5f)*extent;
+                    zr[k] = zi[k] = 0.f;
+                }
+            }
+        }
+        const int nb_points = nb_chunk * nb_sub;
+        switch(isa)
+        {
+        case Isa::avx512:
+            refined_work += resume_avx512(0, max_iter, nb_points, cx.data(), cy.data(), zr.data(), zi.data(), n.data());
+            break;
+        case Isa::avx2:
+            refined_work += resume_avx2(0, max_iter, nb_points, cx.data(), cy.data(), zr.data(), zi.data(), n.data());
+            break;
+        default:
+            refined_work += resume_scalar(0, max_iter, nb_points, cx.data(), cy.data(), zr.data(), zi.data(), n.data());
+            break;
+        }
+#       pragma omp parallel for
+        for (int r = 0; r < nb_chunk; ++r)
+        {
+            Pixel sum{0.f, 0.f, 0.f, 0.f};
+            for (int k = r * nb_sub; k < (r + 1) * nb_sub; ++k)
+            {
+                Pixel const& c = colors[n[k]];
+                sum.r += c.r; sum.g += c.g; sum.b += c.b; sum.a += c.a;
+            }
+            image[refined[first + r]] = pack_unorm4x8(Pixel{sum.r*inv_nb_samples, sum.g*inv_nb_samples,
+                                                            sum.b*inv_nb_samples, sum.a*inv_nb_samples});
+        }
+    }
+
+    report.nb_refined = nb_refined;
+    report.nb_samples = nb_pixels + (long long)nb_refined * samples * samples;
+    report.work      += refined_work;
+    return report;
+}
+}
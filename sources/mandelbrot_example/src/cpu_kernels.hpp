@@ -0,0 +1,514 @@
+#ifndef _MANDELBROT_CPU_KERNELS_HPP_
+#define _MANDELBROT_CPU_KERNELS_HPP_
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+
+namespace mandelbrot
+{
+/**
+ * @brief Couleur RGBA d'un pixel (même disposition mémoire que la structure Pixel du shader de calcul)
+ */
+struct Pixel { float r,g, b, a; };
+
+constexpr const int max_iterations = 512; // Nombre maximal d'itérations par défaut pour décider si un point appartient à l'ensemble
+
+/**
+ * @brief Paramètres d'un rendu : taille de l'image, fenêtre du plan complexe et nombre maximal d'itérations
+ *
+ * Le pixel (i, j) (ligne i, colonne j) correspond au point c = cx + i.cy du plan complexe avec
+ *
+ *     cx = center_x + (j/width  - 0.5).extent
+ *     cy = center_y + (i/height - 0.5).extent
+ *
+ * La même structure est transmise telle quelle au shader de calcul par des constantes poussées (push constants) : sa
+ * disposition mémoire (six scalaires de 4 octets) doit rester identique au début du bloc push_constant de shader.comp.
+ */
+struct View
+{
+    int   width    = 3200;            // Nombre de pixels en x
+    int   height   = 2400;            // Nombre de pixels en y
+    float center_x = -0.445f;         // Centre de la fenêtre dans le plan complexe
+    float center_y =  0.0f;
+    float extent   = 2.f + 1.7f*0.2f; // Largeur (et hauteur) de la fenêtre dans le plan complexe
+    int   max_iter = max_iterations;  // Nombre maximal d'itérations
+};
+
+/**
+ * @brief Raccourcis optionnels pour les points de l'intérieur de l'ensemble (combinables avec |)
+ *
+ * - interior_test : test analytique d'appartenance à la cardioïde principale et au bourgeon de période 2. Les points
+ *                   concernés reçoivent directement max_iter itérations sans aucune itération de la suite.
+ * - periodicity_test : détection de cycle à la Brent. L'itéré est mémorisé aux itérations 8, 16, 32, ... et on arrête
+ *                   d'itérer (le point est alors considéré dans l'ensemble) si un itéré ultérieur revient à moins de
+ *                   periodicity_tolerance de l'itéré mémorisé. Ce test est approché : quelques points très proches du
+ *                   bord peuvent être pris pour des points de l'ensemble.
+ */
+enum Shortcut : unsigned { no_shortcut = 0, interior_test = 1, periodicity_test = 2 };
+
+constexpr const float periodicity_tolerance = 1.E-6f;
+
+/**
+ * @brief Jeux d'instructions vectorielles disponibles pour le calcul des itérations sur CPU
+ */
+enum class Isa { scalar, avx2, avx512 };
+
+/**
+ * @brief Renvoie le jeu d'instructions le plus large supporté par le processeur exécutant le code
+ */
+Isa detect_isa();
+
+/**
+ * @brief Renvoie le nom d'un jeu d'instructions (pour l'affichage)
+ */
+char const* isa_name(Isa isa);
+
+/**
+ * @brief Calcule pour chaque pixel le nombre d'itérations n (0 <= n <= view.max_iter) avant que la suite z_{k+1} = z_k^2 + c ne diverge
+ *
+ * Le calcul est parallélisé par lignes avec OpenMP. Avec les versions vectorielles, chaque thread traite 8 (AVX2) ou 16 (AVX-512)
+ * pixels par vecteur : chaque voie du vecteur possède son compteur d'itérations et un masque indiquant si elle a déjà divergé.
+ * On quitte la boucle dès que toutes les voies ont divergé.
+ *
+ * Les trois versions effectuent exactement les mêmes opérations flottantes dans le même ordre (sans contraction en FMA, voir
+ * CMakeLists.txt) : elles donnent donc exactement les mêmes nombres d'itérations.
+ *
+ * @param isa        Le jeu d'instructions à utiliser (doit être supporté par le processeur)
+ * @param view       Taille de l'image, fenêtre du plan complexe et nombre maximal d'itérations
+ * @param shortcuts  Combinaison de valeurs de Shortcut
+ * @param iterations Tableau de view.width*view.height entiers recevant le nombre d'itérations de chaque pixel (rangé par ligne)
+ * @return Le nombre total d'itérations de la suite effectivement calculées (somme sur tous les pixels)
+ */
+long long compute_iterations(Isa isa, View const& view, unsigned shortcuts, int* iterations);
+
+/**
+ * @brief Même calcul que compute_iterations, restreint aux lignes row_begin <= i < row_end de l'image
+ *
+ * iterations est toujours le tableau de toute l'image : seules les lignes demandées sont écrites. Appelée depuis une
+ * région parallèle (co-rendu CPU+GPU), la boucle OpenMP interne n'utilise que le thread appelant (parallélisme imbriqué
+ * inactif par défaut).
+ *
+ * @return Le nombre d'itérations calculées pour ces lignes
+ */
+long long compute_iterations_rows(Isa isa, View const& view, unsigned shortcuts, int row_begin, int row_end, int* iterations);
+
+/**
+ * @brief Mesures d'un calcul instrumenté : coût de chaque tuile de l'image et charge de chaque thread
+ *
+ * Les tuiles ont la taille des groupes de travail du shader principal, pour comparer directement le CPU et le GPU.
+ * Les champs des threads restent vides pour un profil GPU (ComputingPipeline::render_profiled).
+ */
+struct IterationProfile
+{
+    int tile_size  = 32;   // Côté des tuiles (en pixels)
+    int nb_tiles_x = 0;
+    int nb_tiles_y = 0;
+    std::vector<long long> tile_work;       // Itérations calculées dans chaque tuile (tuiles rangées par ligne)
+    std::vector<double>    thread_busy_ms;  // Temps passé par chaque thread à calculer ses lignes
+    std::vector<int>       thread_rows;     // Nombre de lignes calculées par chaque thread
+    std::vector<long long> thread_work;     // Itérations calculées par chaque thread
+    double    elapsed_ms = 0.;              // Durée totale du calcul
+    long long work       = 0;               // Nombre total d'itérations calculées
+};
+
+/**
+ * @brief Même calcul que compute_iterations (version scalaire, mêmes nombres d'itérations), instrumenté
+ *
+ * Les lignes sont réparties entre les threads par schedule(dynamic) comme dans compute_iterations. On mesure le temps
+ * passé par chaque thread dans ses lignes (le reste de la durée de la région parallèle est de l'attente) et on cumule
+ * le nombre d'itérations calculées de chaque pixel dans sa tuile. Les mesures coûtent deux lectures d'horloge par
+ * ligne.
+ *
+ * @param profile Reçoit les mesures ; profile.tile_size est la taille de tuile utilisée
+ * @return Le nombre total d'itérations calculées
+ */
+long long compute_iterations_profiled(View const& view, unsigned shortcuts, int* iterations, IterationProfile& profile);
+
+/**
+ * @brief Calcule les mêmes nombres d'itérations que compute_iterations (noyau scalaire) par subdivision de Mariani-Silver
+ *
+ * On calcule d'abord le bord de l'image. Si tous les pixels du bord d'un rectangle sont dans la cardioïde principale (ou
+ * tous dans le bourgeon de période 2), l'intérieur y est aussi et il est rempli avec max_iter sans itérer. Sinon, le
+ * rectangle est découpé en quatre (en calculant seulement la ligne et la colonne médianes) et chaque quart est traité
+ * récursivement par une tâche OpenMP. Les rectangles de petite taille sont calculés directement, pixel par pixel.
+ *
+ * Remplir un rectangle dont le bord a un nombre d'itérations uniforme ne donne pas le même résultat : un filament plus
+ * fin qu'un pixel passe entre deux pixels du bord et laisse à l'intérieur des pixels isolés qui divergent (29 pixels de
+ * la fenêtre par défaut). On ne remplit donc que des domaines dont l'appartenance à l'ensemble est démontrée. Le gain
+ * vient des pixels de ces domaines, qui coûtent chacun max_iter itérations sans raccourci : avec le test analytique
+ * (interior_test), ils ne coûtent déjà plus rien et le calcul est aussi coûteux que compute_iterations.
+ *
+ * @return Le nombre total d'itérations de la suite effectivement calculées
+ */
+long long compute_iterations_subdivision(View const& view, unsigned shortcuts, int* iterations);
+
+/**
+ * @brief État du calcul permettant de reprendre les itérations avec un nombre maximal d'itérations plus grand
+ *
+ * Seuls les pixels n'ayant pas encore divergé sont conservés, dans une liste compacte (structure de tableaux) : pour
+ * chacun, son indice dans l'image, le point c et le dernier itéré z. Leur nombre d'itérations vaut view.max_iter (nombre
+ * d'itérations déjà effectuées) : il n'a donc pas besoin d'être stocké.
+ */
+struct ResumeState
+{
+    View view{0, 0, 0.f, 0.f, 0.f, 0}; // Paramètres du dernier calcul (max_iter = nombre d'itérations déjà effectuées)
+    std::vector<int>   index;          // Indice dans l'image de chaque pixel actif
+    std::vector<float> cx, cy;         // Point c de chaque pixel actif
+    std::vector<float> zr, zi;         // Dernier itéré de chaque pixel actif
+};
+
+/**
+ * @brief Calcule les nombres d'itérations en reprenant si possible un calcul précédent
+ *
+ * Si state provient d'un calcul de même taille et de même fenêtre que view avec un nombre maximal d'itérations inférieur
+ * ou égal, on ne reprend que les pixels actifs à partir de leur dernier itéré : seules les itérations supplémentaires
+ * sont calculées. Sinon, on repart de z = 0 pour tous les pixels. Le résultat est identique à celui de compute_iterations
+ * (sans raccourci) avec le nombre maximal d'itérations view.max_iter.
+ *
+ * @param iterations Nombres d'itérations de chaque pixel. Lors d'une reprise, seuls les pixels actifs sont mis à jour : il
+ *                   faut donc repasser le tableau du calcul précédent.
+ * @return Le nombre total d'itérations de la suite effectivement calculées
+ */
+long long compute_iterations_resumable(Isa isa, View const& view, ResumeState& state, int* iterations);
+
+/**
+ * @brief Arithmétiques disponibles pour le calcul direct de la suite (sans perturbation)
+ *
+ * - single        : simple précision (24 bits de mantisse), comme compute_iterations et shader.comp ;
+ * - double_single : double simple (« float-float ») : chaque réel est la somme non évaluée hi + lo de deux flottants
+ *                   simple précision, soit environ 48 bits de mantisse avec uniquement des opérations en simple précision
+ *                   (shader double_single.comp, utilisable sur tous les GPU) ;
+ * - native_double : double précision (53 bits), shader double.comp qui nécessite la fonctionnalité shaderFloat64.
+ */
+enum class Precision { single, double_single, native_double };
+
+/**
+ * @brief Renvoie le nom d'une arithmétique (pour l'affichage)
+ */
+char const* precision_name(Precision precision);
+
+/**
+ * @brief Paramètres d'un rendu avec centre et étendue en double précision
+ *
+ * Même signification que View. La structure est transmise telle quelle au shader double.comp : sa disposition mémoire
+ * (avec le remplissage de 4 octets après height) doit rester identique à son bloc push_constant.
+ */
+struct PreciseView
+{
+    int    width    = 3200;
+    int    height   = 2400;
+    double center_x = -0.445;
+    double center_y =  0.0;
+    double extent   = 2.34;
+    int    max_iter = max_iterations;
+};
+
+/**
+ * @brief Indique si une arithmétique est assez précise pour la fenêtre demandée
+ *
+ * Il faut distinguer deux pixels voisins à la distance du centre à l'origine : on demande log2(|c|/pas du pixel) bits de
+ * mantisse, plus 6 bits de garde pour l'accumulation des erreurs d'arrondi au fil des itérations.
+ */
+bool is_precise_enough(Precision precision, PreciseView const& view);
+
+/**
+ * @brief Calcule les nombres d'itérations avec l'arithmétique demandée (noyaux scalaires parallélisés avec OpenMP)
+ *
+ * Le noyau double simple effectue exactement les mêmes opérations que le shader double_single.comp.
+ *
+ * @return Le nombre total d'itérations de la suite calculées
+ */
+long long compute_iterations_precise(Precision precision, PreciseView const& view, int* iterations);
+
+/**
+ * @brief Familles de fractales à temps d'échappement (valeurs de la constante de spécialisation FRACTAL de shader.comp)
+ *
+ * - mandelbrot   : z_{k+1} = z_k^d + c, z_0 = 0, c le point du pixel ;
+ * - julia        : z_{k+1} = z_k^d + c, z_0 le point du pixel, c une constante ;
+ * - burning_ship : z_{k+1} = (|Re z_k| + i|Im z_k|)^d + c, z_0 = 0, c le point du pixel.
+ */
+enum class Fractal : std::uint32_t { mandelbrot = 0, julia = 1, burning_ship = 2 };
+
+/**
+ * @brief Renvoie le nom d'une famille de fractales (pour l'affichage et l'option --fractale)
+ */
+char const* fractal_name(Fractal fractal);
+
+constexpr const int max_fractal_power = 8; // Plus grand exposant d disponible (2 <= d <= max_fractal_power)
+
+/**
+ * @brief Fractale calculée : famille, exposant d et constante c des ensembles de Julia
+ */
+struct FractalFamily
+{
+    Fractal kind    = Fractal::mandelbrot;
+    int     power   = 2;
+    float   julia_x = -0.8f;
+    float   julia_y =  0.156f;
+
+    /**
+     * @brief Vrai pour l'ensemble de mandelbrot usuel (d = 2), le seul dont disposent les raccourcis analytiques,
+     *        l'estimation de distance et les autres modes de calcul
+     */
+    bool is_standard() const { return kind == Fractal::mandelbrot && power == 2; }
+};
+
+/**
+ * @brief Calcule les nombres d'itérations de chaque pixel pour une fractale quelconque de la famille
+ *
+ * Le noyau est un patron paramétré à la compilation par la famille et l'exposant : le pas de la suite est choisi par
+ * if constexpr et la puissance est une boucle de bornes constantes, déroulée par le compilateur. Le choix de
+ * l'instanciation est fait une fois par appel : la boucle interne ne contient aucun branchement sur la famille. Pour
+ * l'ensemble de mandelbrot usuel, les opérations sont celles du noyau scalaire de compute_iterations (mêmes résultats).
+ *
+ * Un point diverge lorsque |z|^2 dépasse 2 (mandelbrot, comme compute_iterations) ou 4 (julia et burning_ship, dont les
+ * ensembles débordent du disque de rayon racine de 2). Le test de la cardioïde et du bourgeon n'est appliqué qu'à
+ * l'ensemble de mandelbrot usuel ; la détection de cycle vaut pour toutes les familles.
+ *
+ * @return Le nombre total d'itérations de la suite calculées
+ */
+long long compute_iterations_family(FractalFamily const& family, View const& view, unsigned shortcuts, int* iterations);
+
+/**
+ * @brief Même chose avec le nombre d'itérations continu (voir compute_iterations_smooth), généralisé à l'exposant d :
+ *        mu = n + 1 + k - log_d(log2|z| / log2(smooth_escape_radius))
+ */
+long long compute_iterations_family(FractalFamily const& family, View const& view, unsigned shortcuts, float* smooth_iterations);
+
+/**
+ * @brief Calcule comme compute_iterations (noyau scalaire) le nombre d'itérations continu de chaque pixel
+ *
+ * Pour un pixel qui diverge après n itérations (|z|^2 > 2), on continue d'itérer jusqu'à ce que |z| dépasse le rayon
+ * smooth_escape_radius (au plus smooth_max_extra_iterations itérés supplémentaires, k au total) puis on calcule le nombre
+ * d'itérations normalisé
+ *
+ *     mu = n + 1 + k - log2(log2|z| / log2(smooth_escape_radius))
+ *
+ * qui varie continûment d'un pixel à l'autre (plus de bandes de couleur). Les pixels n'ayant pas divergé reçoivent max_iter.
+ *
+ * @param smooth_iterations Tableau de view.width*view.height réels recevant mu (borné à [0, view.max_iter])
+ * @return Le nombre total d'itérations de la suite calculées (sans les itérés supplémentaires)
+ */
+long long compute_iterations_smooth(View const& view, unsigned shortcuts, float* smooth_iterations);
+
+/**
+ * @brief Calcule en une seule passe les nombres d'itérations (comme compute_iterations) et les nombres d'itérations
+ *        continus (comme compute_iterations_smooth, mêmes valeurs) avec le jeu d'instructions demandé
+ *
+ * Dans les noyaux vectoriels, une voie qui a divergé continue d'itérer avec les autres : on conserve son premier itéré
+ * hors du disque, à partir duquel les itérés supplémentaires et les logarithmes de mu sont calculés voie par voie.
+ *
+ * @return Le nombre total d'itérations de la suite calculées (sans les itérés supplémentaires)
+ */
+long long compute_iterations_smooth(Isa isa, View const& view, unsigned shortcuts, int* iterations, float* smooth_iterations);
+
+constexpr const float smooth_escape_radius = 256.f;
+constexpr const int   smooth_max_extra_iterations = 16;
+
+/**
+ * @brief Calcule, en plus du nombre d'itérations continu, une estimation de la distance de chaque pixel au bord de l'ensemble
+ *
+ * La dérivée dz/dc est itérée avec la suite (dz_{k+1} = 2.z_k.dz_k + 1, dz_0 = 0). Pour un point qui diverge, après les
+ * mêmes itérés supplémentaires que compute_iterations_smooth, la distance de c au bord est estimée par
+ *
+ *     d = |z|.ln|z| / |dz|
+ *
+ * exprimée en pixels (divisée par le plus grand des deux pas de la grille). Contrairement au nombre d'itérations, d ne
+ * dépend pas de la position du point dans le pixel au point de manquer les filaments : un filament plus fin qu'un pixel
+ * est vu comme une distance inférieure à un pixel par tous ses voisins, à partir d'un seul point par pixel.
+ *
+ * La dérivée est itérée dans la même passe que les nombres d'itérations, par le noyau du jeu d'instructions demandé (mêmes
+ * valeurs pour les trois noyaux). Près du bord, dz peut dépasser le plus grand flottant : une distance infinie ou NaN est
+ * remplacée par 0.
+ *
+ * @param iterations        Tableau de view.width*view.height entiers recevant n, comme compute_iterations
+ * @param smooth_iterations Tableau de view.width*view.height réels recevant mu, comme compute_iterations_smooth
+ * @param distances         Tableau de view.width*view.height réels recevant d (-1 pour les pixels n'ayant pas divergé)
+ * @return Le nombre total d'itérations de la suite calculées (sans les itérés supplémentaires)
+ */
+long long compute_distance_estimates(Isa isa, View const& view, unsigned shortcuts, int* iterations, float* smooth_iterations,
+                                     float* distances);
+
+constexpr const float distance_shading_width = 2.f; // Distance (en pixels) en deçà de laquelle la couleur est assombrie
+
+/**
+ * @brief Assombrissement d'un pixel à la distance d (en pixels) du bord : sqrt(min(d/distance_shading_width, 1)), 1 si le
+ *        pixel n'a pas divergé (d < 0). Même calcul que shader.comp.
+ */
+inline float distance_shade(float distance)
+{
+    return distance < 0.f ? 1.f : std::sqrt(std::min(distance/distance_shading_width, 1.f));
+}
+
+/**
+ * @brief Palette précalculée : la palette en cosinus (http://iquilezles.org/www/articles/palettes/palettes.htm)
+ *        échantillonnée en size couleurs régulièrement espacées sur [0, 1]
+ *
+ * La couleur d'un réel t est interpolée linéairement entre les deux échantillons voisins de t (borné à [0, 1]) : plus
+ * aucun cosinus n'est calculé par pixel. shader.comp effectue la même interpolation dans la même table, transmise dans un
+ * buffer de stockage.
+ */
+struct Palette
+{
+    static constexpr const int size = 1024;
+    Pixel colors[size];
+
+    Pixel operator()(float t) const
+    {
+        float s = std::min(std::max(t, 0.f), 1.f)*float(size-1);
+        int   k = std::min(int(s), size-2);
+        float a = s - float(k);
+        Pixel const& c0 = colors[k];
+        Pixel const& c1 = colors[k+1];
+        return Pixel{c0.r*(1.f-a) + c1.r*a, c0.g*(1.f-a) + c1.g*a, c0.b*(1.f-a) + c1.b*a, c0.a*(1.f-a) + c1.a*a};
+    }
+};
+
+/**
+ * @brief Renvoie la palette en cosinus (calculée au premier appel)
+ */
+Palette const& cosine_palette();
+
+/**
+ * @brief Calcule la couleur de chaque pixel à partir de son nombre d'itérations (t = n/max_iter dans la palette précalculée)
+ *
+ * Les nombres d'itérations étant entiers, les max_iter+1 couleurs possibles sont d'abord tirées de la palette : chaque
+ * pixel ne coûte plus qu'une lecture dans cette table. La mise en couleur ne dépend que de la carte des nombres
+ * d'itérations : on peut la refaire sans itérer de nouveau.
+ */
+void colorize(int nb_pixels, int max_iter, int const* iterations, Pixel* image);
+
+/**
+ * @brief Même chose avec les nombres d'itérations continus de compute_iterations_smooth (coloration continue)
+ */
+void colorize(int nb_pixels, int max_iter, float const* smooth_iterations, Pixel* image);
+
+/**
+ * @brief Formats de l'image calculée (buffer de stockage du GPU ou tableau du CPU)
+ *
+ * - rgba32f      : couleur RGBA en flottants (structure Pixel, 16 octets par pixel), convertie en octets à la sauvegarde ;
+ * - rgba8        : couleur RGBA sur 4 octets (packUnorm4x8 dans le shader). Les octets sont dans l'ordre attendu par
+ *                  l'encodeur png : l'image est encodée directement depuis la mémoire, sans conversion ;
+ * - iterations16 : nombre d'itérations brut sur 2 octets (plafonné à 65535) rangé en gros-boutiste, c'est-à-dire comme
+ *                  les échantillons d'un png en niveaux de gris 16 bits. Deux pixels consécutifs partagent un mot de
+ *                  4 octets du buffer de stockage.
+ * - iteration_map : carte des nombres d'itérations en flottants (4 octets par pixel), continus avec la coloration
+ *                  continue. C'est la sortie de la première passe d'un rendu en deux passes : la mise en couleur est
+ *                  faite ensuite par colorize_map (ou le shader colorize.comp) et peut être refaite à volonté.
+ *
+ * Les valeurs de l'énumération sont celles de la constante de spécialisation OUTPUT_FORMAT de shader.comp.
+ */
+enum class OutputFormat : std::uint32_t { rgba32f = 0, rgba8 = 1, iterations16 = 2, iteration_map = 3 };
+
+/**
+ * @brief Renvoie le nom d'un format d'image (pour l'affichage et l'option --sortie)
+ */
+char const* output_format_name(OutputFormat format);
+
+/**
+ * @brief Taille en octets d'une image de nb_pixels pixels au format demandé (arrondie à un multiple de 4 octets)
+ */
+constexpr std::size_t image_size_in_bytes(OutputFormat format, std::size_t nb_pixels)
+{
+    switch(format)
+    {
+    case OutputFormat::rgba8:
+    case OutputFormat::iteration_map:
+        return 4*nb_pixels;
+    case OutputFormat::iterations16:
+        return 4*((nb_pixels + 1)/2);
+    default:
+        return sizeof(Pixel)*nb_pixels;
+    }
+}
+
+/**
+ * @brief Écrit l'image au format demandé à partir des nombres d'itérations (même palette et mêmes arrondis que shader.comp)
+ *
+ * @param image Tableau d'au moins image_size_in_bytes(format, nb_pixels) octets, aligné sur 16 octets
+ */
+void store_image(OutputFormat format, int nb_pixels, int max_iter, int const* iterations, void* image);
+
+/**
+ * @brief Même chose avec les nombres d'itérations continus de compute_iterations_smooth (le format iterations16 n'en
+ *        garde que la partie entière)
+ */
+void store_image(OutputFormat format, int nb_pixels, int max_iter, float const* smooth_iterations, void* image);
+
+/**
+ * @brief Même chose en assombrissant les couleurs (formats rgba32f et rgba8) près du bord d'après les distances de
+ *        compute_distance_estimates (voir distance_shade). Les formats iterations16 et iteration_map ne gardent que mu.
+ */
+void store_image(OutputFormat format, int nb_pixels, int max_iter, float const* smooth_iterations, float const* distances,
+                 void* image);
+
+/**
+ * @brief Correspondance entre nombre d'itérations et position dans la palette pour la mise en couleur d'une carte
+ *
+ * - linear    : t = mu/max_iter ;
+ * - equalized : égalisation d'histogramme, t = proportion des pixels ayant divergé en moins de mu itérations (fonction de
+ *               répartition des parties entières, interpolée linéairement entre deux entiers). Les couleurs sont alors
+ *               réparties uniformément sur l'image quelle que soit la fenêtre, mais il faut une réduction globale
+ *               (l'histogramme) sur toute la carte.
+ */
+enum class ColorMapping : std::uint32_t { linear = 0, equalized = 1 };
+
+/**
+ * @brief Paramètres de la mise en couleur (seconde passe) d'une carte des nombres d'itérations
+ *
+ * La position t obtenue par mapping est transformée en t.density + offset, ramenée dans ]0, 1] : density est le nombre
+ * de parcours de la palette et offset (dans [0, 1[) la décale. Les pixels n'ayant pas divergé (mu = max_iter) prennent
+ * toujours la dernière couleur de la palette.
+ */
+struct Coloring
+{
+    ColorMapping mapping = ColorMapping::linear;
+    float        density = 1.f;
+    float        offset  = 0.f;
+};
+
+/**
+ * @brief Met en couleur (RGBA sur 4 octets, comme le format rgba8) une carte des nombres d'itérations, sans itérer
+ *
+ * Mêmes opérations que le shader colorize.comp.
+ *
+ * @param map   Carte de nb_pixels nombres d'itérations (entiers ou continus) entre 0 et max_iter
+ * @param image Tableau de nb_pixels mots recevant les couleurs
+ */
+void colorize_map(Coloring const& coloring, int nb_pixels, int max_iter, float const* map, std::uint32_t* image);
+
+/**
+ * @brief Bilan d'un rendu anticrénelé par suréchantillonnage adaptatif (compute_antialiased)
+ */
+struct SupersamplingReport
+{
+    long long nb_refined = 0; // Nombre de pixels suréchantillonnés (pixels d'un bord)
+    long long nb_samples = 0; // Nombre de points calculés : un par pixel plus samples^2 par pixel suréchantillonné
+    long long work       = 0; // Nombre total d'itérations de la suite calculées
+};
+
+/**
+ * @brief Calcule une image anticrénelée (RGBA sur 4 octets, comme le format rgba8) en ne suréchantillonnant que les
+ *        bords de l'ensemble et des bandes d'itérations
+ *
+ * Trois passes :
+ * 1. nombre d'itérations au centre de chaque pixel (compute_iterations) et couleur correspondante ;
+ * 2. détection des bords sur cette carte : un pixel est suréchantillonné si un de ses huit voisins a un autre nombre
+ *    d'itérations ;
+ * 3. pour ces pixels seulement, samples x samples points régulièrement répartis dans le pixel, à (b + 0.5)/samples - 0.5
+ *    pixel du centre dans chaque direction (b = 0, ..., samples-1), dont les couleurs sont moyennées. Ces points sont
+ *    itérés sans raccourci, par les noyaux vectoriels du calcul avec reprise appliqués à des listes de points.
+ *
+ * Mêmes opérations que le shader supersample.comp.
+ *
+ * @param samples  Nombre de points par pixel dans chaque direction
+ * @param image    Tableau de view.width*view.height mots recevant les couleurs
+ * @param adaptive Si faux, tous les pixels sont suréchantillonnés (suréchantillonnage uniforme, pour comparaison)
+ */
+SupersamplingReport compute_antialiased(Isa isa, View const& view, unsigned shortcuts, int samples, std::uint32_t* image,
+                                        bool adaptive = true);
+}
+
+#endif
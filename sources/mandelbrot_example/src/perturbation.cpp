@@ -0,0 +1,494 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <immintrin.h>
+#include "perturbation.hpp"
+
+namespace mandelbrot
+{
+namespace
+{
+// ====================================================================================================================
+// Nombre en virgule fixe de précision étendue : signe et valeur absolue sur nb_limbs mots de 64 bits, le premier mot
+// contenant la partie entière et les suivants la partie fractionnaire (256 bits).
+constexpr const int nb_limbs = 5;
+struct Fixed
+{
+    bool negative = false;
+    std::array<std::uint64_t, nb_limbs> limbs{};
+};
+using uint128 = unsigned __int128;
+// ....................................................................................................................
+// Compare les valeurs absolues de a et b (-1, 0 ou 1)
+int compare_magnitude(Fixed const& a, Fixed const& b)
+{
+    for (int k = 0; k < nb_limbs; ++k)
+        if (a.limbs[k] != b.limbs[k]) return a.limbs[k] < b.limbs[k] ? -1 : 1;
+    return 0;
+}
+// ....................................................................................................................
+Fixed add(Fixed const& a, Fixed const& b)
+{
+    Fixed r;
+    if (a.negative == b.negative)
+    {
+        std::uint64_t carry = 0;
+        for (int k = nb_limbs-1; k >= 0; --k)
+        {
+            uint128 s = uint128(a.limbs[k]) + b.limbs[k] + carry;
+            r.limbs[k] = std::uint64_t(s);
+            carry = std::uint64_t(s >> 64);
+        }
+        r.negative = a.negative;
+        return r;
+    }
+    // Signes opposés : on soustrait la plus petite valeur absolue de la plus grande
+    bool a_larger = compare_magnitude(a, b) >= 0;
+    Fixed const& big   = a_larger ? a : b;
+    Fixed const& small = a_larger ? b : a;
+    std::uint64_t borrow = 0;
+    for (int k = nb_limbs-1; k >= 0; --k)
+    {
+        uint128 d = uint128(big.limbs[k]) - small.limbs[k] - borrow;
+        r.limbs[k] = std::uint64_t(d);
+        borrow = (d >> 64) ? 1 : 0;
+    }
+    r.negative = big.negative;
+    return r;
+}
+// ....................................................................................................................
+Fixed negate(Fixed a) { a.negative = !a.negative; return a; }
+Fixed sub(Fixed const& a, Fixed const& b) { return add(a, negate(b)); }
+// ....................................................................................................................
+Fixed mul(Fixed const& a, Fixed const& b)
+{
+    // Produit des mantisses (mots de poids faible en tête) puis troncature des (nb_limbs-1) mots de poids le plus faible
+    std::array<std::uint64_t, 2*nb_limbs> p{};
+    for (int i = 0; i < nb_limbs; ++i)
+    {
+        std::uint64_t carry = 0;
+        std::uint64_t ai = a.limbs[nb_limbs-1-i];
+        for (int j = 0; j < nb_limbs; ++j)
+        {
+            uint128 t = uint128(ai) * b.limbs[nb_limbs-1-j] + p[i+j] + carry;
+            p[i+j] = std::uint64_t(t);
+            carry  = std::uint64_t(t >> 64);
+        }
+        p[i+nb_limbs] = carry;
+    }
+    Fixed r;
+    for (int k = 0; k < nb_limbs; ++k) r.limbs[nb_limbs-1-k] = p[k + nb_limbs-1];
+    r.negative = (a.negative != b.negative);
+    return r;
+}
+// ....................................................................................................................
+double to_double(Fixed const& a)
+{
+    double v = 0.;
+    for (int k = nb_limbs-1; k >= 0; --k) v = v/18446744073709551616. + double(a.limbs[k]);
+    return a.negative ? -v : v;
+}
+// ....................................................................................................................
+// Conversion exacte d'un double (dont la partie fractionnaire a au plus 53 bits significatifs)
+Fixed from_double(double x)
+{
+    Fixed r;
+    r.negative = (x < 0);
+    x = std::abs(x);
+    for (int k = 0; k < nb_limbs; ++k)
+    {
+        double f = std::floor(x);
+        r.limbs[k] = std::uint64_t(f);
+        x = (x - f) * 18446744073709551616.;
+    }
+    return r;
+}
+// ....................................................................................................................
+// Conversion d'un nombre décimal écrit sous la forme [-]entier[.fraction]
+Fixed from_string(std::string const& s)
+{
+    Fixed r;
+    std::size_t pos = 0;
+    if (pos < s.size() && (s[pos] == '-' || s[pos] == '+')) r.negative = (s[pos++] == '-');
+    std::size_t point = s.find('.', pos);
+    std::string integer  = s.substr(pos, point == std::string::npos ? std::string::npos : point - pos);
+    std::string fraction = (point == std::string::npos) ? std::string() : s.substr(point + 1);
+    if ((integer + fraction).empty() ||
+        (integer + fraction).find_first_not_of("0123456789") != std::string::npos)
+        throw std::runtime_error("Nombre décimal invalide : " + s);
+    // Partie fractionnaire par le schéma de Horner à rebours : f = (d_k + f)/10 en partant du dernier chiffre
+    for (auto it = fraction.rbegin(); it != fraction.rend(); ++it)
+    {
+        r.limbs[0] = std::uint64_t(*it - '0');
+        uint128 remainder = 0;
+        for (int k = 0; k < nb_limbs; ++k)
+        {
+            uint128 current = (remainder << 64) | r.limbs[k];
+            r.limbs[k] = std::uint64_t(current / 10);
+            remainder  = current % 10;
+        }
+    }
+    r.limbs[0] = integer.empty() ? 0 : std::stoull(integer);
+    return r;
+}
+// ====================================================================================================================
+constexpr const int glitched = -1; // Nombre d'itérations écrit par les noyaux pour un pixel glitché
+// ....................................................................................................................
+// Itérations d'un pixel par perturbation (glitched si le critère de Pauldelbrot est vérifié, jamais si tolerance2 est
+// nul). Les opérations sont effectuées dans le même ordre dans les noyaux vectoriels.
+inline int perturbation_pixel(double dcx, double dcy, ReferenceOrbit const& orbit, int max_iter, double tolerance2,
+                              long long& rebases)
+{
+    const int last = orbit.length() - 1;
+    double dzr = 0., dzi = 0.;
+    double Zr = orbit.zr[0], Zi = orbit.zi[0];
+    int m = 0, n = 0;
+    for (int iter = 0; iter < max_iter; ++iter)
+    {
+        double tr = 2.*(Zr*dzr - Zi*dzi) + (dzr*dzr - dzi*dzi) + dcx;
+        double ti = 2.*(Zr*dzi + Zi*dzr) + (dzr*dzi + dzi*dzr) + dcy;
+        dzr = tr; dzi = ti;
+        ++m;
+        Zr = orbit.zr[m]; Zi = orbit.zi[m];
+        double zr = Zr + dzr, zi = Zi + dzi;
+        double norm2 = zr*zr + zi*zi;
+        if (norm2 > 2.) break;
+        if (norm2 < tolerance2*(Zr*Zr + Zi*Zi)) return glitched;
+        n += 1;
+        if (norm2 < dzr*dzr + dzi*dzi || m == last)
+        {
+            // Rebasement : l'écart devient le point lui-même et on repart de Z_0 = 0
+            dzr = zr; dzi = zi;
+            m = 0; Zr = 0.; Zi = 0.;
+            ++rebases;
+        }
+    }
+    return n;
+}
+// ....................................................................................................................
+long long perturbation_scalar(DeepView const& view, ReferenceOrbit const& orbit, int* iterations)
+{
+    long long rebases = 0;
+#   pragma omp parallel for schedule(dynamic) reduction(+:rebases)
+    for (int i = 0; i < view.height; ++i)
+    {
+        double dcy = pixel_offset(i, view.height, view.extent);
+        for (int j = 0; j < view.width; ++j)
+        {
+            double dcx = pixel_offset(j, view.width, view.extent);
+            iterations[i*view.width+j] = perturbation_pixel(dcx, dcy, orbit, view.max_iter, glitch_tolerance2, rebases);
+        }
+    }
+    return rebases;
+}
+// ....................................................................................................................
+__attribute__((target("avx2")))
+long long perturbation_avx2(DeepView const& view, ReferenceOrbit const& orbit, int* iterations)
+{
+    const int width = view.width, height = view.height, max_iter = view.max_iter;
+    // Groupes de 4 voies entrelacés comme dans le noyau AVX-512
+    constexpr const int nb_groups = 2;
+    const __m256d two    = _mm256_set1_pd(2.);
+    const __m256d half   = _mm256_set1_pd(0.5);
+    const __m256d tol2   = _mm256_set1_pd(glitch_tolerance2);
+    const __m256d vext   = _mm256_set1_pd(view.extent);
+    const __m256d vwidth = _mm256_set1_pd(double(width));
+    const __m256i last   = _mm256_set1_epi64x(orbit.length() - 1);
+    const __m256i lanes  = _mm256_setr_epi64x(0, 1, 2, 3);
+    // Les compteurs sont des entiers de 64 bits (un par voie) : on garde les mots de poids faible pour l'écriture
+    const __m256i low_words = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+    double const* ref_r = orbit.zr.data();
+    double const* ref_i = orbit.zi.data();
+    long long rebases = 0;
+#   pragma omp parallel for schedule(dynamic) reduction(+:rebases)
+    for (int i = 0; i < height; ++i)
+    {
+        const __m256d dcy = _mm256_set1_pd(pixel_offset(i, height, view.extent));
+        for (int j0 = 0; j0 < width; j0 += 4*nb_groups)
+        {
+            __m256i valid[nb_groups];
+            __m256d active[nb_groups], glitch_lanes[nb_groups];
+            __m256d dcx[nb_groups], dzr[nb_groups], dzi[nb_groups], Zr[nb_groups], Zi[nb_groups];
+            __m256i m[nb_groups], n[nb_groups];
+            int m_common[nb_groups]; // Indice commun à toutes les voies actives (-1 dès qu'elles divergent dans l'orbite)
+            int any_active = 0;
+            for (int g = 0; g < nb_groups; ++g)
+            {
+                const int j = j0 + 4*g;
+                valid[g] = _mm256_cmpgt_epi64(_mm256_set1_epi64x(width - j), lanes);
+                __m256d x = _mm256_div_pd(_mm256_cvtepi32_pd(_mm_add_epi32(_mm_set1_epi32(j), _mm_setr_epi32(0, 1, 2, 3))), vwidth);
+                dcx[g] = _mm256_mul_pd(_mm256_sub_pd(x, half), vext);
+                dzr[g] = _mm256_setzero_pd(); dzi[g] = _mm256_setzero_pd();
+                Zr[g] = _mm256_set1_pd(ref_r[0]); Zi[g] = _mm256_set1_pd(ref_i[0]);
+                m[g] = _mm256_setzero_si256(); n[g] = _mm256_setzero_si256();
+                m_common[g] = 0;
+                active[g] = _mm256_castsi256_pd(valid[g]); glitch_lanes[g] = _mm256_setzero_pd();
+                any_active |= _mm256_movemask_pd(active[g]);
+            }
+            for (int iter = 0; iter < max_iter && any_active != 0; ++iter)
+            {
+                any_active = 0;
+                for (int g = 0; g < nb_groups; ++g)
+                {
+                    if (_mm256_testz_pd(active[g], active[g])) continue;
+                    __m256d tr = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(two, _mm256_sub_pd(_mm256_mul_pd(Zr[g], dzr[g]), _mm256_mul_pd(Zi[g], dzi[g]))),
+                                                             _mm256_sub_pd(_mm256_mul_pd(dzr[g], dzr[g]), _mm256_mul_pd(dzi[g], dzi[g]))), dcx[g]);
+                    __m256d ti = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(two, _mm256_add_pd(_mm256_mul_pd(Zr[g], dzi[g]), _mm256_mul_pd(Zi[g], dzr[g]))),
+                                                             _mm256_add_pd(_mm256_mul_pd(dzr[g], dzi[g]), _mm256_mul_pd(dzi[g], dzr[g]))), dcy);
+                    dzr[g] = tr; dzi[g] = ti;
+                    // Seules les voies actives avancent dans l'orbite (les autres indices restent valides pour les lectures)
+                    m[g] = _mm256_sub_epi64(m[g], _mm256_castpd_si256(active[g]));
+                    if (m_common[g] >= 0)
+                    {
+                        ++m_common[g];
+                        Zr[g] = _mm256_set1_pd(ref_r[m_common[g]]);
+                        Zi[g] = _mm256_set1_pd(ref_i[m_common[g]]);
+                    }
+                    else
+                    {
+                        Zr[g] = _mm256_mask_i64gather_pd(Zr[g], ref_r, m[g], active[g], 8);
+                        Zi[g] = _mm256_mask_i64gather_pd(Zi[g], ref_i, m[g], active[g], 8);
+                    }
+                    __m256d zr = _mm256_add_pd(Zr[g], dzr[g]), zi = _mm256_add_pd(Zi[g], dzi[g]);
+                    __m256d norm2 = _mm256_add_pd(_mm256_mul_pd(zr, zr), _mm256_mul_pd(zi, zi));
+                    active[g] = _mm256_andnot_pd(_mm256_cmp_pd(norm2, two, _CMP_GT_OQ), active[g]);
+                    __m256d glitch = _mm256_and_pd(_mm256_cmp_pd(norm2, _mm256_mul_pd(tol2, _mm256_add_pd(_mm256_mul_pd(Zr[g], Zr[g]), _mm256_mul_pd(Zi[g], Zi[g]))),
+                                                                 _CMP_LT_OQ), active[g]);
+                    glitch_lanes[g] = _mm256_or_pd(glitch_lanes[g], glitch);
+                    active[g] = _mm256_andnot_pd(glitch, active[g]);
+                    n[g] = _mm256_sub_epi64(n[g], _mm256_castpd_si256(active[g]));
+                    __m256d rebase = _mm256_cmp_pd(norm2, _mm256_add_pd(_mm256_mul_pd(dzr[g], dzr[g]), _mm256_mul_pd(dzi[g], dzi[g])), _CMP_LT_OQ);
+                    rebase = _mm256_and_pd(_mm256_or_pd(rebase, _mm256_castsi256_pd(_mm256_cmpeq_epi64(m[g], last))), active[g]);
+                    dzr[g] = _mm256_blendv_pd(dzr[g], zr, rebase);
+                    dzi[g] = _mm256_blendv_pd(dzi[g], zi, rebase);
+                    Zr[g] = _mm256_andnot_pd(rebase, Zr[g]);
+                    Zi[g] = _mm256_andnot_pd(rebase, Zi[g]);
+                    m[g]  = _mm256_andnot_si256(_mm256_castpd_si256(rebase), m[g]);
+                    int rebase_bits = _mm256_movemask_pd(rebase);
+                    int active_bits = _mm256_movemask_pd(active[g]);
+                    if (rebase_bits != 0)
+                        m_common[g] = (rebase_bits == active_bits) ? 0 : -1;
+                    rebases += __builtin_popcount(rebase_bits);
+                    any_active |= active_bits;
+                }
+            }
+            for (int g = 0; g < nb_groups; ++g)
+            {
+                const int j = j0 + 4*g;
+                if (j >= width) break;
+                n[g] = _mm256_or_si256(n[g], _mm256_castpd_si256(glitch_lanes[g])); // -1 (glitched) pour les voies glitchées
+                __m128i n32 = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(n[g], low_words));
+                if (j + 4 <= width)
+                    _mm_storeu_si128((__m128i*)(iterations + i*width + j), n32);
+                else
+                    _mm_maskstore_epi32(iterations + i*width + j, _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(valid[g], low_words)), n32);
+            }
+        }
+    }
+    return rebases;
+}
+// ....................................................................................................................
+// Vrai si au moins un des groupes a une voie active
+template<int nb_groups> inline bool any_active(__mmask8 const (&active)[nb_groups])
+{
+    __mmask8 any = 0;
+    for (int g = 0; g < nb_groups; ++g) any |= active[g];
+    return any != 0;
+}
+// ....................................................................................................................
+__attribute__((target("avx512f")))
+long long perturbation_avx512(DeepView const& view, ReferenceOrbit const& orbit, int* iterations)
+{
+    const int width = view.width, height = view.height, max_iter = view.max_iter;
+    // Deux groupes de 8 voies indépendants sont entrelacés : les récurrences et les lectures dans l'orbite de l'un
+    // recouvrent la latence de celles de l'autre (le noyau à un seul groupe est deux fois plus lent en double)
+    constexpr const int nb_groups = 2;
+    const __m512d two    = _mm512_set1_pd(2.);
+    const __m512d half   = _mm512_set1_pd(0.5);
+    const __m512d tol2   = _mm512_set1_pd(glitch_tolerance2);
+    const __m512d vext   = _mm512_set1_pd(view.extent);
+    const __m512d vwidth = _mm512_set1_pd(double(width));
+    const __m512i one    = _mm512_set1_epi64(1);
+    const __m512i last   = _mm512_set1_epi64(orbit.length() - 1);
+    const __m256i lanes  = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    double const* ref_r = orbit.zr.data();
+    double const* ref_i = orbit.zi.data();
+    long long rebases = 0;
+#   pragma omp parallel for schedule(dynamic) reduction(+:rebases)
+    for (int i = 0; i < height; ++i)
+    {
+        const __m512d dcy = _mm512_set1_pd(pixel_offset(i, height, view.extent));
+        for (int j0 = 0; j0 < width; j0 += 8*nb_groups)
+        {
+            __mmask8 valid[nb_groups], active[nb_groups], glitch_lanes[nb_groups];
+            __m512d dcx[nb_groups], dzr[nb_groups], dzi[nb_groups], Zr[nb_groups], Zi[nb_groups];
+            __m512i m[nb_groups], n[nb_groups];
+            int m_common[nb_groups];
+            for (int g = 0; g < nb_groups; ++g)
+            {
+                const int j = j0 + 8*g;
+                valid[g] = (j + 8 <= width ? __mmask8(0xFF) : j >= width ? __mmask8(0) : __mmask8((1u << (width - j)) - 1u));
+                __m512d x = _mm512_div_pd(_mm512_cvtepi32_pd(_mm256_add_epi32(_mm256_set1_epi32(j), lanes)), vwidth);
+                dcx[g] = _mm512_mul_pd(_mm512_sub_pd(x, half), vext);
+                dzr[g] = _mm512_setzero_pd(); dzi[g] = _mm512_setzero_pd();
+                Zr[g] = _mm512_set1_pd(ref_r[0]); Zi[g] = _mm512_set1_pd(ref_i[0]);
+                m[g] = _mm512_setzero_si512(); n[g] = _mm512_setzero_si512();
+                m_common[g] = 0;
+                active[g] = valid[g]; glitch_lanes[g] = 0;
+            }
+            for (int iter = 0; iter < max_iter && any_active(active); ++iter)
+            {
+                for (int g = 0; g < nb_groups; ++g)
+                {
+                    if (active[g] == 0) continue;
+                    __m512d tr = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(two, _mm512_sub_pd(_mm512_mul_pd(Zr[g], dzr[g]), _mm512_mul_pd(Zi[g], dzi[g]))),
+                                                             _mm512_sub_pd(_mm512_mul_pd(dzr[g], dzr[g]), _mm512_mul_pd(dzi[g], dzi[g]))), dcx[g]);
+                    __m512d ti = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(two, _mm512_add_pd(_mm512_mul_pd(Zr[g], dzi[g]), _mm512_mul_pd(Zi[g], dzr[g]))),
+                                                             _mm512_add_pd(_mm512_mul_pd(dzr[g], dzi[g]), _mm512_mul_pd(dzi[g], dzr[g]))), dcy);
+                    dzr[g] = tr; dzi[g] = ti;
+                    m[g] = _mm512_mask_add_epi64(m[g], active[g], m[g], one);
+                    if (m_common[g] >= 0)
+                    {
+                        ++m_common[g];
+                        Zr[g] = _mm512_set1_pd(ref_r[m_common[g]]);
+                        Zi[g] = _mm512_set1_pd(ref_i[m_common[g]]);
+                    }
+                    else
+                    {
+                        Zr[g] = _mm512_mask_i64gather_pd(Zr[g], active[g], m[g], ref_r, 8);
+                        Zi[g] = _mm512_mask_i64gather_pd(Zi[g], active[g], m[g], ref_i, 8);
+                    }
+                    __m512d zr = _mm512_add_pd(Zr[g], dzr[g]), zi = _mm512_add_pd(Zi[g], dzi[g]);
+                    __m512d norm2 = _mm512_add_pd(_mm512_mul_pd(zr, zr), _mm512_mul_pd(zi, zi));
+                    active[g] = _mm512_mask_cmp_pd_mask(active[g], norm2, two, _CMP_LE_OQ);
+                    __mmask8 glitch = _mm512_mask_cmp_pd_mask(active[g], norm2, _mm512_mul_pd(tol2, _mm512_add_pd(_mm512_mul_pd(Zr[g], Zr[g]), _mm512_mul_pd(Zi[g], Zi[g]))),
+                                                              _CMP_LT_OQ);
+                    glitch_lanes[g] |= glitch;
+                    active[g] &= __mmask8(~glitch);
+                    n[g] = _mm512_mask_add_epi64(n[g], active[g], n[g], one);
+                    __mmask8 rebase = _mm512_mask_cmp_pd_mask(active[g], norm2, _mm512_add_pd(_mm512_mul_pd(dzr[g], dzr[g]), _mm512_mul_pd(dzi[g], dzi[g])), _CMP_LT_OQ) |
+                                      _mm512_mask_cmpeq_epi64_mask(active[g], m[g], last);
+                    dzr[g] = _mm512_mask_mov_pd(dzr[g], rebase, zr);
+                    dzi[g] = _mm512_mask_mov_pd(dzi[g], rebase, zi);
+                    Zr[g] = _mm512_maskz_mov_pd(__mmask8(~rebase), Zr[g]);
+                    Zi[g] = _mm512_maskz_mov_pd(__mmask8(~rebase), Zi[g]);
+                    m[g]  = _mm512_maskz_mov_epi64(__mmask8(~rebase), m[g]);
+                    if (rebase != 0)
+                        m_common[g] = (rebase == active[g]) ? 0 : -1;
+                    rebases += __builtin_popcount(rebase);
+                }
+            }
+            for (int g = 0; g < nb_groups; ++g)
+            {
+                n[g] = _mm512_mask_mov_epi64(n[g], glitch_lanes[g], _mm512_set1_epi64(glitched));
+                _mm512_mask_cvtepi64_storeu_epi32(iterations + i*width + j0 + 8*g, valid[g], n[g]);
+            }
+        }
+    }
+    return rebases;
+}
+// ....................................................................................................................
+// Recalcule les pixels donnés avec l'orbite de référence (de point C décalé de offset par rapport au centre)
+long long perturbation_pixels(DeepView const& view, ReferenceOrbit const& orbit, std::vector<int> const& pixels,
+                              double tolerance2, int* iterations)
+{
+    long long rebases = 0;
+#   pragma omp parallel for schedule(dynamic) reduction(+:rebases)
+    for (std::size_t k = 0; k < pixels.size(); ++k)
+    {
+        const int p = pixels[k];
+        double dcx = pixel_offset(p % view.width, view.width,  view.extent) - orbit.offset_x;
+        double dcy = pixel_offset(p / view.width, view.height, view.extent) - orbit.offset_y;
+        iterations[p] = perturbation_pixel(dcx, dcy, orbit, view.max_iter, tolerance2, rebases);
+    }
+    return rebases;
+}
+}// End anonymous namespace
+// ====================================================================================================================
+ReferenceOrbit compute_reference_orbit(DeepView const& view, double offset_x, double offset_y)
+{
+    ReferenceOrbit orbit;
+    orbit.offset_x = offset_x;
+    orbit.offset_y = offset_y;
+    // Facteur d'échelle : puissance de deux proche de la racine carrée de l'étendue (au plus 1, au moins 2^-120)
+    orbit.scale_exponent = std::clamp(int(std::floor(std::log2(view.extent)/2.)), -120, 0);
+    orbit.scale          = std::ldexp(1.f, orbit.scale_exponent);
+    orbit.inv_scale      = std::ldexp(1.f, -orbit.scale_exponent);
+    orbit.extent_scaled  = float(std::ldexp(view.extent, -orbit.scale_exponent));
+
+    const Fixed cr = add(from_string(view.center_x), from_double(offset_x));
+    const Fixed ci = add(from_string(view.center_y), from_double(offset_y));
+    Fixed zr, zi;
+    orbit.zr.reserve(view.max_iter + 1);
+    orbit.zi.reserve(view.max_iter + 1);
+    orbit.zr.push_back(0.);
+    orbit.zi.push_back(0.);
+    for (int m = 0; m < view.max_iter; ++m)
+    {
+        Fixed zr2 = mul(zr, zr), zi2 = mul(zi, zi), zri = mul(zr, zi);
+        zr = add(sub(zr2, zi2), cr);
+        zi = add(add(zri, zri), ci);
+        double dr = to_double(zr), di = to_double(zi);
+        orbit.zr.push_back(dr);
+        orbit.zi.push_back(di);
+        if (dr*dr + di*di > 4.) break;
+    }
+    return orbit;
+}
+// --------------------------------------------------------------------------------------------------------------------
+PerturbationStats compute_iterations_perturbation(Isa isa, DeepView const& view, ReferenceOrbit const& orbit, int* iterations)
+{
+    PerturbationStats stats;
+    switch(isa)
+    {
+    case Isa::avx512:
+        stats.rebases = perturbation_avx512(view, orbit, iterations);
+        break;
+    case Isa::avx2:
+        stats.rebases = perturbation_avx2(view, orbit, iterations);
+        break;
+    default:
+        stats.rebases = perturbation_scalar(view, orbit, iterations);
+    }
+
+    // Seuls les pixels glitchés sont recalculés, avec une orbite secondaire centrée sur l'un d'eux : ce pixel, d'écart
+    // nul à la nouvelle référence, ne peut plus être glitché, si bien que chaque orbite en corrige au moins un
+    std::vector<int> pending;
+    for (int p = 0; p < view.width*view.height; ++p)
+        if (iterations[p] == glitched) pending.push_back(p);
+    stats.nb_glitched = int(pending.size());
+    while (not pending.empty() && stats.nb_secondary < max_secondary_orbits)
+    {
+        const int p = pending[pending.size()/2];
+        ReferenceOrbit secondary = compute_reference_orbit(view, pixel_offset(p % view.width, view.width,  view.extent),
+                                                                 pixel_offset(p / view.width, view.height, view.extent));
+        ++stats.nb_secondary;
+        stats.rebases += perturbation_pixels(view, secondary, pending, glitch_tolerance2, iterations);
+        pending.erase(std::remove_if(pending.begin(), pending.end(), [iterations](int q) { return iterations[q] != glitched; }),
+                      pending.end());
+    }
+    stats.nb_unresolved = int(pending.size());
+    stats.rebases += perturbation_pixels(view, orbit, pending, 0., iterations);
+    return stats;
+}
+// --------------------------------------------------------------------------------------------------------------------
+int iterations_extended_precision(DeepView const& view, int i, int j)
+{
+    const Fixed cr = add(from_string(view.center_x), from_double((double(j)/view.width  - 0.5) * view.extent));
+    const Fixed ci = add(from_string(view.center_y), from_double((double(i)/view.height - 0.5) * view.extent));
+    Fixed zr, zi;
+    int n = 0;
+    for (int iter = 0; iter < view.max_iter; ++iter)
+    {
+        Fixed zr2 = mul(zr, zr), zi2 = mul(zi, zi), zri = mul(zr, zi);
+        zr = add(sub(zr2, zi2), cr);
+        zi = add(add(zri, zri), ci);
+        double dr = to_double(zr), di = to_double(zi);
+        if (dr*dr + di*di > 2.) break;
+        n += 1;
+    }
+    return n;
+}
+}
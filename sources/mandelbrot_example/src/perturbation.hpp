@@ -0,0 +1,104 @@
+#ifndef _MANDELBROT_PERTURBATION_HPP_
+#define _MANDELBROT_PERTURBATION_HPP_
+#include <string>
+#include <vector>
+#include "cpu_kernels.hpp"
+
+namespace mandelbrot
+{
+/**
+ * @brief Paramètres d'un rendu en zoom profond
+ *
+ * Le centre est donné en décimal (chaîne de caractères) et converti en précision étendue (256 bits après la virgule) :
+ * des fenêtres d'étendue jusqu'à environ 1.E-65 peuvent ainsi être rendues.
+ */
+struct DeepView
+{
+    int         width    = 3200;
+    int         height   = 2400;
+    std::string center_x = "-0.743643887037158704752191506114774";
+    std::string center_y = "0.131825904205311970493132056385139";
+    double      extent   = 1.E-30;
+    int         max_iter = 20000;
+};
+
+// Critère de Pauldelbrot : le pixel est glitché dès que |z_n|^2 < glitch_tolerance2.|Z_m|^2 (|z_n| < 1.E-3 |Z_m|)
+constexpr const double glitch_tolerance2 = 1.E-6;
+constexpr const int max_secondary_orbits = 16; // Nombre maximal d'orbites secondaires pour recalculer les pixels glitchés
+
+/**
+ * @brief Écart au centre de la fenêtre de la coordonnée du pixel k sur un côté de size pixels (même calcul que
+ *        iterations_extended_precision et les shaders de perturbation)
+ */
+inline double pixel_offset(int k, int size, double extent)
+{
+    return (double(k)/double(size) - 0.5)*extent;
+}
+
+/**
+ * @brief Orbite de référence Z_0 = 0, Z_{m+1} = Z_m^2 + C d'un point C de la fenêtre
+ *
+ * L'orbite est calculée en précision étendue puis stockée en double précision. C est le centre de la fenêtre pour
+ * l'orbite principale, un pixel glitché pour une orbite secondaire (voir compute_iterations_perturbation).
+ *
+ * Le shader perturbation.comp (simple précision) itère les écarts sous la forme w = dz/S où S = 2^scale_exponent est une
+ * puissance de deux de l'ordre de la racine carrée de l'étendue : w reste ainsi dans la plage des flottants simple
+ * précision, des écarts de la taille d'un pixel jusqu'aux écarts de l'ordre de 1 (divergence).
+ */
+struct ReferenceOrbit
+{
+    std::vector<double> zr, zi; // Z_m pour m = 0, ..., length-1 (l'orbite s'arrête à max_iter ou dès que |Z_m|^2 > 4)
+    double offset_x = 0.;       // Position de C par rapport au centre de la fenêtre
+    double offset_y = 0.;
+    int   scale_exponent = 0;   // S = 2^scale_exponent (perturbation.comp)
+    float scale          = 1.f; // S
+    float inv_scale      = 1.f; // 1/S
+    float extent_scaled  = 1.f; // Étendue de la fenêtre divisée par S
+    int length() const { return int(zr.size()); }
+};
+
+/**
+ * @brief Bilan d'un calcul par perturbation
+ */
+struct PerturbationStats
+{
+    long long rebases       = 0; // Rebasements (|z_n| < |dz_n| ou orbite de référence épuisée)
+    int       nb_glitched   = 0; // Pixels glitchés (critère de Pauldelbrot) avec l'orbite du centre
+    int       nb_secondary  = 0; // Orbites de référence secondaires calculées pour les recalculer
+    int       nb_unresolved = 0; // Pixels encore glitchés après la dernière orbite secondaire
+};
+
+/**
+ * @brief Calcule en précision étendue l'orbite de référence du point décalé de (offset_x, offset_y) par rapport au
+ *        centre de la fenêtre
+ */
+ReferenceOrbit compute_reference_orbit(DeepView const& view, double offset_x = 0., double offset_y = 0.);
+
+/**
+ * @brief Calcule les nombres d'itérations de chaque pixel par la méthode des perturbations
+ *
+ * Pour chaque pixel c = C + dc, on itère en double précision l'écart dz_n = z_n - Z_m à l'orbite de référence du
+ * centre :
+ *
+ *     dz_{n+1} = 2.Z_m.dz_n + dz_n^2 + dc
+ *
+ * Lorsque |z_n| < |dz_n| ou lorsque l'orbite de référence est épuisée, on rebase : dz_n = z_n et on repart du début de
+ * l'orbite (m = 0). Lorsque |z_n| < 1.E-3 |Z_m| (critère de Pauldelbrot), z_n = Z_m + dz_n a perdu sa précision relative
+ * par compensation : le pixel est glitché et abandonné. Les pixels glitchés, et eux seuls, sont ensuite recalculés
+ * avec une orbite de référence secondaire centrée sur l'un d'eux (pour lequel le critère ne peut être vérifié), et ainsi
+ * de suite jusqu'à 16 orbites secondaires ; les pixels restants sont calculés avec l'orbite du centre, sans détection.
+ * Le nombre d'itérations est compté comme dans compute_iterations.
+ *
+ * Les écarts en simple précision (comme dans perturbation.comp) ne suffisent pas : l'erreur d'arrondi, amplifiée au fil
+ * des milliers d'itérations des pixels proches du bord, change le nombre d'itérations d'un pixel sur cinq à l'étendue
+ * 1.E-20 sans que le critère de Pauldelbrot ne la détecte.
+ */
+PerturbationStats compute_iterations_perturbation(Isa isa, DeepView const& view, ReferenceOrbit const& orbit, int* iterations);
+
+/**
+ * @brief Calcule le nombre d'itérations du pixel (i, j) directement en précision étendue (lent, pour vérification)
+ */
+int iterations_extended_precision(DeepView const& view, int i, int j);
+}
+
+#endif
@@ -0,0 +1,350 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <omp.h>
+#include "png_stream.hpp"
+
+using namespace std::string_literals;
+
+namespace mandelbrot
+{
+namespace
+{
+constexpr const unsigned char png_signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+constexpr const int bytes_per_pixel = 4; // RGBA 8 bits
+// ....................................................................................................................
+inline void store_be32(unsigned char* p, std::uint32_t value)
+{
+    p[0] = (unsigned char)(value >> 24);
+    p[1] = (unsigned char)(value >> 16);
+    p[2] = (unsigned char)(value >> 8);
+    p[3] = (unsigned char)(value);
+}
+// ....................................................................................................................
+inline unsigned char paeth_predictor(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return (unsigned char)a;
+    return (unsigned char)(pb <= pc ? b : c);
+}
+// ....................................................................................................................
+// Filtre une ligne de size octets par les cinq filtres du png : aucun, Sub, Up, Average et Paeth (a = octet du pixel de
+// gauche, b = au-dessus, c = en haut à gauche, bytewidth octets par pixel ; prev nul pour la première ligne). filtered[f]
+// reçoit la ligne filtrée par le filtre f (sans l'octet de type). Renvoie le filtre dont la somme des octets filtrés est
+// la plus petite, calculée comme dans lodepng : octets non signés sans filtre, distance à zéro des octets vus comme des
+// entiers signés avec les autres filtres.
+int minsum_filter(unsigned char const* row, unsigned char const* prev, std::size_t size, std::size_t bytewidth,
+                  unsigned char* const filtered[5])
+{
+    unsigned long sums[5] = {0, 0, 0, 0, 0};
+    for (std::size_t k = 0; k < size; ++k)
+    {
+        int x = row[k];
+        int a = k >= bytewidth ? row[k - bytewidth] : 0;
+        int b = prev ? prev[k] : 0;
+        int c = (prev && k >= bytewidth) ? prev[k - bytewidth] : 0;
+        unsigned char values[5] = {(unsigned char)x, (unsigned char)(x - a), (unsigned char)(x - b),
+                                   (unsigned char)(x - ((a + b) >> 1)), (unsigned char)(x - paeth_predictor(a, b, c))};
+        filtered[0][k] = values[0];
+        sums[0] += (unsigned long)x;
+        for (int f = 1; f < 5; ++f)
+        {
+            filtered[f][k] = values[f];
+            sums[f] += values[f] < 128 ? values[f] : 255u - values[f];
+        }
+    }
+    int best = 0;
+    for (int f = 1; f < 5; ++f)
+        if (sums[f] < sums[best]) best = f;
+    return best;
+}
+// ....................................................................................................................
+// Disposition des lignes que lodepng passe à parallel_zlib (custom_context) : chaque ligne est un octet de type nul suivi
+// des octets non filtrés de la ligne (filtre LFS_ZERO, sans entrelacement)
+struct ScanlineLayout
+{
+    std::size_t line_bytes; // Octets d'une ligne, sans l'octet de type
+    std::size_t byte_width; // Octets par pixel (1 pour moins de 8 bits par pixel)
+    bool        filter;     // Filtrage adaptatif, sauf pour les images à palette ou de moins de 8 bits (comme lodepng)
+    int         level;      // Niveau de compression de zlib
+};
+constexpr const std::size_t strip_size      = 1 << 18; // Taille visée (en octets) des bandes compressées en parallèle
+constexpr const std::size_t dictionary_size = 1 << 15; // Fenêtre de deflate (32 Kio) : la fin de la bande précédente
+// ....................................................................................................................
+// Compression zlib des lignes d'une image, appelée par lodepng à la place de son compresseur (custom_zlib). Les lignes
+// sont découpées en bandes d'environ strip_size octets, filtrées et compressées en flux deflate brut par les threads
+// OpenMP. Chaque bande a pour dictionnaire les 32 derniers Kio (filtrés) de la précédente, comme dans pigz, et se termine
+// par Z_SYNC_FLUSH (bloc vide aligné sur un octet) sauf la dernière (Z_FINISH) : les bandes se suivent donc dans un
+// seul flux deflate. L'Adler-32 du flux zlib est combiné à partir de celui de chaque bande (adler32_combine).
+unsigned parallel_zlib(unsigned char** out, std::size_t* outsize, unsigned char const* in, std::size_t insize,
+                       LodePNGCompressSettings const* settings)
+{
+    // lodepng n'appelle custom_zlib que pour les lignes de l'image (on n'ajoute pas de texte compressé) : insize est un
+    // multiple de la taille d'une ligne
+    auto const& layout = *static_cast<ScanlineLayout const*>(settings->custom_context);
+    const std::size_t row_size      = 1 + layout.line_bytes;
+    const std::size_t nb_rows       = insize / row_size;
+    const std::size_t strip_rows    = std::max(std::size_t(1), strip_size / row_size);
+    const std::size_t nb_strips     = std::max(std::size_t(1), (nb_rows + strip_rows - 1) / strip_rows);
+    // Lignes précédant une bande à refiltrer pour en tirer le dictionnaire
+    const std::size_t context_rows  = (dictionary_size + row_size - 1) / row_size;
+    std::vector<std::vector<unsigned char>> strips(nb_strips);
+    std::vector<uLong> adlers(nb_strips);
+    std::vector<std::size_t> lengths(nb_strips);
+    bool failed = false;
+
+#   pragma omp parallel
+    {
+        z_stream stream{};
+        bool ready = (deflateInit2(&stream, layout.level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+        std::vector<unsigned char> filtered_strip;
+        std::vector<unsigned char> attempts(5 * layout.line_bytes);
+        unsigned char* filtered[5];
+        for (int f = 0; f < 5; ++f) filtered[f] = attempts.data() + f * layout.line_bytes;
+#       pragma omp for schedule(dynamic)
+        for (std::size_t s = 0; s < nb_strips; ++s)
+        {
+            if (not ready) continue;
+            const bool last = (s + 1 == nb_strips);
+            const std::size_t row_begin = s * strip_rows;
+            const std::size_t row_end   = last ? nb_rows : row_begin + strip_rows;
+            const std::size_t first_row = row_begin > context_rows ? row_begin - context_rows : 0;
+            // Lignes filtrées du contexte puis de la bande (le filtre d'une ligne ne dépend que des lignes non filtrées)
+            filtered_strip.resize((row_end - first_row) * row_size);
+            for (std::size_t r = first_row; r < row_end; ++r)
+            {
+                unsigned char* dest = filtered_strip.data() + (r - first_row) * row_size;
+                unsigned char const* row = in + r * row_size;
+                if (not layout.filter)
+                {
+                    std::memcpy(dest, row, row_size);
+                    continue;
+                }
+                int best = minsum_filter(row + 1, r > 0 ? row + 1 - row_size : nullptr, layout.line_bytes,
+                                         layout.byte_width, filtered);
+                dest[0] = (unsigned char)best;
+                std::memcpy(dest + 1, filtered[best], layout.line_bytes);
+            }
+            const std::size_t context_size = (row_begin - first_row) * row_size;
+            unsigned char* data = filtered_strip.data() + context_size;
+            const std::size_t length = (row_end - row_begin) * row_size;
+            adlers[s]  = adler32(adler32(0L, Z_NULL, 0), data, uInt(length));
+            lengths[s] = length;
+
+            deflateReset(&stream);
+            const std::size_t dictionary_length = std::min(context_size, dictionary_size);
+            if (dictionary_length > 0)
+                deflateSetDictionary(&stream, data - dictionary_length, uInt(dictionary_length));
+            auto& strip = strips[s];
+            strip.resize(deflateBound(&stream, uLong(length)) + 16);
+            stream.next_in   = data;
+            stream.avail_in  = uInt(length);
+            stream.next_out  = strip.data();
+            stream.avail_out = uInt(strip.size());
+            const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+            int status;
+            while (true)
+            {
+                status = deflate(&stream, flush);
+                if (status == Z_STREAM_ERROR) break;
+                // Z_SYNC_FLUSH est terminé quand il reste de la place en sortie, Z_FINISH quand le flux est fini
+                if (last ? status == Z_STREAM_END : stream.avail_out > 0) break;
+                std::size_t used = strip.size() - stream.avail_out;
+                strip.resize(2 * strip.size());
+                stream.next_out  = strip.data() + used;
+                stream.avail_out = uInt(strip.size() - used);
+            }
+            if (status == Z_STREAM_ERROR)
+            {
+#               pragma omp atomic write
+                failed = true;
+            }
+            strip.resize(strip.size() - stream.avail_out);
+        }
+        if (ready) deflateEnd(&stream);
+        else
+        {
+#           pragma omp atomic write
+            failed = true;
+        }
+    }
+    if (failed) return 83; // Seule une allocation peut faire échouer zlib ici
+
+    // En-tête zlib (deflate, fenêtre de 32 Kio, sans dictionnaire prédéfini), bandes bout à bout puis Adler-32 gros-boutiste
+    std::size_t total = 2 + 4;
+    for (auto const& strip : strips) total += strip.size();
+    // lodepng libère le résultat avec free (allocateurs par défaut)
+    auto* result = static_cast<unsigned char*>(std::malloc(total));
+    if (not result) return 83;
+    result[0] = 0x78;
+    result[1] = 0x9C;
+    std::size_t position = 2;
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for (std::size_t s = 0; s < nb_strips; ++s)
+    {
+        std::memcpy(result + position, strips[s].data(), strips[s].size());
+        position += strips[s].size();
+        adler = adler32_combine(adler, adlers[s], z_off_t(lengths[s]));
+    }
+    store_be32(result + position, std::uint32_t(adler));
+    *out     = result;
+    *outsize = total;
+    return 0;
+}
+}
+// ====================================================================================================================
+unsigned encode_png_parallel(std::string const& filename, unsigned char const* image, unsigned width, unsigned height,
+                             LodePNGColorType colortype, unsigned bitdepth, int level)
+{
+    lodepng::State state;
+    state.info_raw.colortype = colortype;
+    state.info_raw.bitdepth  = bitdepth;
+    // Même choix du format du png que lodepng::encode (auto_convert), fait ici pour connaître la disposition des lignes
+    unsigned error = lodepng_auto_choose_color(&state.info_png.color, image, width, height, &state.info_raw);
+    if (error) return error;
+    state.encoder.auto_convert        = 0;
+    // Les lignes sont filtrées par parallel_zlib : lodepng se contente de les recopier derrière un octet de type nul
+    state.encoder.filter_palette_zero = 0;
+    state.encoder.filter_strategy     = LFS_ZERO;
+    unsigned bpp = lodepng_get_bpp(&state.info_png.color);
+    ScanlineLayout layout{(std::size_t(width) * bpp + 7) / 8, (bpp + 7) / 8,
+                          state.info_png.color.colortype != LCT_PALETTE && state.info_png.color.bitdepth >= 8, level};
+    state.encoder.zlibsettings.custom_zlib    = parallel_zlib;
+    state.encoder.zlibsettings.custom_context = &layout;
+
+    std::vector<unsigned char> png;
+    error = lodepng::encode(png, image, width, height, state);
+    if (not error) error = lodepng::save_file(png, filename);
+    return error;
+}
+// ====================================================================================================================
+PngStreamWriter::PngStreamWriter(std::string const& filename, int width, int height, int level) :
+    width(width), height(height),
+    previous_row(std::size_t(width) * bytes_per_pixel, 0),
+    output(chunk_size)
+{
+    for (auto& row : this->filtered_rows) row.resize(1 + std::size_t(width) * bytes_per_pixel);
+    this->file = std::fopen(filename.c_str(), "wb");
+    if (not this->file)
+        throw std::runtime_error("Impossible de créer le fichier " + filename);
+    if (deflateInit(&this->stream, level) != Z_OK)
+    {
+        std::fclose(this->file);
+        throw std::runtime_error("Impossible d'initialiser le flux zlib de "s + filename);
+    }
+    this->stream.next_out  = this->output.data();
+    this->stream.avail_out = uInt(this->output.size());
+
+    std::fwrite(png_signature, 1, sizeof(png_signature), this->file);
+    // En-tête : largeur, hauteur, 8 bits par échantillon, RGBA (type 6), compression, filtrage et entrelacement standards
+    unsigned char header[13] = {};
+    store_be32(header, std::uint32_t(width));
+    store_be32(header + 4, std::uint32_t(height));
+    header[8] = 8;
+    header[9] = 6;
+    write_chunk("IHDR", header, sizeof(header));
+}
+// --------------------------------------------------------------------------------------------------------------------
+PngStreamWriter::~PngStreamWriter()
+{
+    deflateEnd(&this->stream);
+    if (this->file) std::fclose(this->file);
+}
+// --------------------------------------------------------------------------------------------------------------------
+std::size_t
+PngStreamWriter::memory_usage() const
+{
+    // État de zlib au niveau 6 : fenêtre et tables de hachage de 2^15 entrées (voir zconf.h), environ 256 Kio
+    std::size_t zlib_state = (std::size_t(1) << (MAX_WBITS + 2)) + (std::size_t(1) << (MAX_MEM_LEVEL + 9));
+    return this->previous_row.size() + 5*this->filtered_rows[0].size() + this->output.size() + zlib_state;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+PngStreamWriter::write_chunk(char const* type, unsigned char const* data, std::size_t size)
+{
+    unsigned char length[4], type_bytes[4], crc_bytes[4];
+    store_be32(length, std::uint32_t(size));
+    std::memcpy(type_bytes, type, 4);
+    // Le CRC porte sur le type et les données du bloc
+    uLong crc = crc32(0L, type_bytes, 4);
+    if (size > 0) crc = crc32(crc, data, uInt(size));
+    store_be32(crc_bytes, std::uint32_t(crc));
+    std::fwrite(length, 1, 4, this->file);
+    std::fwrite(type_bytes, 1, 4, this->file);
+    if (size > 0) std::fwrite(data, 1, size, this->file);
+    if (std::fwrite(crc_bytes, 1, 4, this->file) != 4)
+        throw std::runtime_error("Erreur d'écriture du png");
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+PngStreamWriter::flush_output(bool all)
+{
+    std::size_t size = this->output.size() - this->stream.avail_out;
+    if (size == 0 || (not all && this->stream.avail_out > 0)) return;
+    write_chunk("IDAT", this->output.data(), size);
+    this->nb_compressed += size;
+    this->stream.next_out  = this->output.data();
+    this->stream.avail_out = uInt(this->output.size());
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+PngStreamWriter::deflate_row(unsigned char const* filtered, std::size_t size)
+{
+    this->stream.next_in  = const_cast<unsigned char*>(filtered);
+    this->stream.avail_in = uInt(size);
+    while (this->stream.avail_in > 0)
+    {
+        if (deflate(&this->stream, Z_NO_FLUSH) != Z_OK)
+            throw std::runtime_error("Erreur de compression zlib");
+        // Bloc plein : on l'écrit et on recommence au début du tampon
+        flush_output(false);
+    }
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+PngStreamWriter::write_rows(unsigned char const* rgba, int nb_rows)
+{
+    if (this->finished || this->nb_written_rows + nb_rows > this->height)
+        throw std::runtime_error("Trop de lignes écrites dans le png");
+    const std::size_t row_size = std::size_t(this->width) * bytes_per_pixel;
+    unsigned char* filtered[5];
+    for (int f = 0; f < 5; ++f)
+    {
+        this->filtered_rows[f][0] = (unsigned char)f;
+        filtered[f] = this->filtered_rows[f].data() + 1;
+    }
+    for (int r = 0; r < nb_rows; ++r)
+    {
+        unsigned char const* row = rgba + std::size_t(r) * row_size;
+        // La ligne précédente est nulle avant la première ligne, ce qui revient à l'absence de ligne précédente
+        int best = minsum_filter(row, this->previous_row.data(), row_size, bytes_per_pixel, filtered);
+        deflate_row(this->filtered_rows[best].data(), this->filtered_rows[best].size());
+        std::memcpy(this->previous_row.data(), row, row_size);
+    }
+    this->nb_written_rows += nb_rows;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+PngStreamWriter::finish()
+{
+    if (this->finished) return;
+    if (this->nb_written_rows != this->height)
+        throw std::runtime_error("Le png n'a reçu que " + std::to_string(this->nb_written_rows) + " lignes sur "
+                                 + std::to_string(this->height));
+    int status;
+    do
+    {
+        status = deflate(&this->stream, Z_FINISH);
+        if (status != Z_OK && status != Z_STREAM_END)
+            throw std::runtime_error("Erreur de compression zlib");
+        flush_output(status == Z_STREAM_END);
+    } while (status != Z_STREAM_END);
+    write_chunk("IEND", nullptr, 0);
+    this->finished = true;
+    if (std::fclose(this->file) != 0)
+        throw std::runtime_error("Erreur d'écriture du png");
+    this->file = nullptr;
+}
+}
@@ -0,0 +1,88 @@
+#ifndef _MANDELBROT_PNG_STREAM_HPP_
+#define _MANDELBROT_PNG_STREAM_HPP_
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "lodepng.h"
+
+namespace mandelbrot
+{
+/**
+ * @brief Encode et sauvegarde un png avec lodepng en filtrant et compressant des bandes de lignes en parallèle (à la
+ *        façon de pigz)
+ *
+ * Même format du png que lodepng::encode (choix automatique du type de couleur) et même filtre adaptatif pour chaque
+ * ligne. Le compresseur de lodepng est remplacé (champ custom_zlib de LodePNGCompressSettings) par des flux deflate de
+ * bandes d'environ 256 Kio, calculés par les threads OpenMP et raccordés en un seul flux zlib : chaque bande est amorcée
+ * avec les 32 derniers Kio de la précédente et terminée par un vidage synchrone, et l'Adler-32 du flux est combiné à
+ * partir de ceux des bandes.
+ *
+ * @param level Niveau de compression de zlib (0 à 9)
+ * @return Le code d'erreur de lodepng (0 en cas de succès)
+ */
+unsigned encode_png_parallel(std::string const& filename, unsigned char const* image, unsigned width, unsigned height,
+                             LodePNGColorType colortype = LCT_RGBA, unsigned bitdepth = 8, int level = 6);
+
+/**
+ * @brief Écriture d'un png RGBA 8 bits ligne par ligne, sans jamais garder l'image entière en mémoire
+ *
+ * L'en-tête (IHDR) est écrit à la construction. Chaque ligne reçue est filtrée (filtre adaptatif : parmi les cinq filtres
+ * du png, celui dont la somme des valeurs absolues des octets filtrés est la plus petite, comme lodepng) puis passée au
+ * flux zlib, dont la sortie est écrite dans des blocs IDAT dès que chunk_size octets sont prêts. La mémoire utilisée
+ * (ligne précédente, lignes filtrées, état de zlib et bloc en cours) ne dépend que de la largeur de l'image.
+ */
+class PngStreamWriter
+{
+public:
+    static constexpr const std::size_t chunk_size = 1 << 20; // Taille des blocs IDAT écrits (sauf le dernier)
+
+    /**
+     * @brief Ouvre le fichier et écrit la signature et l'en-tête d'une image width x height
+     *
+     * @param level Niveau de compression de zlib (0 à 9)
+     */
+    PngStreamWriter(std::string const& filename, int width, int height, int level = 6);
+    ~PngStreamWriter();
+
+    PngStreamWriter(PngStreamWriter const&) = delete;
+    PngStreamWriter& operator=(PngStreamWriter const&) = delete;
+
+    /**
+     * @brief Ajoute nb_rows lignes (4.width octets chacune, RGBA) à la suite des précédentes
+     */
+    void write_rows(unsigned char const* rgba, int nb_rows);
+
+    /**
+     * @brief Termine le flux zlib et écrit le bloc IEND. Toutes les lignes de l'image doivent avoir été écrites.
+     */
+    void finish();
+
+    /**
+     * @brief Nombre d'octets de l'image compressée (données des blocs IDAT) écrits jusqu'ici
+     */
+    std::size_t compressed_size() const { return this->nb_compressed; }
+
+    /**
+     * @brief Mémoire occupée par l'écrivain (tampons et état de zlib), indépendante de la hauteur de l'image
+     */
+    std::size_t memory_usage() const;
+
+private:
+    void write_chunk(char const* type, unsigned char const* data, std::size_t size);
+    void deflate_row(unsigned char const* filtered, std::size_t size);
+    void flush_output(bool all);
+
+    std::FILE* file{nullptr};
+    int width, height;
+    int nb_written_rows{0};
+    z_stream stream{};
+    bool finished{false};
+    std::vector<unsigned char> previous_row;      // Ligne précédente (non filtrée), nulle avant la première
+    std::vector<unsigned char> filtered_rows[5];  // Ligne courante filtrée par chacun des cinq filtres (octet de type compris)
+    std::vector<unsigned char> output;            // Bloc IDAT en cours de remplissage par zlib
+    std::size_t nb_compressed{0};
+};
+}
+#endif
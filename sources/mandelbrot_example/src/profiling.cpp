@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include "profiling.hpp"
+#include "lodepng.h"
+
+namespace mandelbrot
+{
+namespace
+{
+constexpr const int nb_hottest_tiles = 8; // Nombre de tuiles les plus coûteuses listées dans le résumé
+// ....................................................................................................................
+// Échelle de chaleur : noir, rouge, jaune puis blanc pour t allant de 0 à 1
+inline void heat_color(double t, unsigned char* rgba)
+{
+    rgba[0] = (unsigned char)std::lround(255.*std::clamp(3.*t,      0., 1.));
+    rgba[1] = (unsigned char)std::lround(255.*std::clamp(3.*t - 1., 0., 1.));
+    rgba[2] = (unsigned char)std::lround(255.*std::clamp(3.*t - 2., 0., 1.));
+    rgba[3] = 255;
+}
+// ....................................................................................................................
+void write_tiles(std::ostream& out, IterationProfile const& profile)
+{
+    std::vector<long long> const& work = profile.tile_work;
+    const std::size_t nb_tiles = work.size();
+    double mean = nb_tiles > 0 ? double(profile.work)/double(nb_tiles) : 0.;
+    double variance = 0.;
+    for (long long w : work) variance += (double(w) - mean)*(double(w) - mean);
+    variance = nb_tiles > 0 ? variance/double(nb_tiles) : 0.;
+
+    // Tuiles triées par coût décroissant : part du dixième le plus coûteux et liste des plus coûteuses
+    std::vector<std::size_t> order(nb_tiles);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::sort(order.begin(), order.end(), [&work](std::size_t a, std::size_t b) { return work[a] > work[b]; });
+    long long top_work = 0;
+    for (std::size_t k = 0; k < (nb_tiles + 9)/10; ++k) top_work += work[order[k]];
+
+    out << "    \"tuiles\": {\n"
+        << "      \"taille\": " << profile.tile_size << ", \"nx\": " << profile.nb_tiles_x
+        << ", \"ny\": " << profile.nb_tiles_y << ",\n"
+        << "      \"minimum\": " << (nb_tiles > 0 ? work[order.back()] : 0)
+        << ", \"maximum\": " << (nb_tiles > 0 ? work[order.front()] : 0) << ", \"moyenne\": " << mean << ",\n"
+        << "      \"coefficient_variation\": " << (mean > 0. ? std::sqrt(variance)/mean : 0.)
+        << ", \"part_dixieme_plus_couteux\": " << (profile.work > 0 ? double(top_work)/double(profile.work) : 0.) << ",\n"
+        << "      \"plus_couteuses\": [";
+    for (std::size_t k = 0; k < std::min(nb_tiles, std::size_t(nb_hottest_tiles)); ++k)
+    {
+        std::size_t t = order[k];
+        out << (k > 0 ? ", " : "") << "{\"x\": " << t % profile.nb_tiles_x << ", \"y\": " << t / profile.nb_tiles_x
+            << ", \"iterations\": " << work[t] << "}";
+    }
+    out << "]\n    }";
+}
+// ....................................................................................................................
+void write_threads(std::ostream& out, IterationProfile const& profile)
+{
+    const std::size_t nb_threads = profile.thread_busy_ms.size();
+    double total_busy = std::accumulate(profile.thread_busy_ms.begin(), profile.thread_busy_ms.end(), 0.);
+    out << "    \"threads\": [\n";
+    for (std::size_t k = 0; k < nb_threads; ++k)
+        out << "      {\"occupe_ms\": " << profile.thread_busy_ms[k] << ", \"lignes\": " << profile.thread_rows[k]
+            << ", \"iterations\": " << profile.thread_work[k] << "}" << (k + 1 < nb_threads ? ",\n" : "\n");
+    // Efficacité : fraction du temps des threads passée à calculer plutôt qu'à attendre (ou à créer la région parallèle)
+    out << "    ],\n"
+        << "    \"desequilibre\": " << thread_imbalance(profile)
+        << ", \"efficacite\": " << (profile.elapsed_ms > 0. && nb_threads > 0 ? total_busy/(double(nb_threads)*profile.elapsed_ms) : 0.);
+}
+// ....................................................................................................................
+void write_profile(std::ostream& out, char const* name, IterationProfile const& profile, bool last)
+{
+    out << "  \"" << name << "\": {\n"
+        << "    \"duree_ms\": " << profile.elapsed_ms << ", \"iterations\": " << profile.work << ",\n";
+    write_tiles(out, profile);
+    if (not profile.thread_busy_ms.empty())
+    {
+        out << ",\n";
+        write_threads(out, profile);
+    }
+    out << "\n  }" << (last ? "\n" : ",\n");
+}
+}
+// ====================================================================================================================
+double thread_imbalance(IterationProfile const& profile)
+{
+    auto const& busy = profile.thread_busy_ms;
+    if (busy.empty()) return 0.;
+    double mean_busy = std::accumulate(busy.begin(), busy.end(), 0.)/double(busy.size());
+    return mean_busy > 0. ? *std::max_element(busy.begin(), busy.end())/mean_busy : 0.;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void save_heatmap(IterationProfile const& profile, std::string const& filename, int scale)
+{
+    const int width = profile.nb_tiles_x*scale, height = profile.nb_tiles_y*scale;
+    long long max_work = profile.tile_work.empty() ? 0 : *std::max_element(profile.tile_work.begin(), profile.tile_work.end());
+    std::vector<unsigned char> image(4*std::size_t(width)*std::size_t(height));
+    for (int i = 0; i < height; ++i)
+        for (int j = 0; j < width; ++j)
+        {
+            long long work = profile.tile_work[std::size_t(i/scale)*profile.nb_tiles_x + j/scale];
+            heat_color(max_work > 0 ? double(work)/double(max_work) : 0., &image[4*(std::size_t(i)*width + j)]);
+        }
+    unsigned error = lodepng::encode(filename, image, unsigned(width), unsigned(height));
+    if (error)
+        throw std::runtime_error("Erreur d'écriture de " + filename + " : " + lodepng_error_text(error));
+}
+// --------------------------------------------------------------------------------------------------------------------
+void save_profile_summary(std::string const& filename, View const& view, IterationProfile const& cpu,
+                          IterationProfile const* gpu)
+{
+    std::ofstream out(filename);
+    if (not out)
+        throw std::runtime_error("Impossible de créer le fichier " + filename);
+    out << "{\n"
+        << "  \"vue\": {\"largeur\": " << view.width << ", \"hauteur\": " << view.height << ", \"centre_x\": "
+        << view.center_x << ", \"centre_y\": " << view.center_y << ", \"etendue\": " << view.extent
+        << ", \"iterations_max\": " << view.max_iter << "},\n";
+    write_profile(out, "cpu", cpu, gpu == nullptr);
+    if (gpu) write_profile(out, "gpu", *gpu, true);
+    out << "}\n";
+}
+}
@@ -0,0 +1,32 @@
+#ifndef _MANDELBROT_PROFILING_HPP_
+#define _MANDELBROT_PROFILING_HPP_
+#include <string>
+#include "cpu_kernels.hpp"
+
+namespace mandelbrot
+{
+/**
+ * @brief Déséquilibre de charge d'un profil CPU : temps de calcul du thread le plus chargé sur temps moyen des threads
+ *        (1 pour une charge parfaitement répartie)
+ */
+double thread_imbalance(IterationProfile const& profile);
+
+/**
+ * @brief Sauvegarde la carte de chaleur des tuiles d'un profil : une tuile donne un carré de scale x scale pixels
+ *
+ * La couleur va du noir (tuile sans itération) au blanc (tuile la plus coûteuse) en passant par le rouge et le jaune,
+ * proportionnellement au nombre d'itérations de la tuile.
+ */
+void save_heatmap(IterationProfile const& profile, std::string const& filename, int scale = 8);
+
+/**
+ * @brief Écrit le résumé JSON d'un calcul instrumenté sur CPU et, si gpu n'est pas nul, sur GPU
+ *
+ * Pour chaque profil : durée, nombre d'itérations, statistiques des tuiles (minimum, maximum, moyenne, coefficient de
+ * variation, part des itérations dans le dixième le plus coûteux des tuiles, tuiles les plus coûteuses) et, sur CPU,
+ * charge de chaque thread et déséquilibre (temps du thread le plus chargé sur temps moyen).
+ */
+void save_profile_summary(std::string const& filename, View const& view, IterationProfile const& cpu,
+                          IterationProfile const* gpu);
+}
+#endif
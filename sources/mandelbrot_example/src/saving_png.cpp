@@ -1,10 +1,11 @@
 #include <iostream>
 #include "vk_computing.hpp"
 #include "lodepng.h"
+#include "png_stream.hpp"
 
 namespace vulkan {
 void 
-ComputingPipeline::save_rendered_image(Pixel* pmapped_memory, std::string const& filename)
+ComputingPipeline::save_rendered_image(Pixel* pmapped_memory, int width, int height, std::string const& filename)
 {
     std::cout << "Calcul image definitive" << std::endl << std::flush; 
     // on lit les données de couleurs du buffer qu'on transforme en octets et on sauve les données dans un tableau: 
@@ -18,8 +19,33 @@ ComputingPipeline::save_rendered_image(Pixel* pmapped_memory, std::string const&
         image.push_back((unsigned char)(255.0f * (pmapped_memory[i].a)));
     }
 
-    // Enfin, on sauvegarde le tableau de couleurs dans un fichier png :
-    unsigned error = lodepng::encode(filename, image, width, height);
+    // Enfin, on sauvegarde le tableau de couleurs dans un fichier png (bandes de lignes compressées en parallèle) :
+    unsigned error = mandelbrot::encode_png_parallel(filename, image.data(), width, height);
+    if (error) std::cerr << "Encoder error " << error << ": " << lodepng_error_text(error) << std::endl;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::save_image(void const* pixels, int width, int height, mandelbrot::OutputFormat format, std::string const& filename,
+                              int max_iter)
+{
+    if (format == mandelbrot::OutputFormat::rgba32f)
+    {
+        save_rendered_image((Pixel*)pixels, width, height, filename);
+        return;
+    }
+    if (format == mandelbrot::OutputFormat::iteration_map)
+    {
+        // La carte des nombres d'itérations n'est pas une image : on la met en couleur (linéairement) avant de la sauvegarder
+        std::vector<std::uint32_t> image(std::size_t(width) * std::size_t(height));
+        mandelbrot::colorize_map(mandelbrot::Coloring{}, width * height, max_iter, static_cast<float const*>(pixels), image.data());
+        save_image(image.data(), width, height, mandelbrot::OutputFormat::rgba8, filename);
+        return;
+    }
+    // Les octets sont déjà dans l'ordre du png : RGBA 8 bits ou niveaux de gris 16 bits (gros-boutiste)
+    auto colortype = (format == mandelbrot::OutputFormat::rgba8) ? LCT_RGBA : LCT_GREY;
+    unsigned bitdepth = (format == mandelbrot::OutputFormat::rgba8) ? 8 : 16;
+    unsigned error = mandelbrot::encode_png_parallel(filename, static_cast<unsigned char const*>(pixels), width, height,
+                                                     colortype, bitdepth);
     if (error) std::cerr << "Encoder error " << error << ": " << lodepng_error_text(error) << std::endl;
 }
 }
\ No newline at end of file
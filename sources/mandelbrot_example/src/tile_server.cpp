@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "ansi.hpp"
+#include "lodepng.h"
+#include "tile_server.hpp"
+#include "vk_computing.hpp"
+
+using namespace std::string_literals;
+
+namespace mandelbrot
+{
+namespace
+{
+// Fenêtre de regroupement : les requêtes arrivées pendant ce temps après la première en attente sont traitées ensemble
+constexpr const int coalescing_window_ms = 5;
+constexpr const std::size_t max_batch_size = 256;
+// Au-delà, la simple précision du shader ne distingue plus les pixels d'une tuile
+constexpr const int max_zoom_level = 16;
+constexpr const int default_tile_size = 256;
+constexpr const int max_tile_size = 1024;
+// Nombre maximal d'itérations d'une tuile (les valeurs demandées au-delà sont ramenées à cette borne) : une seule
+// requête ne doit pas occuper le GPU au détriment des autres
+constexpr const int max_tile_iterations = 16384;
+constexpr const std::size_t max_request_size = 8192;
+// Carré du plan complexe couvert par le niveau 0
+constexpr const float root_min_x = -2.5f, root_min_y = -2.f, root_extent = 4.f;
+// ....................................................................................................................
+// Envoie la suite de data à partir de l'octet sent sur une socket non bloquante, jusqu'à ce que le tampon d'envoi soit
+// plein. Renvoie vrai quand il n'y a plus rien à envoyer (réponse complète ou client ayant fermé la connexion).
+bool send_available(int socket, std::string const& data, std::size_t& sent)
+{
+    while (sent < data.size())
+    {
+        ssize_t count = ::send(socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return false;
+        if (count <= 0) return true; // Le client a fermé la connexion : rien à faire
+        sent += std::size_t(count);
+    }
+    return true;
+}
+// ....................................................................................................................
+std::string http_response(std::string const& status, std::string const& content_type, char const* body, std::size_t size)
+{
+    std::string response = "HTTP/1.1 "s + status + "\r\nContent-Type: " + content_type + "\r\nContent-Length: " +
+                           std::to_string(size) + "\r\nConnection: close\r\n\r\n";
+    response.append(body, size);
+    return response;
+}
+
+std::string http_text(std::string const& status, std::string const& text)
+{
+    return http_response(status, "text/plain; charset=utf-8", text.data(), text.size());
+}
+// ....................................................................................................................
+// Lit un entier positif ou nul écrit en décimal occupant tout le texte
+bool parse_number(std::string_view text, int& value)
+{
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size() && not text.empty() && value >= 0;
+}
+// ....................................................................................................................
+// Analyse le chemin /z/x/y.png?taille=T&iterations=M. Renvoie faux si la requête n'est pas une tuile valide.
+bool parse_tile(std::string const& target, TileKey& key)
+{
+    std::string_view path = target, query;
+    if (auto q = path.find('?'); q != std::string_view::npos)
+    {
+        query = path.substr(q + 1);
+        path  = path.substr(0, q);
+    }
+    constexpr std::string_view extension = ".png";
+    if (path.size() < 1 + extension.size() || path.front() != '/' || not path.ends_with(extension)) return false;
+    path = path.substr(1, path.size() - 1 - extension.size());
+    int* coordinates[3] = {&key.z, &key.x, &key.y};
+    for (int c = 0; c < 3; ++c)
+    {
+        auto slash = path.find('/');
+        if ((c < 2) != (slash != std::string_view::npos) || not parse_number(path.substr(0, slash), *coordinates[c]))
+            return false;
+        path = (c < 2 ? path.substr(slash + 1) : std::string_view());
+    }
+    key.size = default_tile_size;
+    key.max_iter = max_iterations;
+    while (not query.empty())
+    {
+        auto ampersand = query.find('&');
+        std::string_view parameter = query.substr(0, ampersand);
+        query = (ampersand == std::string_view::npos ? std::string_view() : query.substr(ampersand + 1));
+        auto equal = parameter.find('=');
+        if (equal == std::string_view::npos) return false;
+        std::string_view name = parameter.substr(0, equal);
+        int value;
+        if (not parse_number(parameter.substr(equal + 1), value)) return false;
+        if (name == "taille") key.size = value;
+        else if (name == "iterations") key.max_iter = std::min(value, max_tile_iterations);
+        else return false;
+    }
+    return key.z <= max_zoom_level && key.x < (1 << key.z) && key.y < (1 << key.z) && key.size > 0 &&
+           key.size <= max_tile_size && key.max_iter > 0;
+}
+// ....................................................................................................................
+double percentile(std::vector<double> const& sorted, double q)
+{
+    if (sorted.empty()) return 0.;
+    return sorted[std::min(sorted.size() - 1, std::size_t(q*double(sorted.size())))];
+}
+}
+// ====================================================================================================================
+std::string tile_cache_name(FractalFamily const& fractal, unsigned shortcuts, bool smooth_coloring, bool distance_estimation)
+{
+    // Hachage FNV-1a 64 bits de toutes les options qui changent les pixels d'une tuile
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](std::uint32_t value)
+    {
+        for (int b = 0; b < 4; ++b, value >>= 8)
+            hash = (hash ^ (value & 0xFFu)) * 1099511628211ull;
+    };
+    mix(std::uint32_t(fractal.kind));
+    mix(std::uint32_t(fractal.power));
+    mix(fractal.kind == Fractal::julia ? std::bit_cast<std::uint32_t>(fractal.julia_x) : 0u);
+    mix(fractal.kind == Fractal::julia ? std::bit_cast<std::uint32_t>(fractal.julia_y) : 0u);
+    mix(shortcuts);
+    mix(std::uint32_t(smooth_coloring) | (std::uint32_t(distance_estimation) << 1));
+    std::ostringstream name;
+    name << fractal_name(fractal.kind) << "_" << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return name.str();
+}
+// --------------------------------------------------------------------------------------------------------------------
+View TileKey::view() const
+{
+    const float extent = root_extent / float(1 << this->z);
+    return View{this->size, this->size, root_min_x + (float(this->x) + 0.5f)*extent, root_min_y + (float(this->y) + 0.5f)*extent,
+                extent, this->max_iter};
+}
+// --------------------------------------------------------------------------------------------------------------------
+std::string TileKey::name() const
+{
+    return std::to_string(this->z) + "_" + std::to_string(this->x) + "_" + std::to_string(this->y) + "_" +
+           std::to_string(this->size) + "_" + std::to_string(this->max_iter);
+}
+// --------------------------------------------------------------------------------------------------------------------
+std::size_t TileKeyHash::operator()(TileKey const& key) const
+{
+    std::size_t hash = std::size_t(key.z);
+    for (int value : {key.x, key.y, key.size, key.max_iter})
+        hash = hash * 1000003u ^ std::size_t(value);
+    return hash;
+}
+// ====================================================================================================================
+TileCache::TileCache(std::size_t memory_capacity, std::filesystem::path directory)
+    : memory_capacity(std::max<std::size_t>(1, memory_capacity)), directory(std::move(directory))
+{
+    std::filesystem::create_directories(this->directory);
+}
+// --------------------------------------------------------------------------------------------------------------------
+std::filesystem::path
+TileCache::file(TileKey const& key) const
+{
+    return this->directory / (key.name() + ".png");
+}
+// --------------------------------------------------------------------------------------------------------------------
+TileCache::Source
+TileCache::find(TileKey const& key, std::vector<unsigned char>& png)
+{
+    if (auto it = this->index.find(key); it != this->index.end())
+    {
+        // La tuile devient la plus récemment utilisée
+        this->lru.splice(this->lru.begin(), this->lru, it->second);
+        png = it->second->second;
+        return Source::memory;
+    }
+    std::vector<unsigned char> stored;
+    if (lodepng::load_file(stored, this->file(key).string()) != 0 || stored.empty())
+        return Source::none;
+    png = stored;
+    insert(key, std::move(stored));
+    return Source::disk;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+TileCache::insert(TileKey const& key, std::vector<unsigned char> png)
+{
+    if (this->index.count(key) > 0) return;
+    if (this->lru.size() == this->memory_capacity)
+    {
+        // Éviction de la tuile la moins récemment utilisée : elle est conservée sur disque
+        Entry const& oldest = this->lru.back();
+        auto path = this->file(oldest.first);
+        if (not std::filesystem::exists(path))
+        {
+            unsigned error = lodepng::save_file(oldest.second, path.string());
+            if (error) std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << " écriture de " << path << " : "
+                                 << lodepng_error_text(error) << std::endl;
+        }
+        this->index.erase(oldest.first);
+        this->lru.pop_back();
+    }
+    this->lru.emplace_front(key, std::move(png));
+    this->index[key] = this->lru.begin();
+}
+// ====================================================================================================================
+TileServer::TileServer(vulkan::ComputingPipeline& pipeline, int port, std::size_t memory_capacity, std::filesystem::path cache_directory)
+    : pipeline(pipeline), cache(memory_capacity, std::move(cache_directory))
+{
+    this->listen_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (this->listen_socket < 0)
+        throw std::runtime_error("Impossible de créer la socket du serveur de tuiles : "s + std::strerror(errno));
+    int reuse = 1;
+    ::setsockopt(this->listen_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(uint16_t(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Accessible seulement depuis la machine locale
+    if (::bind(this->listen_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(this->listen_socket, SOMAXCONN) < 0)
+    {
+        std::string error_msg = "Impossible d'écouter sur le port "s + std::to_string(port) + " : " + std::strerror(errno);
+        ::close(this->listen_socket);
+        throw std::runtime_error(error_msg);
+    }
+}
+// --------------------------------------------------------------------------------------------------------------------
+TileServer::~TileServer()
+{
+    if (this->listen_socket >= 0) ::close(this->listen_socket);
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+TileServer::serve()
+{
+    // Connexions dont la requête n'est pas encore complète, et requêtes de tuiles en attente de traitement
+    struct Connection
+    {
+        int socket;
+        std::string data;
+    };
+    std::vector<Connection> connections;
+    std::vector<Request> pending;
+    bool running = true;
+    // Après l'arrêt, on finit encore d'envoyer les réponses en cours
+    while (running || not pending.empty() || not this->outgoing.empty())
+    {
+        // Sockets surveillées : écoute, connexions en lecture (seulement en fonctionnement) puis réponses en cours d'envoi
+        const short read_events = (running ? POLLIN : 0);
+        std::vector<pollfd> fds(1 + connections.size() + this->outgoing.size());
+        fds[0] = pollfd{this->listen_socket, read_events, 0};
+        for (std::size_t c = 0; c < connections.size(); ++c)
+            fds[c + 1] = pollfd{connections[c].socket, read_events, 0};
+        const std::size_t first_outgoing = 1 + connections.size();
+        for (std::size_t o = 0; o < this->outgoing.size(); ++o)
+            fds[first_outgoing + o] = pollfd{this->outgoing[o].socket, POLLOUT, 0};
+        int timeout = -1;
+        if (not pending.empty())
+        {
+            auto waited = std::chrono::duration<double, std::milli>(Clock::now() - pending.front().arrival).count();
+            timeout = std::max(0, coalescing_window_ms - int(waited));
+        }
+        if ((running || not this->outgoing.empty()) && ::poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR)
+            throw std::runtime_error("Erreur d'attente des requêtes : "s + std::strerror(errno));
+
+        // Suite des réponses dont l'envoi était bloqué (avant d'en ajouter de nouvelles : les indices de fds restent valides)
+        for (std::size_t o = this->outgoing.size(); o-- > 0; )
+        {
+            if (not (fds[first_outgoing + o].revents & (POLLOUT | POLLHUP | POLLERR))) continue;
+            Outgoing& response = this->outgoing[o];
+            if (send_available(response.socket, response.data, response.sent))
+            {
+                ::close(response.socket);
+                this->outgoing.erase(this->outgoing.begin() + o);
+            }
+        }
+
+        // Lecture des requêtes (on parcourt les connexions en sens inverse pour pouvoir retirer les requêtes complètes)
+        for (std::size_t c = connections.size(); running && c-- > 0; )
+        {
+            if (not (fds[c + 1].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            Connection& connection = connections[c];
+            char chunk[4096];
+            ssize_t received = ::recv(connection.socket, chunk, sizeof(chunk), 0);
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) continue;
+            if (received <= 0 || connection.data.size() + std::size_t(received) > max_request_size)
+            {
+                ::close(connection.socket);
+                connections.erase(connections.begin() + c);
+                continue;
+            }
+            connection.data.append(chunk, std::size_t(received));
+            if (connection.data.find("\r\n\r\n") == std::string::npos) continue;
+
+            int socket = connection.socket;
+            std::istringstream request_line(connection.data.substr(0, connection.data.find("\r\n")));
+            connections.erase(connections.begin() + c);
+            std::string method, target;
+            request_line >> method >> target;
+            TileKey key;
+            if (method != "GET")
+                send_response(socket, http_text("405 Method Not Allowed", "Seule la méthode GET est acceptée\n"));
+            else if (target == "/stats")
+            {
+                std::ostringstream report;
+                print_report(report);
+                send_response(socket, http_text("200 OK", report.str()));
+            }
+            else if (target == "/arret")
+            {
+                send_response(socket, http_text("200 OK", "Arrêt du serveur\n"));
+                running = false;
+            }
+            else if (parse_tile(target, key))
+            {
+                ++this->nb_requests;
+                pending.push_back(Request{socket, key, Clock::now()});
+            }
+            else
+                send_response(socket, http_text("404 Not Found", "Tuile inconnue : attendu /z/x/y.png?taille=T&iterations=M avec z <= " +
+                                                 std::to_string(max_zoom_level) + ", T <= " + std::to_string(max_tile_size) +
+                                                 " et M ramené à " + std::to_string(max_tile_iterations) + " au plus\n"));
+        }
+        if (not running)
+        {
+            // Arrêt : les requêtes incomplètes sont abandonnées
+            for (auto& connection : connections) ::close(connection.socket);
+            connections.clear();
+        }
+        // Nouvelles connexions, non bloquantes : un client qui ne lit pas sa réponse ne bloque pas le serveur
+        if (running && (fds[0].revents & POLLIN))
+        {
+            int socket = ::accept4(this->listen_socket, nullptr, nullptr, SOCK_NONBLOCK);
+            if (socket >= 0) connections.push_back(Connection{socket, {}});
+        }
+
+        if (not pending.empty())
+        {
+            auto waited = std::chrono::duration<double, std::milli>(Clock::now() - pending.front().arrival).count();
+            if (not running || waited >= coalescing_window_ms || pending.size() >= max_batch_size)
+            {
+                process_batch(pending);
+                pending.clear();
+            }
+        }
+    }
+    for (auto& connection : connections) ::close(connection.socket);
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+TileServer::send_response(int socket, std::string response)
+{
+    // Ce qui ne peut pas être envoyé tout de suite le sera par serve() quand la socket sera prête
+    std::size_t sent = 0;
+    if (send_available(socket, response, sent))
+        ::close(socket);
+    else
+        this->outgoing.push_back(Outgoing{socket, std::move(response), sent});
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+TileServer::process_batch(std::vector<Request>& batch)
+{
+    // Les tuiles présentes dans le cache sont servies aussitôt. Les autres sont regroupées par tuile : des requêtes
+    // identiques ne donnent lieu qu'à un seul calcul
+    std::unordered_map<TileKey, std::vector<Request>, TileKeyHash> misses;
+    std::vector<TileKey> order; // Ordre d'arrivée des tuiles à calculer
+    std::vector<unsigned char> png;
+    for (auto const& request : batch)
+    {
+        if (misses.count(request.key) > 0)
+        {
+            misses[request.key].push_back(request);
+            continue;
+        }
+        auto source = this->cache.find(request.key, png);
+        if (source == TileCache::Source::none)
+        {
+            misses[request.key].push_back(request);
+            order.push_back(request.key);
+            continue;
+        }
+        if (source == TileCache::Source::memory) ++this->memory_hits;
+        else ++this->disk_hits;
+        respond(request, png);
+    }
+    if (order.empty()) return;
+
+    std::vector<View> views;
+    std::vector<std::vector<std::uint32_t>> images(order.size());
+    std::vector<std::uint32_t*> pointers;
+    for (std::size_t t = 0; t < order.size(); ++t)
+    {
+        views.push_back(order[t].view());
+        images[t].resize(std::size_t(order[t].size) * std::size_t(order[t].size));
+        pointers.push_back(images[t].data());
+    }
+    this->pipeline.render_tiles(views, pointers);
+    ++this->nb_batches;
+    this->nb_rendered += (long long)order.size();
+
+    for (std::size_t t = 0; t < order.size(); ++t)
+    {
+        png.clear();
+        unsigned error = lodepng::encode(png, reinterpret_cast<unsigned char const*>(images[t].data()),
+                                         unsigned(order[t].size), unsigned(order[t].size));
+        if (error) std::cerr << "Encoder error " << error << ": " << lodepng_error_text(error) << std::endl;
+        auto const& requests = misses[order[t]];
+        this->nb_coalesced += (long long)requests.size() - 1;
+        for (auto const& request : requests) respond(request, png);
+        this->cache.insert(order[t], std::move(png));
+    }
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+TileServer::respond(Request const& request, std::vector<unsigned char> const& png)
+{
+    send_response(request.socket, http_response("200 OK", "image/png", reinterpret_cast<char const*>(png.data()), png.size()));
+    this->latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - request.arrival).count());
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+TileServer::print_report(std::ostream& out) const
+{
+    auto rate = [this](long long count) { return this->nb_requests > 0 ? 100.*double(count)/double(this->nb_requests) : 0.; };
+    std::vector<double> sorted(this->latencies);
+    std::sort(sorted.begin(), sorted.end());
+    out << "Requêtes de tuiles : " << this->nb_requests << std::endl
+        << "  cache mémoire : " << this->memory_hits << " (" << rate(this->memory_hits) << "%)" << std::endl
+        << "  cache disque  : " << this->disk_hits << " (" << rate(this->disk_hits) << "%)" << std::endl
+        << "  calculées     : " << this->nb_rendered << " tuiles en " << this->nb_batches << " lots, " << this->nb_coalesced
+        << " requêtes identiques regroupées (" << rate(this->nb_coalesced) << "%)" << std::endl
+        << "  latence       : médiane " << percentile(sorted, 0.5) << "[ms], 90% " << percentile(sorted, 0.9) << "[ms], 99% "
+        << percentile(sorted, 0.99) << "[ms], max " << (sorted.empty() ? 0. : sorted.back()) << "[ms]" << std::endl;
+}
+}
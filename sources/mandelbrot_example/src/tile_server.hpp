@@ -0,0 +1,166 @@
+#ifndef _MANDELBROT_TILE_SERVER_HPP_
+#define _MANDELBROT_TILE_SERVER_HPP_
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cpu_kernels.hpp"
+
+namespace vulkan
+{
+class ComputingPipeline;
+}
+
+namespace mandelbrot
+{
+/**
+ * @brief Identifiant d'une tuile : niveau de zoom z, colonne x, ligne y, taille (en pixels) et nombre maximal d'itérations
+ *
+ * Au niveau z, le carré [-2.5, 1.5] x [-2, 2] du plan complexe est découpé en 2^z x 2^z tuiles carrées (x croissant vers
+ * la droite, y vers le bas de l'image, comme les lignes de View).
+ */
+struct TileKey
+{
+    int z, x, y;
+    int size;
+    int max_iter;
+
+    bool operator==(TileKey const&) const = default;
+
+    /**
+     * @brief Paramètres du rendu de la tuile
+     */
+    View view() const;
+
+    /**
+     * @brief Nom (unique) de la tuile, utilisé pour le fichier du cache sur disque
+     */
+    std::string name() const;
+};
+
+struct TileKeyHash
+{
+    std::size_t operator()(TileKey const& key) const;
+};
+
+/**
+ * @brief Nom du répertoire du cache sur disque propre aux options de rendu du serveur : nom de la fractale suivi d'un
+ *        hachage de la famille, de l'exposant, de la constante de julia, des raccourcis, de la coloration continue et de
+ *        l'estimation de distance
+ *
+ * Le nom d'une tuile (TileKey::name) ne contient que sa position, sa taille et son nombre d'itérations : des tuiles
+ * calculées avec d'autres options doivent être rangées dans un autre répertoire pour ne jamais être relues.
+ */
+std::string tile_cache_name(FractalFamily const& fractal, unsigned shortcuts, bool smooth_coloring, bool distance_estimation);
+
+/**
+ * @brief Cache des tuiles encodées en png : LRU en mémoire, dont les tuiles évincées sont écrites sur disque
+ *
+ * Une tuile trouvée sur disque est remise en mémoire (en tête de la liste LRU).
+ */
+class TileCache
+{
+public:
+    enum class Source { none, memory, disk };
+
+    TileCache(std::size_t memory_capacity, std::filesystem::path directory);
+
+    /**
+     * @brief Cherche la tuile en mémoire puis sur disque. Si elle est trouvée, png reçoit le fichier encodé.
+     */
+    Source find(TileKey const& key, std::vector<unsigned char>& png);
+
+    /**
+     * @brief Ajoute une tuile en mémoire, en écrivant sur disque la moins récemment utilisée si le cache est plein
+     */
+    void insert(TileKey const& key, std::vector<unsigned char> png);
+
+private:
+    using Entry = std::pair<TileKey, std::vector<unsigned char>>;
+
+    std::filesystem::path file(TileKey const& key) const;
+
+    std::size_t memory_capacity;
+    std::filesystem::path directory;
+    std::list<Entry> lru; // De la plus récemment utilisée à la moins récemment utilisée
+    std::unordered_map<TileKey, std::list<Entry>::iterator, TileKeyHash> index;
+};
+
+/**
+ * @brief Serveur HTTP local (127.0.0.1) de tuiles calculées sur GPU par un ComputingPipeline de longue durée
+ *
+ * Requêtes comprises :
+ *
+ *     GET /z/x/y.png?taille=256&iterations=512   tuile au format png (taille et iterations facultatifs, iterations
+ *                                                ramené à une borne fixe s'il la dépasse)
+ *     GET /stats                                 bilan (voir print_report)
+ *     GET /arret                                 arrêt du serveur
+ *
+ * Les requêtes arrivées pendant une courte fenêtre sont traitées ensemble : celles trouvées dans le cache sont servies
+ * aussitôt, les autres sont regroupées (une seule fois pour des requêtes identiques) et calculées en une seule
+ * soumission par ComputingPipeline::render_tiles. Les sockets des clients sont non bloquantes : une réponse qui ne peut
+ * pas être envoyée entièrement est terminée quand le client la lit, sans retarder les autres.
+ */
+class TileServer
+{
+public:
+    /**
+     * @brief Ouvre le port (sur 127.0.0.1 seulement). Le pipeline doit être initialisé, au format rgba8.
+     */
+    TileServer(vulkan::ComputingPipeline& pipeline, int port, std::size_t memory_capacity, std::filesystem::path cache_directory);
+    ~TileServer();
+
+    /**
+     * @brief Répond aux requêtes jusqu'à la requête GET /arret
+     */
+    void serve();
+
+    /**
+     * @brief Affiche le nombre de requêtes, les taux de succès des caches, le regroupement des calculs et les centiles
+     *        de la latence des requêtes de tuiles
+     */
+    void print_report(std::ostream& out) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Request
+    {
+        int socket;
+        TileKey key;
+        Clock::time_point arrival; // Réception complète de la requête
+    };
+
+    // Réponse dont l'envoi sur une socket non bloquante n'a pas pu être terminé immédiatement
+    struct Outgoing
+    {
+        int socket;
+        std::string data;
+        std::size_t sent; // Nombre d'octets déjà envoyés
+    };
+
+    void process_batch(std::vector<Request>& batch);
+    void respond(Request const& request, std::vector<unsigned char> const& png);
+    /**
+     * @brief Envoie une réponse HTTP complète puis ferme la socket, sans bloquer (la fin de l'envoi est laissée à serve)
+     */
+    void send_response(int socket, std::string response);
+
+    vulkan::ComputingPipeline& pipeline;
+    TileCache cache;
+    int listen_socket{-1};
+    std::vector<Outgoing> outgoing; // Réponses en cours d'envoi
+
+    long long nb_requests{0};  // Requêtes de tuiles (valides)
+    long long memory_hits{0};
+    long long disk_hits{0};
+    long long nb_rendered{0};  // Tuiles calculées sur GPU
+    long long nb_coalesced{0}; // Requêtes servies par le calcul d'une requête identique du même lot
+    long long nb_batches{0};   // Lots calculés sur GPU
+    std::vector<double> latencies; // En millisecondes
+};
+}
+#endif
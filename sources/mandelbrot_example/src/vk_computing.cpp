@@ -7,13 +7,33 @@
 #include <cmath>
 #include <thread>
 #include <string>
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <atomic>
+#include <omp.h>
 using namespace std::string_literals;
 #include "ansi.hpp"
 #include "debug_utils.hpp"
 #include "vk_computing.hpp"
+#include "png_stream.hpp"
+#include "profiling.hpp"
 
 namespace vulkan {
 constexpr const int workgroup_size = 32; // Taille des groupes de travail dans le shader de calcul
+constexpr const uint32_t resume_workgroup_size = 256; // Taille des groupes de travail (1D) dans le shader resume.comp
+constexpr const uint32_t perturbation_workgroup_size = 256; // Taille des groupes de travail (1D) dans le shader perturbation.comp
+constexpr const uint32_t colorize_workgroup_size = 256; // Taille des groupes de travail (1D) dans le shader colorize.comp
+constexpr const uint32_t supersample_workgroup_size = 256; // Taille des groupes de travail (1D) dans le shader supersample.comp
+// Nombres de groupes de travail essayés pour les threads persistants : le nombre d'unités de calcul du GPU n'est pas
+// accessible par Vulkan, on essaie donc quelques multiples courants (ceux dépassant le nombre de tuiles sont ignorés)
+constexpr const std::array<uint32_t, 6> persistent_workgroup_counts{16, 32, 64, 128, 256, 512};
+// Hauteur du premier lot du GPU lors du co-rendu et multiple de celle des suivants : une ligne de groupes de travail du shader
+constexpr const int co_rendering_tile_rows = workgroup_size;
+// Rapport entre les étendues de deux images successives d'une animation de zoom
+constexpr const float animation_zoom_factor = 0.98f;
 // ====================================================================================================================
 void
 ComputingPipeline::create_instance()
@@ -23,6 +43,8 @@ ComputingPipeline::create_instance()
     Vulkan est une API explicite, permettant un contrôle direct de la façon dont un GPU fonctionne vraiment.
     Vulkan est conçu afin qu'une vérification minimale 
     */
+    // L'instance peut être recréée (plusieurs appels à run()) : on repart d'une liste d'extensions vide
+    this->enabled_extensions.clear();
     if constexpr (enableValidationLayers)
     {
         auto layer_properties = vk::enumerateInstanceLayerProperties();
@@ -170,9 +192,11 @@ ComputingPipeline::create_device()
                      .setQueuePriorities(queue_priority);// Quand on a plusieurs queues, on peut leur attribuer des priorités. Ici une queue, donc aucune importance
     
     // On va maintenant créer notre périphérique logique qui nous permettra d'interagir avec le périphérique physique.
-    // On peut spécifier toutes les caractéristiques désirées pour notre périphérique. On n'en a besoin d'aucune pour cette application...
-    // On prend donc l'objet construit par défaut.
+    // On peut spécifier toutes les caractéristiques désirées pour notre périphérique. Seule la double précision dans les
+    // shaders (shader double.comp) nous intéresse : on l'active si le périphérique la propose.
+    this->float64_supported = (this->physical_device.getFeatures().shaderFloat64 == VK_TRUE);
     vk::PhysicalDeviceFeatures device_features;
+    device_features.setShaderFloat64(this->float64_supported ? VK_TRUE : VK_FALSE);
     vk::DeviceCreateInfo device_create_info;
     device_create_info.setEnabledLayerCount(this->enabled_layers.size())
                       .setPpEnabledLayerNames(this->enabled_layers.data())
@@ -200,14 +224,28 @@ ComputingPipeline::find_memory_type(uint32_t memory_type_bits, vk::MemoryPropert
 }
 // --------------------------------------------------------------------------------------------------------------------
 void
-ComputingPipeline::create_buffer()
+ComputingPipeline::create_buffer(vk::DeviceSize size)
 {
-    // On va créer un buffer. On calculera l'ensemble de mandelbrot dans ce buffer à l'aide d'un shader de calcul
+    // On calculera l'ensemble de mandelbrot dans ce buffer à l'aide d'un shader de calcul. Il doit aussi pouvoir être
+    // remis à zéro par fillBuffer (format iterations16, voir record_image_clear)
+    this->buffer_size = size;
+    allocate_buffer(size, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst, this->buffer, this->buffer_memory);
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::allocate_buffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::Buffer& buffer, vk::DeviceMemory& buffer_memory)
+{
+    // Le buffer est recréé lorsqu'un rendu demande plus de mémoire : on libère d'abord l'ancien buffer s'il existe
+    if (buffer)
+    {
+        this->logical_device.freeMemory(buffer_memory, nullptr);
+        this->logical_device.destroyBuffer(buffer, nullptr);
+    }
     vk::BufferCreateInfo buffer_create_info;
-    buffer_create_info.setSize(buffer_size)                              // La taille du buffer en octets
-                      .setUsage(vk::BufferUsageFlagBits::eStorageBuffer) // Le buffer sera utilisé comme buffer de stockage
+    buffer_create_info.setSize(size)                                     // La taille du buffer en octets
+                      .setUsage(usage)                                   // Usage du buffer (buffer de stockage, destination de transfert, ...)
                       .setSharingMode(vk::SharingMode::eExclusive);      // Et il sera exclusif : une seule famille de queue peut le manipuler en même temps
-    this->buffer = this->logical_device.createBuffer(buffer_create_info, nullptr);
+    buffer = this->logical_device.createBuffer(buffer_create_info, nullptr);
 
     //! ATTENTION : le buffer n'alloue pas de lui-même la mémoire. On doit le faire manuellement
     //! ========================================================================================
@@ -228,9 +266,9 @@ ComputingPipeline::create_buffer()
     //allocate_info.setMemoryTypeIndex(find_memory_type(memory_requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eHostCoherent |
     allocate_info.setMemoryTypeIndex(find_memory_type(memory_requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eHostCached     /*|
                                                                                           vk::MemoryPropertyFlagBits::eHostVisible*/) );
-    this->buffer_memory = this->logical_device.allocateMemory(allocate_info, nullptr);
+    buffer_memory = this->logical_device.allocateMemory(allocate_info, nullptr);
     // On associe maintenant la mémoire allouée au buffer :
-    this->logical_device.bindBufferMemory(this->buffer, this->buffer_memory, 0); // Dernier paramètre : offset
+    this->logical_device.bindBufferMemory(buffer, buffer_memory, 0); // Dernier paramètre : offset
 }
 // --------------------------------------------------------------------------------------------------------------------
 void
@@ -242,15 +280,17 @@ ComputingPipeline::create_descriptor_set_layout()
     //    layout(std140, binding = 0) buffer buff
     //
     // dans le shader de calcul (seul objet vulkan partagé par les threads qu'on utilisera).
-    vk::DescriptorSetLayoutBinding descriptor_set_layout_binding;
-    descriptor_set_layout_binding.setBinding(0)
-                                 .setDescriptorType(vk::DescriptorType::eStorageBuffer)
-                                 .setDescriptorCount(1)
-                                 .setStageFlags(vk::ShaderStageFlagBits::eCompute);
-    // Ainsi, notre disposition (layout) ne contiendra qu'un seul descripteur :
+    // Le point de liaison 1 est la palette précalculée (en lecture seule), utilisée seulement par shader.comp, et le point
+    // de liaison 2 le compteur de tuiles des threads persistants (voir render_persistent).
+    std::array<vk::DescriptorSetLayoutBinding, 3> descriptor_set_layout_bindings;
+    for (uint32_t b = 0; b < descriptor_set_layout_bindings.size(); ++b)
+        descriptor_set_layout_bindings[b].setBinding(b)
+                                         .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                                         .setDescriptorCount(1)
+                                         .setStageFlags(vk::ShaderStageFlagBits::eCompute);
     vk::DescriptorSetLayoutCreateInfo create_info;
-    create_info.setBindingCount(1)
-               .setPBindings(&descriptor_set_layout_binding);
+    create_info.setBindingCount(uint32_t(descriptor_set_layout_bindings.size()))
+               .setPBindings(descriptor_set_layout_bindings.data());
     // Création de la disposition de l'ensemble de descripteur :
     this->descriptor_set_layout = this->logical_device.createDescriptorSetLayout(create_info, nullptr);
 }
@@ -260,14 +300,17 @@ ComputingPipeline::create_descriptor_set()
 {
     /*
     Nous allons allouer un ensemble de descripteur ici. Pour cela, on doit d'abord créer une ressource de descripteurs.
-    Puisqu'on n'a besoin que d'un seul descripteur, notre réservoir ne pourra en allouer qu'un seul...
+    Le réservoir doit pouvoir allouer notre ensemble (trois descripteurs : image, palette et compteur de tuiles), celui du calcul avec reprise
+    (trois descripteurs, voir create_resume_pipeline), celui du zoom profond (quatre descripteurs, voir create_perturbation_pipeline),
+    celui de la mise en couleur (cinq descripteurs, voir create_colorize_pipeline) et celui de l'anticrénelage (quatre
+    descripteurs, voir create_supersample_pipeline)
     */
     vk::DescriptorPoolSize descriptor_pool_size;
     descriptor_pool_size.setType(vk::DescriptorType::eStorageBuffer);
-    descriptor_pool_size.setDescriptorCount(1);
+    descriptor_pool_size.setDescriptorCount(19);
 
     vk::DescriptorPoolCreateInfo descriptor_pool_create_info;
-    descriptor_pool_create_info.setMaxSets(1)
+    descriptor_pool_create_info.setMaxSets(5)
                                .setPoolSizeCount(1)
                                .setPPoolSizes(&descriptor_pool_size);
     
@@ -282,7 +325,11 @@ ComputingPipeline::create_descriptor_set()
     // Allocation de(s) ensemble(s) de descripteurs. La méthode renvoie un tableau dynamique...
     auto descriptors_set = this->logical_device.allocateDescriptorSets(descriptor_set_allocate_info);
     this->descriptor_set = descriptors_set[0];
-
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::update_descriptor_set()
+{
     // Pour GLSL, on a besoin de connecter notre buffer de stockage actuel avec un descripteur.
     // On va utiliser la méthode updateDescriptorSets de logic_device pour mettre à jour notre ensemble de descripteurs
     vk::DescriptorBufferInfo descriptor_buffer_info;
@@ -299,6 +346,56 @@ ComputingPipeline::create_descriptor_set()
     this->logical_device.updateDescriptorSets(1, &write_descriptor_set, 0, nullptr);
 }
 // --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::create_palette_buffer()
+{
+    // La palette ne change pas d'un rendu à l'autre : elle est copiée une seule fois (la mémoire n'étant pas forcément
+    // cohérente, on la vide explicitement)
+    auto const& palette = mandelbrot::cosine_palette();
+    allocate_buffer(sizeof(palette.colors), vk::BufferUsageFlagBits::eStorageBuffer, this->palette_buffer, this->palette_memory);
+    void* mapped_palette = this->logical_device.mapMemory(this->palette_memory, 0, VK_WHOLE_SIZE);
+    std::memcpy(mapped_palette, palette.colors, sizeof(palette.colors));
+    vk::MappedMemoryRange palette_range;
+    palette_range.setMemory(this->palette_memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+    this->logical_device.flushMappedMemoryRanges(palette_range);
+    this->logical_device.unmapMemory(this->palette_memory);
+
+    vk::DescriptorBufferInfo descriptor_buffer_info;
+    descriptor_buffer_info.setBuffer(this->palette_buffer)
+                          .setOffset(0)
+                          .setRange(sizeof(palette.colors));
+    vk::WriteDescriptorSet write_descriptor_set;
+    write_descriptor_set.setDstSet(this->descriptor_set)
+                        .setDstBinding(1)
+                        .setDescriptorCount(1)
+                        .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                        .setPBufferInfo(&descriptor_buffer_info);
+    this->logical_device.updateDescriptorSets(1, &write_descriptor_set, 0, nullptr);
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::create_tile_counter_buffer(vk::DeviceSize size)
+{
+    // Un seul entier, remis à zéro par fillBuffer avant chaque rendu par threads persistants. Il est relié même si
+    // render_persistent n'est jamais appelé : le shader principal y fait référence quelle que soit sa spécialisation.
+    // render_profiled l'agrandit pour y ajouter le coût de chaque tuile (allocate_buffer libère alors l'ancien buffer).
+    allocate_buffer(size, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                    this->tile_counter_buffer, this->tile_counter_memory);
+    this->tile_counter_size = size;
+
+    vk::DescriptorBufferInfo descriptor_buffer_info;
+    descriptor_buffer_info.setBuffer(this->tile_counter_buffer)
+                          .setOffset(0)
+                          .setRange(size);
+    vk::WriteDescriptorSet write_descriptor_set;
+    write_descriptor_set.setDstSet(this->descriptor_set)
+                        .setDstBinding(2)
+                        .setDescriptorCount(1)
+                        .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                        .setPBufferInfo(&descriptor_buffer_info);
+    this->logical_device.updateDescriptorSets(1, &write_descriptor_set, 0, nullptr);
+}
+// --------------------------------------------------------------------------------------------------------------------
 namespace __details__
 {
 std::vector<uint32_t> read_file(char const *filename)
@@ -355,6 +452,30 @@ ComputingPipeline::create_compute_pipeline()
 
     this->compute_shader_module = this->logical_device.createShaderModule(create_info, nullptr);
 
+    /* 
+     * La disposition suivant permet au pipeline d'accèder aux ensembles des descripteurs.
+     * Nous n'avons qu'à spécifier la disposition de l'ensemble des descripteurs que nous avons crée plus tôt
+     * Note : L'ordre des layout pour les descriptions donnera le n° du set dans le shader (si set par précisé dans shader, vaut 0) !
+    */
+    // Les paramètres du rendu (mandelbrot::View) sont transmis au shader par des constantes poussées : on peut ainsi changer
+    // de résolution ou de fenêtre d'un rendu à l'autre sans recréer le pipeline.
+    vk::PushConstantRange push_constant_range;
+    push_constant_range.setStageFlags(vk::ShaderStageFlagBits::eCompute)
+                       .setOffset(0)
+                       .setSize(sizeof(MainParameters));
+    vk::PipelineLayoutCreateInfo pipeline_layout_create_info;
+    pipeline_layout_create_info.setSetLayoutCount(1)
+                               .setPSetLayouts(&this->descriptor_set_layout)
+                               .setPushConstantRangeCount(1)
+                               .setPPushConstantRanges(&push_constant_range);
+    this->pipeline_layout = this->logical_device.createPipelineLayout(pipeline_layout_create_info, nullptr);
+
+    this->pipeline = create_main_pipeline(false);
+}
+// --------------------------------------------------------------------------------------------------------------------
+vk::Pipeline
+ComputingPipeline::create_main_pipeline(bool persistent_threads, bool profiling)
+{
     /*
     Nous allons créer enfin le pipeline de calcul.
     Un pipeline de calcul est très simple par rapport à un pipeline graphique.
@@ -362,26 +483,47 @@ ComputingPipeline::create_compute_pipeline()
 
     On spécifie donc en premier lieu l'étape de calcul par shader de calcul et son point d'entrée (main)
     */
+    /*
+    Les raccourcis pour les points intérieurs sont des constantes de spécialisation du shader (constant_id = 0 et 1) :
+    leur valeur est fixée à la création du pipeline et le pilote compile le shader comme si c'étaient des constantes.
+    Les booléens de spécialisation sont transmis comme des VkBool32. Le format de l'image (constant_id = 2) est un entier
+    non signé de 4 octets, comme un VkBool32. La coloration continue est le booléen constant_id = 3
+    et les threads persistants le booléen constant_id = 4 : les deux pipelines partagent le module et la disposition.
+    L'estimation de la distance au bord est le booléen constant_id = 5. La fractale est décrite par les constantes 6
+    (famille), 7 (exposant) et 8, 9 (constante de julia, des flottants transmis par leur représentation binaire).
+    L'instrumentation (coût de chaque tuile) est le booléen constant_id = 10.
+    */
+    std::array<uint32_t, 11> specialization_data{ (this->shortcuts & mandelbrot::interior_test)    ? VK_TRUE : VK_FALSE,
+                                                 (this->shortcuts & mandelbrot::periodicity_test) ? VK_TRUE : VK_FALSE,
+                                                 uint32_t(this->output_format),
+                                                 this->smooth_coloring ? VK_TRUE : VK_FALSE,
+                                                 persistent_threads ? VK_TRUE : VK_FALSE,
+                                                 this->distance_estimation ? VK_TRUE : VK_FALSE,
+                                                 uint32_t(this->fractal.kind),
+                                                 uint32_t(this->fractal.power),
+                                                 std::bit_cast<uint32_t>(this->fractal.julia_x),
+                                                 std::bit_cast<uint32_t>(this->fractal.julia_y),
+                                                 profiling ? VK_TRUE : VK_FALSE };
+    std::array<vk::SpecializationMapEntry, 11> specialization_entries;
+    for (uint32_t k = 0; k < specialization_entries.size(); ++k)
+        specialization_entries[k].setConstantID(k).setOffset(k*sizeof(uint32_t)).setSize(sizeof(uint32_t));
+    vk::SpecializationInfo specialization_info;
+    specialization_info.setMapEntryCount(uint32_t(specialization_entries.size()))
+                       .setPMapEntries(specialization_entries.data())
+                       .setDataSize(sizeof(specialization_data))
+                       .setPData(specialization_data.data());
+
     vk::PipelineShaderStageCreateInfo shader_stage_create_info;
     shader_stage_create_info.setStage(vk::ShaderStageFlagBits::eCompute)
                             .setModule(this->compute_shader_module)
-                            .setPName("main");
-    /* 
-     * La disposition suivant permet au pipeline d'accèder aux ensembles des descripteurs.
-     * Nous n'avons qu'à spécifier la disposition de l'ensemble des descripteurs que nous avons crée plus tôt
-     * Note : L'ordre des layout pour les descriptions donnera le n° du set dans le shader (si set par précisé dans shader, vaut 0) !
-    */
-    vk::PipelineLayoutCreateInfo pipeline_layout_create_info;
-    pipeline_layout_create_info.setSetLayoutCount(1)
-                               .setPSetLayouts(&this->descriptor_set_layout);
-    this->pipeline_layout = this->logical_device.createPipelineLayout(pipeline_layout_create_info, nullptr);
-
+                            .setPName("main")
+                            .setPSpecializationInfo(&specialization_info);
     std::vector<vk::ComputePipelineCreateInfo> pipeline_create_infos(1);
     pipeline_create_infos[0].setStage(shader_stage_create_info);
     pipeline_create_infos[0].setLayout(this->pipeline_layout);
 
     auto pipelines = this->logical_device.createComputePipelines(vk::PipelineCache{nullptr}, pipeline_create_infos);
-    this->pipeline = pipelines.value[0];
+    return pipelines.value[0];
 }
 // --------------------------------------------------------------------------------------------------------------------
 void 
@@ -394,7 +536,9 @@ ComputingPipeline::create_command_buffer()
     C'est ce qu'on fait en premier.
     */
     vk::CommandPoolCreateInfo command_pool_create_info;
-    command_pool_create_info.setQueueFamilyIndex(this->queue_family_index);
+    // Le buffer de commande est réenregistré à chaque rendu : il doit pouvoir être réinitialisé individuellement
+    command_pool_create_info.setQueueFamilyIndex(this->queue_family_index)
+                            .setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
     this->command_pool = this->logical_device.createCommandPool(command_pool_create_info, nullptr);
 
     // On alloue maintenant un buffer de commande de la ressource de commandes
@@ -407,10 +551,15 @@ ComputingPipeline::create_command_buffer()
                                 .setCommandBufferCount(1);// On alloue qu'une seul buffer de commande
     auto command_buffers = this->logical_device.allocateCommandBuffers(command_buffer_allocate_info);// Allocation du buffer de commande
     this->command_buffer = command_buffers[0];
-
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::record_command_buffer(mandelbrot::View const& view)
+{
     //this->command_buffer.writeTimestamp(...)
 
-    // On peut commencer à enregistrer les commandes dans le buffer qui vient d'être alloué
+    // On peut commencer à enregistrer les commandes dans le buffer alloué (après avoir effacé l'enregistrement précédent)
+    this->command_buffer.reset();
     vk::CommandBufferBeginInfo begin_info;
     begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit); // Le buffer est seulement soumis et utilisé une seule fois dans cette application
     this->command_buffer.begin(begin_info);// On commence l'enregistrement
@@ -419,19 +568,42 @@ ComputingPipeline::create_command_buffer()
 
     La couche de validation NE DONNE PAS d'alertes si on oublie cette étape, donc bien faire attention de ne pas oublier cette étape
     */
+    record_image_clear(view);
     this->command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute,this->pipeline);
     this->command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, this->pipeline_layout, 0, 1, &this->descriptor_set, 0, nullptr);
+    // Les paramètres du rendu sont copiés dans le buffer de commande au moment de l'enregistrement
+    MainParameters parameters{view, 0};
+    this->command_buffer.pushConstants(this->pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(MainParameters), &parameters);
 
     /*
     Appelé la méthode dispatch du buffer de commande qui commence à calculer le pipeline et exécuter le shader de calcul.
     Le nombre de groupes de travail est spécifié dans les argumetns
     Si vous êtes familiés avec les shaders de calcul en OpenGL, rien de nouveau sous le soleil ici.   
     */
-    this->command_buffer.dispatch( uint32_t(std::ceil(width/float(workgroup_size))), uint32_t(std::ceil(height/float(workgroup_size))), 1 );
+    this->command_buffer.dispatch( uint32_t(std::ceil(view.width/float(workgroup_size))), uint32_t(std::ceil(view.height/float(workgroup_size))), 1 );
 
     this->command_buffer.end();// Fin de l'enregistrement des commandes
 }
 // --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::record_image_clear(mandelbrot::View const& view)
+{
+    record_image_clear(view, this->command_buffer, this->buffer);
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::record_image_clear(mandelbrot::View const& view, vk::CommandBuffer command_buffer, vk::Buffer buffer)
+{
+    if (this->output_format != mandelbrot::OutputFormat::iterations16) return;
+    vk::DeviceSize image_size = mandelbrot::image_size_in_bytes(this->output_format, std::size_t(view.width) * std::size_t(view.height));
+    command_buffer.fillBuffer(buffer, 0, image_size, 0);
+    vk::MemoryBarrier fill_barrier;
+    fill_barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+                                         1, &fill_barrier, 0, nullptr, 0, nullptr);
+}
+// --------------------------------------------------------------------------------------------------------------------
 void 
 ComputingPipeline::run_command_buffer()
 {
@@ -470,12 +642,143 @@ ComputingPipeline::clean_up()
     if constexpr (enableValidationLayers) 
         this->pt_dbg_utils = nullptr;
 
-    this->logical_device.freeMemory(this->buffer_memory, nullptr);
-    this->logical_device.destroyBuffer(this->buffer, nullptr);
+    if (this->buffer)
+    {
+        this->logical_device.freeMemory(this->buffer_memory, nullptr);
+        this->logical_device.destroyBuffer(this->buffer, nullptr);
+        this->buffer = nullptr;
+        this->buffer_size = 0;
+    }
+    if (this->palette_buffer)
+    {
+        this->logical_device.freeMemory(this->palette_memory, nullptr);
+        this->logical_device.destroyBuffer(this->palette_buffer, nullptr);
+        this->palette_buffer = nullptr;
+    }
+    if (this->tile_counter_buffer)
+    {
+        this->logical_device.freeMemory(this->tile_counter_memory, nullptr);
+        this->logical_device.destroyBuffer(this->tile_counter_buffer, nullptr);
+        this->tile_counter_buffer = nullptr;
+        this->tile_counter_size = 0;
+    }
+    if (this->tiles_buffer)
+    {
+        this->logical_device.freeMemory(this->tiles_memory, nullptr);
+        this->logical_device.destroyBuffer(this->tiles_buffer, nullptr);
+        this->tiles_buffer = nullptr;
+        this->tiles_capacity = 0;
+    }
+    if (this->persistent_pipeline)
+    {
+        this->logical_device.destroyPipeline(this->persistent_pipeline, nullptr);
+        this->persistent_pipeline = nullptr;
+    }
+    if (this->profiling_pipeline)
+    {
+        this->logical_device.destroyPipeline(this->profiling_pipeline, nullptr);
+        this->profiling_pipeline = nullptr;
+    }
+    if (this->resume_pipeline)
+    {
+        this->logical_device.freeMemory(this->state_memory, nullptr);
+        this->logical_device.destroyBuffer(this->state_buffer, nullptr);
+        this->logical_device.freeMemory(this->active_memory, nullptr);
+        this->logical_device.destroyBuffer(this->active_buffer, nullptr);
+        this->state_buffer = nullptr;
+        this->active_buffer = nullptr;
+        this->resume_capacity = 0;
+        this->logical_device.destroyPipeline(this->resume_pipeline, nullptr);
+        this->logical_device.destroyPipelineLayout(this->resume_pipeline_layout, nullptr);
+        this->logical_device.destroyShaderModule(this->resume_shader_module, nullptr);
+        this->logical_device.destroyDescriptorSetLayout(this->resume_descriptor_set_layout, nullptr);
+        this->resume_pipeline = nullptr;
+        this->resume_view = mandelbrot::View{0, 0, 0.f, 0.f, 0.f, 0};
+    }
+    if (this->perturbation_pipeline)
+    {
+        if (this->orbit_buffer)
+        {
+            this->logical_device.freeMemory(this->orbit_memory, nullptr);
+            this->logical_device.destroyBuffer(this->orbit_buffer, nullptr);
+            this->orbit_buffer = nullptr;
+            this->orbit_capacity = 0;
+        }
+        if (this->glitch_buffer)
+        {
+            this->logical_device.freeMemory(this->glitch_memory, nullptr);
+            this->logical_device.destroyBuffer(this->glitch_buffer, nullptr);
+            this->glitch_buffer = nullptr;
+            this->glitch_capacity = 0;
+        }
+        this->logical_device.destroyPipeline(this->perturbation_pipeline, nullptr);
+        this->logical_device.destroyPipelineLayout(this->perturbation_pipeline_layout, nullptr);
+        this->logical_device.destroyShaderModule(this->perturbation_shader_module, nullptr);
+        this->logical_device.destroyDescriptorSetLayout(this->perturbation_descriptor_set_layout, nullptr);
+        this->perturbation_pipeline = nullptr;
+    }
+    if (this->double_single_pipeline)
+    {
+        this->logical_device.destroyPipeline(this->double_single_pipeline, nullptr);
+        this->logical_device.destroyPipelineLayout(this->double_single_pipeline_layout, nullptr);
+        this->logical_device.destroyShaderModule(this->double_single_shader_module, nullptr);
+        this->double_single_pipeline = nullptr;
+    }
+    if (this->double_pipeline)
+    {
+        this->logical_device.destroyPipeline(this->double_pipeline, nullptr);
+        this->logical_device.destroyPipelineLayout(this->double_pipeline_layout, nullptr);
+        this->logical_device.destroyShaderModule(this->double_shader_module, nullptr);
+        this->double_pipeline = nullptr;
+    }
+    if (this->colorize_pipeline)
+    {
+        if (this->color_buffer)
+        {
+            this->logical_device.freeMemory(this->color_memory, nullptr);
+            this->logical_device.destroyBuffer(this->color_buffer, nullptr);
+            this->color_buffer = nullptr;
+            this->color_capacity = 0;
+        }
+        if (this->histogram_buffer)
+        {
+            this->logical_device.freeMemory(this->histogram_memory, nullptr);
+            this->logical_device.destroyBuffer(this->histogram_buffer, nullptr);
+            this->logical_device.freeMemory(this->cdf_memory, nullptr);
+            this->logical_device.destroyBuffer(this->cdf_buffer, nullptr);
+            this->histogram_buffer = nullptr;
+            this->cdf_buffer = nullptr;
+            this->histogram_capacity = 0;
+        }
+        this->logical_device.destroyPipeline(this->colorize_pipeline, nullptr);
+        this->logical_device.destroyPipelineLayout(this->colorize_pipeline_layout, nullptr);
+        this->logical_device.destroyShaderModule(this->colorize_shader_module, nullptr);
+        this->logical_device.destroyDescriptorSetLayout(this->colorize_descriptor_set_layout, nullptr);
+        this->colorize_pipeline = nullptr;
+    }
+    if (this->supersample_pipeline)
+    {
+        if (this->counts_buffer)
+        {
+            this->logical_device.freeMemory(this->counts_memory, nullptr);
+            this->logical_device.destroyBuffer(this->counts_buffer, nullptr);
+            this->logical_device.freeMemory(this->refined_memory, nullptr);
+            this->logical_device.destroyBuffer(this->refined_buffer, nullptr);
+            this->counts_buffer = nullptr;
+            this->refined_buffer = nullptr;
+            this->supersample_capacity = 0;
+        }
+        this->logical_device.destroyPipeline(this->supersample_pipeline, nullptr);
+        this->logical_device.destroyPipelineLayout(this->supersample_pipeline_layout, nullptr);
+        this->logical_device.destroyShaderModule(this->supersample_shader_module, nullptr);
+        this->logical_device.destroyDescriptorSetLayout(this->supersample_descriptor_set_layout, nullptr);
+        this->supersample_pipeline = nullptr;
+    }
     this->logical_device.destroyShaderModule(this->compute_shader_module, nullptr);
     this->logical_device.destroyDescriptorPool(this-> descriptor_pool, nullptr);
     this->logical_device.destroyDescriptorSetLayout( this->descriptor_set_layout, nullptr);
     this->logical_device.destroyPipeline(this->pipeline, nullptr);
+    this->logical_device.destroyPipelineLayout(this->pipeline_layout, nullptr);
     this->logical_device.destroyCommandPool( this->command_pool, nullptr);
     this->logical_device.destroy();
     this->instance.destroy();
@@ -483,88 +786,458 @@ ComputingPipeline::clean_up()
 // ====================================================================================================================
 void ComputingPipeline::cpu_computation()
 {
-    std::vector<Pixel> mandelbrot(width * height);
-    std::cout << "mandelbrot address : " << mandelbrot.data() << std::endl;
-    auto beg_time = std::chrono::high_resolution_clock::now();
-#   pragma omp parallel for schedule(dynamic)
-    for (int i = 0; i < height; ++i)
+    auto const& view = this->view;
+    const int width = view.width, height = view.height, M = view.max_iter;
+    // Image au format output_format, rangée dans des mots de 4 octets comme dans le buffer de stockage du GPU
+    std::vector<uint32_t> mandelbrot(mandelbrot::image_size_in_bytes(this->output_format, std::size_t(width) * std::size_t(height))/sizeof(uint32_t));
+    std::vector<int>      iterations(width * height);
+    std::cout << "mandelbrot address : " << mandelbrot.data() << " (format " << mandelbrot::output_format_name(this->output_format)
+              << ", " << mandelbrot.size()*sizeof(uint32_t)/(1024*1024) << " Mo)" << std::endl;
+    auto isa = mandelbrot::detect_isa();
+    std::cout << "Jeu d'instructions utilisé : " << mandelbrot::isa_name(isa) << std::endl;
+
+    if (not this->fractal.is_standard())
     {
-        float y = float(i)/float(height);
-        for (int j = 0; j < width; ++j)
+        // Autre fractale de la famille : noyau générique spécialisé à la compilation (pas de noyau vectoriel ni de
+        // comparaison aux autres méthodes, propres à l'ensemble de mandelbrot usuel)
+        auto beg_family = std::chrono::high_resolution_clock::now();
+        long long family_work;
+        if (this->smooth_coloring || this->distance_estimation)
         {
-            float n  = 0.f;
-            float x  = float(j)/float(width);
-            float cx = -0.445f + (x-0.5f)*(2.f + 1.7f*0.2f);
-            float cy =  0.0f   + (y-0.5f)*(2.f + 1.7f*0.2f);
-            float zr =  0.0f;
-            float zi =  0.0f;
-
-            constexpr const int M = 512;
-            for (int iter=0; iter < M; ++iter)
-            {
-                float temp = zr*zr - zi*zi + cx;
-                zi = 2*zr*zi + cy;
-                zr = temp;
-                if (zi*zi + zr*zr > 2) break;
-                n += 1;
-            }
-            float t = float(n)/float(M);
-            float d[] = {0.3, 0.3, 0.5};
-            float e[] = {-0.2, -0.3 ,-0.5};
-            float f[] = {2.1, 2.0, 3.0};
-            float g[] = {0.0, 0.1, 0.0};
-            mandelbrot[i*width+j].r = d[0] + e[0]*std::cos(6.28318f*(f[0]*t+g[0]));
-            mandelbrot[i*width+j].g = d[1] + e[1]*std::cos(6.28318f*(f[1]*t+g[1]));
-            mandelbrot[i*width+j].b = d[2] + e[2]*std::cos(6.28318f*(f[2]*t+g[2]));
-            mandelbrot[i*width+j].a = 1.f;
+            std::vector<float> smooth_iterations(width * height);
+            family_work = mandelbrot::compute_iterations_family(this->fractal, view, this->shortcuts, smooth_iterations.data());
+            mandelbrot::store_image(this->output_format, width * height, M, smooth_iterations.data(), mandelbrot.data());
         }
+        else
+        {
+            family_work = mandelbrot::compute_iterations_family(this->fractal, view, this->shortcuts, iterations.data());
+            mandelbrot::store_image(this->output_format, width * height, M, iterations.data(), mandelbrot.data());
+        }
+        auto end_family = std::chrono::high_resolution_clock::now();
+        std::cout << "Temps calcul " << mandelbrot::fractal_name(this->fractal.kind) << " (puissance " << this->fractal.power
+                  << ") sur cpu = " << std::chrono::duration<double, std::milli>(end_family - beg_family).count() << "[ms], "
+                  << family_work << " itérations calculées" << std::endl;
+        save_image(mandelbrot.data(), width, height, this->output_format, "mandelbrot_cpu.png", M);
+        return;
     }
+
+    // Coloration continue et estimation de distance : les noyaux vectoriels calculent mu (et la dérivée dz/dc) dans la
+    // même passe que les nombres d'itérations entiers (gardés pour les vérifications et les comparaisons qui suivent)
+    const bool smooth_pass   = (this->smooth_coloring || this->distance_estimation) && not this->subdivision;
+    const bool distance_pass = this->distance_estimation && not this->subdivision;
+    std::vector<float> smooth_iterations(smooth_pass ? width * height : 0), distances(distance_pass ? width * height : 0);
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    long long work;
+    if (this->subdivision)
+        work = mandelbrot::compute_iterations_subdivision(view, this->shortcuts, iterations.data());
+    else if (distance_pass)
+        work = mandelbrot::compute_distance_estimates(isa, view, this->shortcuts, iterations.data(), smooth_iterations.data(),
+                                                      distances.data());
+    else if (smooth_pass)
+        work = mandelbrot::compute_iterations_smooth(isa, view, this->shortcuts, iterations.data(), smooth_iterations.data());
+    else
+        work = mandelbrot::compute_iterations(isa, view, this->shortcuts, iterations.data());
+    auto end_iter_time = std::chrono::high_resolution_clock::now();
+    if (distance_pass)
+        mandelbrot::store_image(this->output_format, width * height, M, smooth_iterations.data(), distances.data(), mandelbrot.data());
+    else if (smooth_pass)
+        mandelbrot::store_image(this->output_format, width * height, M, smooth_iterations.data(), mandelbrot.data());
+    else
+        mandelbrot::store_image(this->output_format, width * height, M, iterations.data(), mandelbrot.data());
     auto end_time = std::chrono::high_resolution_clock::now();
-    std::cout << "Temps calcul mandelbrot sur cpu = " << std::chrono::duration<double, std::milli>(end_time - beg_time).count() << "[ms]" << std::endl;
+    double iter_time = std::chrono::duration<double, std::milli>(end_iter_time - beg_time).count();
+    std::cout << "Temps calcul mandelbrot sur cpu" << (this->subdivision ? " (subdivision de Mariani-Silver)" : "")
+              << " = " << std::chrono::duration<double, std::milli>(end_time - beg_time).count() << "[ms]"
+              << " dont itérations" << (distance_pass ? " avec estimation de distance" : smooth_pass ? " continues" : "")
+              << " : " << iter_time << "[ms] et coloration" << (smooth_pass ? " continue : " : " (palette précalculée) : ")
+              << std::chrono::duration<double, std::milli>(end_time - end_iter_time).count() << "[ms]" << std::endl;
+
+    if (this->subdivision)
+    {
+        // Vérification : la subdivision ne remplit que des rectangles de la cardioïde ou du bourgeon et doit donner
+        // exactement les mêmes nombres d'itérations que le calcul pixel par pixel
+        std::vector<int> pixel_iterations(width * height);
+        auto beg_pixel = std::chrono::high_resolution_clock::now();
+        long long pixel_work = mandelbrot::compute_iterations(isa, view, this->shortcuts, pixel_iterations.data());
+        auto end_pixel = std::chrono::high_resolution_clock::now();
+        double pixel_time = std::chrono::duration<double, std::milli>(end_pixel - beg_pixel).count();
+        long nb_differences = 0;
+        for (int i = 0; i < width * height; ++i)
+            if (iterations[i] != pixel_iterations[i]) ++nb_differences;
+        std::cout << "Temps itérations pixel par pixel (" << mandelbrot::isa_name(isa) << ") = " << pixel_time
+                  << "[ms], itérations calculées : " << pixel_work << " au lieu de " << work << " par subdivision ("
+                  << 100.*double(pixel_work - work)/double(pixel_work) << "% économisées)" << std::endl;
+        if (nb_differences == 0)
+            std::cout << "Nombres d'itérations identiques au calcul pixel par pixel" << std::endl;
+        else
+            std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << nb_differences
+                      << " pixels ont un nombre d'itérations différent du calcul pixel par pixel" << std::endl;
+    }
+    else if (isa != mandelbrot::Isa::scalar)
+    {
+        // Vérification : les noyaux vectoriels doivent donner exactement les mêmes nombres d'itérations que le noyau scalaire
+        std::vector<int> scalar_iterations(width * height);
+        auto beg_scalar = std::chrono::high_resolution_clock::now();
+        mandelbrot::compute_iterations(mandelbrot::Isa::scalar, view, this->shortcuts, scalar_iterations.data());
+        auto end_scalar = std::chrono::high_resolution_clock::now();
+        double scalar_time = std::chrono::duration<double, std::milli>(end_scalar - beg_scalar).count();
+        long nb_differences = 0;
+        for (int i = 0; i < width * height; ++i)
+            if (iterations[i] != scalar_iterations[i]) ++nb_differences;
+        std::cout << "Temps itérations scalaires = " << scalar_time << "[ms], accélération " << mandelbrot::isa_name(isa)
+                  << " : " << scalar_time/iter_time << std::endl;
+        if (nb_differences == 0)
+            std::cout << "Nombres d'itérations identiques au calcul scalaire" << std::endl;
+        else
+            std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << nb_differences
+                      << " pixels ont un nombre d'itérations différent du calcul scalaire" << std::endl;
+    }
+
+    if (this->verification)
+    {
+        // Vérification du noyau générique des familles de fractales : son instanciation pour l'ensemble de mandelbrot
+        // usuel doit donner les mêmes nombres d'itérations que les noyaux dédiés, aussi vite que le noyau scalaire
+        std::vector<int> family_iterations(width * height);
+        auto beg_family = std::chrono::high_resolution_clock::now();
+        mandelbrot::compute_iterations_family(this->fractal, view, this->shortcuts, family_iterations.data());
+        auto end_family = std::chrono::high_resolution_clock::now();
+        long nb_differences = 0;
+        for (int i = 0; i < width * height; ++i)
+            if (iterations[i] != family_iterations[i]) ++nb_differences;
+        std::cout << "Temps itérations par le noyau générique (familles de fractales) = "
+                  << std::chrono::duration<double, std::milli>(end_family - beg_family).count() << "[ms]" << std::endl;
+        if (nb_differences == 0)
+            std::cout << "Nombres d'itérations identiques avec le noyau générique" << std::endl;
+        else
+            std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << nb_differences
+                      << " pixels ont un nombre d'itérations différent avec le noyau générique" << std::endl;
+    }
+
+    if (this->shortcuts != mandelbrot::no_shortcut)
+    {
+        // Comparaison au calcul brut (sans raccourci) : itérations économisées, accélération et pixels modifiés
+        std::vector<int> brute_iterations(width * height);
+        auto beg_brute = std::chrono::high_resolution_clock::now();
+        long long brute_work = mandelbrot::compute_iterations(isa, view, mandelbrot::no_shortcut, brute_iterations.data());
+        auto end_brute = std::chrono::high_resolution_clock::now();
+        double brute_time = std::chrono::duration<double, std::milli>(end_brute - beg_brute).count();
+        long nb_differences = 0;
+        for (int i = 0; i < width * height; ++i)
+            if (iterations[i] != brute_iterations[i]) ++nb_differences;
+        std::cout << "Temps itérations sans raccourci = " << brute_time << "[ms], accélération due aux raccourcis : "
+                  << brute_time/iter_time << std::endl;
+        std::cout << "Itérations calculées : " << work << " au lieu de " << brute_work << " ("
+                  << 100.*double(brute_work - work)/double(brute_work) << "% économisées)" << std::endl;
+        std::cout << nb_differences << " pixels ont un nombre d'itérations différent du calcul sans raccourci" << std::endl;
+    }
+
+    if (this->subdivision && (this->smooth_coloring || this->distance_estimation))
+    {
+        // La subdivision ne remplit que des nombres d'itérations entiers : avec la coloration continue ou l'estimation de
+        // distance, l'image sauvegardée est recalculée pixel par pixel
+        std::vector<int> pixel_iterations(width * height);
+        smooth_iterations.resize(width * height);
+        auto beg_smooth = std::chrono::high_resolution_clock::now();
+        if (this->distance_estimation)
+        {
+            distances.resize(width * height);
+            mandelbrot::compute_distance_estimates(isa, view, this->shortcuts, pixel_iterations.data(), smooth_iterations.data(),
+                                                   distances.data());
+            mandelbrot::store_image(this->output_format, width * height, M, smooth_iterations.data(), distances.data(), mandelbrot.data());
+        }
+        else
+        {
+            mandelbrot::compute_iterations_smooth(isa, view, this->shortcuts, pixel_iterations.data(), smooth_iterations.data());
+            mandelbrot::store_image(this->output_format, width * height, M, smooth_iterations.data(), mandelbrot.data());
+        }
+        auto end_smooth = std::chrono::high_resolution_clock::now();
+        std::cout << "Temps itérations continues et coloration pixel par pixel = "
+                  << std::chrono::duration<double, std::milli>(end_smooth - beg_smooth).count() << "[ms]" << std::endl;
+    }
+
+    if (this->distance_estimation)
+    {
+        // Pixels à moins d'un pixel du bord : les seuls qu'un suréchantillonnage aurait besoin de raffiner
+        long long nb_boundary = 0, nb_interior = 0;
+        for (int i = 0; i < width * height; ++i)
+        {
+            if (distances[i] < 0.f) ++nb_interior;
+            else if (distances[i] < 1.f) ++nb_boundary;
+        }
+        std::cout << nb_boundary << " pixels à moins d'un pixel du bord ("
+                  << 100.*double(nb_boundary)/double(width * height) << "%), " << nb_interior
+                  << " pixels n'ayant pas divergé" << std::endl;
+    }
 
     auto beg_time2 = std::chrono::high_resolution_clock::now();
-    save_rendered_image(mandelbrot.data(), "mandelbrot_cpu.png");
+    save_image(mandelbrot.data(), width, height, this->output_format, "mandelbrot_cpu.png", M);
     auto end_time2 = std::chrono::high_resolution_clock::now();
     std::cout << "Temps enregistrement mandelbrot cpu = " << std::chrono::duration<double, std::milli>(end_time2 - beg_time2).count() << "[ms]" << std::endl;
 }
 // --------------------------------------------------------------------------------------------------------------------
-void
-ComputingPipeline::run()
+void ComputingPipeline::cpu_recolor_computation(std::vector<mandelbrot::Coloring> const& colorings)
+{
+    auto const& view = this->view;
+    const int width = view.width, height = view.height, M = view.max_iter;
+    std::vector<float>    map(width * height);
+    std::vector<uint32_t> image(width * height);
+
+    // Première passe : carte des nombres d'itérations (calculée une seule fois)
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    std::vector<int> iterations(width * height);
+    if (this->smooth_coloring)
+        mandelbrot::compute_iterations_smooth(mandelbrot::detect_isa(), view, this->shortcuts, iterations.data(), map.data());
+    else
+    {
+        mandelbrot::compute_iterations(mandelbrot::detect_isa(), view, this->shortcuts, iterations.data());
+        mandelbrot::store_image(mandelbrot::OutputFormat::iteration_map, width * height, M, iterations.data(), map.data());
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Temps calcul de la carte des nombres d'itérations sur cpu = "
+              << std::chrono::duration<double, std::milli>(end_time - beg_time).count() << "[ms]" << std::endl;
+
+    // Seconde passe : une mise en couleur par jeu de paramètres, à partir de la même carte
+    for (std::size_t k = 0; k < colorings.size(); ++k)
+    {
+        auto beg_color = std::chrono::high_resolution_clock::now();
+        mandelbrot::colorize_map(colorings[k], width * height, M, map.data(), image.data());
+        auto end_color = std::chrono::high_resolution_clock::now();
+        std::cout << "Temps mise en couleur sur cpu ("
+                  << (colorings[k].mapping == mandelbrot::ColorMapping::equalized ? "égalisation d'histogramme" : "linéaire")
+                  << ", densité " << colorings[k].density << ") = "
+                  << std::chrono::duration<double, std::milli>(end_color - beg_color).count() << "[ms]" << std::endl;
+        save_image(image.data(), width, height, mandelbrot::OutputFormat::rgba8, "mandelbrot_cpu_couleurs_" + std::to_string(k + 1) + ".png");
+    }
+}
+// --------------------------------------------------------------------------------------------------------------------
+void ComputingPipeline::cpu_antialiased_computation(int samples)
+{
+    auto const& view = this->view;
+    const int width = view.width, height = view.height;
+    const long long nb_pixels = (long long)width * height;
+    auto isa = mandelbrot::detect_isa();
+    std::vector<uint32_t> image(width * height), uniform_image(width * height);
+
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    auto report = mandelbrot::compute_antialiased(isa, view, this->shortcuts, samples, image.data());
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+    std::cout << "Temps anticrénelage adaptatif " << samples << "x" << samples << " sur cpu = " << time << "[ms], "
+              << report.nb_refined << " pixels suréchantillonnés (" << 100.*double(report.nb_refined)/double(nb_pixels)
+              << "%), " << report.nb_samples << " points et " << report.work << " itérations calculés" << std::endl;
+
+    // Comparaison au suréchantillonnage uniforme (tous les pixels)
+    beg_time = std::chrono::high_resolution_clock::now();
+    auto uniform_report = mandelbrot::compute_antialiased(isa, view, this->shortcuts, samples, uniform_image.data(), false);
+    end_time = std::chrono::high_resolution_clock::now();
+    double uniform_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+    long nb_differences = 0;
+    for (long long p = 0; p < nb_pixels; ++p)
+        if (image[p] != uniform_image[p]) ++nb_differences;
+    std::cout << "Temps suréchantillonnage uniforme " << samples << "x" << samples << " sur cpu = " << uniform_time << "[ms], "
+              << uniform_report.work << " itérations calculées" << std::endl;
+    std::cout << "Coût de l'anticrénelage adaptatif par rapport au suréchantillonnage uniforme : " << 100.*time/uniform_time
+              << "% du temps, " << 100.*double(report.work)/double(uniform_report.work) << "% des itérations. "
+              << nb_differences << " pixels de couleur différente" << std::endl;
+    save_image(image.data(), width, height, mandelbrot::OutputFormat::rgba8, "mandelbrot_cpu_anticrenelage.png");
+}
+// --------------------------------------------------------------------------------------------------------------------
+void ComputingPipeline::cpu_resume_computation(int max_iter)
+{
+    auto view = this->view;
+    const int width = view.width, height = view.height;
+    auto isa = mandelbrot::detect_isa();
+    std::vector<int> iterations(width * height);
+    mandelbrot::ResumeState state;
+
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    long long first_work = mandelbrot::compute_iterations_resumable(isa, view, state, iterations.data());
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Calcul jusqu'à " << view.max_iter << " itérations : " << std::chrono::duration<double, std::milli>(end_time - beg_time).count()
+              << "[ms], " << first_work << " itérations calculées, " << state.index.size() << " pixels encore actifs" << std::endl;
+
+    view.max_iter = max_iter;
+    beg_time = std::chrono::high_resolution_clock::now();
+    long long resume_work = mandelbrot::compute_iterations_resumable(isa, view, state, iterations.data());
+    end_time = std::chrono::high_resolution_clock::now();
+    double resume_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+    std::cout << "Reprise jusqu'à " << max_iter << " itérations : " << resume_time << "[ms], " << resume_work
+              << " itérations calculées, " << state.index.size() << " pixels encore actifs" << std::endl;
+
+    // Comparaison avec un calcul complet de tous les pixels depuis z = 0
+    std::vector<int> brute_iterations(width * height);
+    beg_time = std::chrono::high_resolution_clock::now();
+    long long brute_work = mandelbrot::compute_iterations(isa, view, mandelbrot::no_shortcut, brute_iterations.data());
+    end_time = std::chrono::high_resolution_clock::now();
+    double brute_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+    long nb_differences = 0;
+    for (int i = 0; i < width * height; ++i)
+        if (iterations[i] != brute_iterations[i]) ++nb_differences;
+    std::cout << "Calcul complet jusqu'à " << max_iter << " itérations : " << brute_time << "[ms], " << brute_work
+              << " itérations calculées. Accélération de la reprise : " << brute_time/resume_time << std::endl;
+    if (nb_differences == 0)
+        std::cout << "Nombres d'itérations identiques au calcul complet" << std::endl;
+    else
+        std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << nb_differences
+                  << " pixels ont un nombre d'itérations différent du calcul complet" << std::endl;
+
+    std::vector<Pixel> mandelbrot(width * height);
+    mandelbrot::colorize(width * height, max_iter, iterations.data(), mandelbrot.data());
+    save_rendered_image(mandelbrot.data(), width, height, "mandelbrot_cpu_reprise.png");
+}
+// --------------------------------------------------------------------------------------------------------------------
+void ComputingPipeline::cpu_perturbation_computation(mandelbrot::DeepView const& view)
 {
-    using namespace std::chrono_literals;
-    // Calcul de la taille du buffer à réserver pour le GPU afin de rendre l'ensemble de mandelbrot
-    this->buffer_size = width * height * sizeof(Pixel);
+    const int width = view.width, height = view.height;
+    auto isa = mandelbrot::detect_isa();
+    std::vector<int> iterations(width * height);
+
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    auto orbit = mandelbrot::compute_reference_orbit(view);
+    auto end_orbit_time = std::chrono::high_resolution_clock::now();
+    auto stats = mandelbrot::compute_iterations_perturbation(isa, view, orbit, iterations.data());
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double iter_time = std::chrono::duration<double, std::milli>(end_time - end_orbit_time).count();
+    long long nb_iterations = 0;
+    for (int i = 0; i < width * height; ++i) nb_iterations += iterations[i];
+    std::cout << "Orbite de référence (" << orbit.length() << " points) : "
+              << std::chrono::duration<double, std::milli>(end_orbit_time - beg_time).count() << "[ms]" << std::endl;
+    std::cout << "Temps itérations par perturbation (" << mandelbrot::isa_name(isa) << ") = " << iter_time << "[ms], "
+              << double(nb_iterations)/(iter_time*1.E6) << " G itérations/s, " << stats.rebases << " rebasements" << std::endl;
+    std::cout << "Pixels glitchés : " << stats.nb_glitched << ", recalculés avec " << stats.nb_secondary
+              << " orbites secondaires (" << stats.nb_unresolved << " calculés sans détection)" << std::endl;
+    if (stats.nb_unresolved > 0)
+        std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << stats.nb_unresolved
+                  << " pixels glitchés n'ont pu être recalculés avec une orbite secondaire" << std::endl;
+
+    if (isa != mandelbrot::Isa::scalar)
+    {
+        std::vector<int> scalar_iterations(width * height);
+        mandelbrot::compute_iterations_perturbation(mandelbrot::Isa::scalar, view, orbit, scalar_iterations.data());
+        long nb_differences = 0;
+        for (int i = 0; i < width * height; ++i)
+            if (iterations[i] != scalar_iterations[i]) ++nb_differences;
+        if (nb_differences == 0)
+            std::cout << "Nombres d'itérations identiques au calcul scalaire" << std::endl;
+        else
+            std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << nb_differences
+                      << " pixels ont un nombre d'itérations différent du calcul scalaire" << std::endl;
+    }
+
+    {
+        // Vérification sur une grille de 16x16 pixels : calcul direct de la suite en précision étendue (lent)
+        constexpr const int nb_samples = 16;
+        int nb_exact = 0, nb_close = 0, max_deviation = 0;
+#       pragma omp parallel for schedule(dynamic) reduction(+:nb_exact,nb_close) reduction(max:max_deviation)
+        for (int s = 0; s < nb_samples*nb_samples; ++s)
+        {
+            int si = s / nb_samples, sj = s % nb_samples;
+            int i = (2*si + 1) * height / (2*nb_samples), j = (2*sj + 1) * width / (2*nb_samples);
+            int exact = mandelbrot::iterations_extended_precision(view, i, j);
+            int deviation = std::abs(iterations[i*width+j] - exact);
+            if (deviation == 0) ++nb_exact;
+            if (deviation <= exact/100) ++nb_close;
+            max_deviation = std::max(max_deviation, deviation);
+        }
+        std::cout << "Comparaison au calcul en précision étendue sur " << nb_samples*nb_samples << " pixels : "
+                  << 100.*nb_exact/(nb_samples*nb_samples) << "% identiques, "
+                  << 100.*nb_close/(nb_samples*nb_samples) << "% à moins de 1% près, écart maximal de "
+                  << max_deviation << " itérations" << std::endl;
+    }
 
-    // Initialisation et configuration de Vulkan :
+    std::vector<Pixel> mandelbrot(width * height);
+    mandelbrot::colorize(width * height, view.max_iter, iterations.data(), mandelbrot.data());
+    save_rendered_image(mandelbrot.data(), width, height, "mandelbrot_cpu_profond.png");
+}
+// --------------------------------------------------------------------------------------------------------------------
+long long ComputingPipeline::cpu_precision_computation(mandelbrot::PreciseView const& view)
+{
+    using mandelbrot::Precision;
+    const int width = view.width, height = view.height;
+    std::array<std::vector<int>, 3> iterations;
+    std::array<long long, 3> work;
+    for (int p = 2; p >= 0; --p)
+    {
+        // Le calcul en double (le plus précis) est fait en premier : il sert de référence aux deux autres
+        Precision precision = Precision(p);
+        iterations[p].resize(width * height);
+        auto beg_time = std::chrono::high_resolution_clock::now();
+        work[p] = mandelbrot::compute_iterations_precise(precision, view, iterations[p].data());
+        auto end_time = std::chrono::high_resolution_clock::now();
+        double time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+        long nb_differences = 0;
+        for (int i = 0; i < width * height; ++i)
+            if (iterations[p][i] != iterations[2][i]) ++nb_differences;
+        std::cout << "Arithmétique " << mandelbrot::precision_name(precision)
+                  << (mandelbrot::is_precise_enough(precision, view) ? "" : " (insuffisante pour cette fenêtre)") << " : "
+                  << time << "[ms], " << double(work[p])/(time*1.E6) << " G itérations/s, " << nb_differences
+                  << " pixels différents du calcul en double" << std::endl;
+    }
+    int chosen = 2;
+    for (int p = 1; p >= 0; --p)
+        if (mandelbrot::is_precise_enough(Precision(p), view)) chosen = p;
+    std::vector<Pixel> mandelbrot(width * height);
+    mandelbrot::colorize(width * height, view.max_iter, iterations[chosen].data(), mandelbrot.data());
+    save_rendered_image(mandelbrot.data(), width, height, "mandelbrot_cpu_precision.png");
+    return work[2];
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::initialize()
+{
+    // Initialisation et configuration de Vulkan. Le buffer de stockage n'est créé qu'au premier rendu, lorsque sa taille est connue.
     create_instance();
     this->pt_dbg_utils = std::make_unique<vulkan::debug::Utils>(this->instance);
     find_physical_device();
     create_device();
-    create_buffer();
     create_descriptor_set_layout();
     create_descriptor_set();
+    create_palette_buffer();
+    create_tile_counter_buffer();
     create_compute_pipeline();
     create_command_buffer();
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::render(mandelbrot::View const& view)
+{
+    // On agrandit le buffer de stockage si besoin (il n'est jamais réduit) et on le relie de nouveau au descripteur
+    vk::DeviceSize needed_size = mandelbrot::image_size_in_bytes(this->output_format, std::size_t(view.width) * std::size_t(view.height));
+    if (needed_size > this->buffer_size)
+    {
+        create_buffer(needed_size);
+        update_descriptor_set();
+    }
+    this->rendered_view = view;
+    this->rendered_format = this->output_format;
+    record_command_buffer(view);
 
-    // Enfin, on exécute le buffer de command enregistré :
+    // On exécute le buffer de command enregistré :
     auto beg_time = std::chrono::high_resolution_clock::now();
     this->pt_dbg_utils->create_messenger();
     run_command_buffer();
     this->pt_dbg_utils->destroy_messenger();
     auto end_time = std::chrono::high_resolution_clock::now();
-    std::cout << "Temps calcul mandelbrot sur gpu = " << std::chrono::duration<double, std::milli>(end_time - beg_time).count() << "[ms]" << std::endl;
-
+    double gpu_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+    std::cout << "Temps calcul mandelbrot sur gpu (" << view.width << "x" << view.height << ") = " << gpu_time << "[ms]" << std::endl;
+    return gpu_time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::save_gpu_image(std::string const& filename)
+{
     // On sauvegarde l'image calculé dans le buffer en png :
     // mappe la mémoire buffer alors qu'on puisse le lire du CPU :
+    vk::DeviceSize image_size = mandelbrot::image_size_in_bytes(this->rendered_format,
+                                                                std::size_t(this->rendered_view.width) * std::size_t(this->rendered_view.height));
     auto beg_time3 = std::chrono::high_resolution_clock::now();
-    void *mapped_memory = this->logical_device.mapMemory(this->buffer_memory, 0, this->buffer_size);
+    void *mapped_memory = this->logical_device.mapMemory(this->buffer_memory, 0, image_size);
     std::cout << "adresse memoire : " << mapped_memory << std::endl;
     auto end_time3 = std::chrono::high_resolution_clock::now();
     std::cout << "Temps mappage mandelbrot gpu vers CPU : " << std::chrono::duration<double, std::milli>(end_time3 - beg_time3).count() << "[ms]" << std::endl;
-    //std::this_thread::sleep_for(5s);
     auto beg_time4 = std::chrono::high_resolution_clock::now();
-    Pixel* pmapped_memory = (Pixel *)mapped_memory;
-    save_rendered_image(pmapped_memory, "mandelbrot_gpu.png");
+    save_image(mapped_memory, this->rendered_view.width, this->rendered_view.height, this->rendered_format, filename,
+               this->rendered_view.max_iter);
     auto end_time4 = std::chrono::high_resolution_clock::now();
     std::cout << "Temps sauvegarde mandelbrot gpu : " << std::chrono::duration<double, std::milli>(end_time4 - beg_time4).count() << "[ms]" << std::endl;
     // Une fois fait, on détruit la map entre CPU et buffer :
@@ -572,9 +1245,1620 @@ ComputingPipeline::run()
     this->logical_device.unmapMemory(this->buffer_memory);
     auto end_time2 = std::chrono::high_resolution_clock::now();
     std::cout << "Temps unmappage mandelbrot gpu vs CPU : " << std::chrono::duration<double, std::milli>(end_time2 - beg_time2).count() << "[ms]" << std::endl;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::create_resume_pipeline()
+{
+    // Disposition de l'ensemble de descripteurs du shader resume.comp : image (0), états des pixels (1) et liste des pixels actifs (2)
+    std::array<vk::DescriptorSetLayoutBinding, 3> bindings;
+    for (uint32_t b = 0; b < bindings.size(); ++b)
+        bindings[b].setBinding(b)
+                   .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                   .setDescriptorCount(1)
+                   .setStageFlags(vk::ShaderStageFlagBits::eCompute);
+    vk::DescriptorSetLayoutCreateInfo layout_create_info;
+    layout_create_info.setBindingCount(uint32_t(bindings.size()))
+                      .setPBindings(bindings.data());
+    this->resume_descriptor_set_layout = this->logical_device.createDescriptorSetLayout(layout_create_info, nullptr);
+
+    // L'ensemble est alloué dans le réservoir créé par create_descriptor_set (prévu pour nos deux ensembles)
+    vk::DescriptorSetAllocateInfo descriptor_set_allocate_info;
+    descriptor_set_allocate_info.setDescriptorPool(this->descriptor_pool)
+                                .setDescriptorSetCount(1)
+                                .setPSetLayouts(&this->resume_descriptor_set_layout);
+    this->resume_descriptor_set = this->logical_device.allocateDescriptorSets(descriptor_set_allocate_info)[0];
+
+    // Le code compilé a été obtenu par : glslangValidator -V resume.comp -o resume.spv
+    auto code = __details__::read_file("shaders/resume.spv");
+    vk::ShaderModuleCreateInfo create_info;
+    create_info.setPCode(code.data())
+               .setCodeSize(sizeof(uint32_t)*code.size());
+    this->resume_shader_module = this->logical_device.createShaderModule(create_info, nullptr);
+
+    vk::PipelineShaderStageCreateInfo shader_stage_create_info;
+    shader_stage_create_info.setStage(vk::ShaderStageFlagBits::eCompute)
+                            .setModule(this->resume_shader_module)
+                            .setPName("main");
+    vk::PushConstantRange push_constant_range;
+    push_constant_range.setStageFlags(vk::ShaderStageFlagBits::eCompute)
+                       .setOffset(0)
+                       .setSize(sizeof(ResumeParameters));
+    vk::PipelineLayoutCreateInfo pipeline_layout_create_info;
+    pipeline_layout_create_info.setSetLayoutCount(1)
+                               .setPSetLayouts(&this->resume_descriptor_set_layout)
+                               .setPushConstantRangeCount(1)
+                               .setPPushConstantRanges(&push_constant_range);
+    this->resume_pipeline_layout = this->logical_device.createPipelineLayout(pipeline_layout_create_info, nullptr);
+
+    std::vector<vk::ComputePipelineCreateInfo> pipeline_create_infos(1);
+    pipeline_create_infos[0].setStage(shader_stage_create_info);
+    pipeline_create_infos[0].setLayout(this->resume_pipeline_layout);
+    auto pipelines = this->logical_device.createComputePipelines(vk::PipelineCache{nullptr}, pipeline_create_infos);
+    this->resume_pipeline = pipelines.value[0];
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::update_resume_descriptor_set()
+{
+    std::array<vk::DescriptorBufferInfo, 3> buffer_infos;
+    buffer_infos[0].setBuffer(this->buffer).setOffset(0).setRange(this->buffer_size);
+    buffer_infos[1].setBuffer(this->state_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    buffer_infos[2].setBuffer(this->active_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    std::array<vk::WriteDescriptorSet, 3> writes;
+    for (uint32_t b = 0; b < writes.size(); ++b)
+        writes[b].setDstSet(this->resume_descriptor_set)
+                 .setDstBinding(b)
+                 .setDescriptorCount(1)
+                 .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                 .setPBufferInfo(&buffer_infos[b]);
+    this->logical_device.updateDescriptorSets(uint32_t(writes.size()), writes.data(), 0, nullptr);
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::render_resumable(mandelbrot::View const& view)
+{
+    if (not this->resume_pipeline) create_resume_pipeline();
+    auto const& old = this->resume_view;
+    bool resume = (old.width == view.width && old.height == view.height && old.center_x == view.center_x &&
+                   old.center_y == view.center_y && old.extent == view.extent && old.max_iter <= view.max_iter &&
+                   old.max_iter > 0);
+
+    // Agrandissement éventuel des buffers : image, états (16 octets par pixel) et liste active (compteur + deux listes).
+    // L'image étant le buffer du rendu principal (qui a pu être recréé), l'ensemble de descripteurs est relié de nouveau
+    // à chaque appel
+    const uint32_t nb_pixels = uint32_t(view.width) * uint32_t(view.height);
+    vk::DeviceSize needed_size = vk::DeviceSize(nb_pixels) * sizeof(Pixel);
+    if (needed_size > this->buffer_size)
+    {
+        create_buffer(needed_size);
+        update_descriptor_set();
+    }
+    if (nb_pixels > this->resume_capacity)
+    {
+        allocate_buffer(vk::DeviceSize(nb_pixels) * 4 * sizeof(uint32_t), vk::BufferUsageFlagBits::eStorageBuffer,
+                        this->state_buffer, this->state_memory);
+        allocate_buffer((1 + 2 * vk::DeviceSize(nb_pixels)) * sizeof(uint32_t),
+                        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                        this->active_buffer, this->active_memory);
+        this->resume_capacity = nb_pixels;
+        resume = false; // Les états ont été perdus
+    }
+    update_resume_descriptor_set();
+    if (resume && this->nb_active == 0)
+    {
+        // Tous les pixels ont divergé : seule la palette (qui dépend de max_iter) change
+        std::cout << "Aucun pixel actif à reprendre" << std::endl;
+    }
+
+    ResumeParameters parameters{view, resume ? 1u : 0u, resume ? this->nb_active : 0u, this->active_in_offset,
+                                this->active_in_offset == 0 ? nb_pixels : 0u};
+    const uint32_t nb_threads = resume ? this->nb_active : nb_pixels;
+
+    // Enregistrement : remise à zéro du compteur, itérations (premier calcul ou reprise), puis coloration de tous les pixels
+    this->command_buffer.reset();
+    vk::CommandBufferBeginInfo begin_info;
+    begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    this->command_buffer.begin(begin_info);
+    this->command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->resume_pipeline);
+    this->command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, this->resume_pipeline_layout, 0, 1, &this->resume_descriptor_set, 0, nullptr);
+    this->command_buffer.fillBuffer(this->active_buffer, 0, sizeof(uint32_t), 0);
+    vk::MemoryBarrier fill_barrier;
+    fill_barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+    this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+                                         1, &fill_barrier, 0, nullptr, 0, nullptr);
+    if (nb_threads > 0)
+    {
+        this->command_buffer.pushConstants(this->resume_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(ResumeParameters), &parameters);
+        this->command_buffer.dispatch((nb_threads + resume_workgroup_size - 1)/resume_workgroup_size, 1, 1);
+    }
+    vk::MemoryBarrier compute_barrier;
+    compute_barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+                   .setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+    this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {},
+                                         1, &compute_barrier, 0, nullptr, 0, nullptr);
+    ResumeParameters color_parameters = parameters;
+    color_parameters.mode = 2;
+    this->command_buffer.pushConstants(this->resume_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(ResumeParameters), &color_parameters);
+    this->command_buffer.dispatch((nb_pixels + resume_workgroup_size - 1)/resume_workgroup_size, 1, 1);
+    // Les écritures du shader doivent être visibles par l'hôte (lecture du compteur et de l'image)
+    vk::MemoryBarrier host_barrier;
+    host_barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eHostRead);
+    this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost, {},
+                                         1, &host_barrier, 0, nullptr, 0, nullptr);
+    this->command_buffer.end();
+
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    this->pt_dbg_utils->create_messenger();
+    run_command_buffer();
+    this->pt_dbg_utils->destroy_messenger();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double gpu_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+
+    // Lecture du nombre de pixels encore actifs : la liste de sortie devient la liste d'entrée de la prochaine reprise
+    void* mapped_counter = this->logical_device.mapMemory(this->active_memory, 0, VK_WHOLE_SIZE);
+    vk::MappedMemoryRange counter_range;
+    counter_range.setMemory(this->active_memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+    this->logical_device.invalidateMappedMemoryRanges(counter_range);
+    this->nb_active = *(uint32_t*)mapped_counter;
+    this->logical_device.unmapMemory(this->active_memory);
+    this->active_in_offset = parameters.out_offset;
+    this->resume_view = view;
+    this->rendered_view = view;
+    this->rendered_format = mandelbrot::OutputFormat::rgba32f;
+
+    std::cout << (resume ? "Reprise" : "Calcul") << " mandelbrot sur gpu jusqu'à " << view.max_iter << " itérations ("
+              << nb_threads << " pixels calculés, " << this->nb_active << " encore actifs) = " << gpu_time << "[ms]" << std::endl;
+    return gpu_time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::create_perturbation_pipeline()
+{
+    // Disposition de l'ensemble de descripteurs des shaders de perturbation : image (0), palette (1), orbite de
+    // référence (2) et listes de pixels glitchés (3)
+    std::array<vk::DescriptorSetLayoutBinding, 4> bindings;
+    for (uint32_t b = 0; b < bindings.size(); ++b)
+        bindings[b].setBinding(b)
+                   .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                   .setDescriptorCount(1)
+                   .setStageFlags(vk::ShaderStageFlagBits::eCompute);
+    vk::DescriptorSetLayoutCreateInfo layout_create_info;
+    layout_create_info.setBindingCount(uint32_t(bindings.size()))
+                      .setPBindings(bindings.data());
+    this->perturbation_descriptor_set_layout = this->logical_device.createDescriptorSetLayout(layout_create_info, nullptr);
+
+    vk::DescriptorSetAllocateInfo descriptor_set_allocate_info;
+    descriptor_set_allocate_info.setDescriptorPool(this->descriptor_pool)
+                                .setDescriptorSetCount(1)
+                                .setPSetLayouts(&this->perturbation_descriptor_set_layout);
+    this->perturbation_descriptor_set = this->logical_device.allocateDescriptorSets(descriptor_set_allocate_info)[0];
+
+    // Le code compilé a été obtenu par : glslangValidator -V perturbation.comp -o perturbation.spv (de même pour
+    // perturbation_double.comp, dont le module déclare la capacité Float64 et serait refusé sans shaderFloat64)
+    auto code = __details__::read_file(this->float64_supported ? "shaders/perturbation_double.spv" : "shaders/perturbation.spv");
+    vk::ShaderModuleCreateInfo create_info;
+    create_info.setPCode(code.data())
+               .setCodeSize(sizeof(uint32_t)*code.size());
+    this->perturbation_shader_module = this->logical_device.createShaderModule(create_info, nullptr);
 
+    vk::PipelineShaderStageCreateInfo shader_stage_create_info;
+    shader_stage_create_info.setStage(vk::ShaderStageFlagBits::eCompute)
+                            .setModule(this->perturbation_shader_module)
+                            .setPName("main");
+    vk::PushConstantRange push_constant_range;
+    push_constant_range.setStageFlags(vk::ShaderStageFlagBits::eCompute)
+                       .setOffset(0)
+                       .setSize(sizeof(PerturbationParameters));
+    vk::PipelineLayoutCreateInfo pipeline_layout_create_info;
+    pipeline_layout_create_info.setSetLayoutCount(1)
+                               .setPSetLayouts(&this->perturbation_descriptor_set_layout)
+                               .setPushConstantRangeCount(1)
+                               .setPPushConstantRanges(&push_constant_range);
+    this->perturbation_pipeline_layout = this->logical_device.createPipelineLayout(pipeline_layout_create_info, nullptr);
+
+    std::vector<vk::ComputePipelineCreateInfo> pipeline_create_infos(1);
+    pipeline_create_infos[0].setStage(shader_stage_create_info);
+    pipeline_create_infos[0].setLayout(this->perturbation_pipeline_layout);
+    auto pipelines = this->logical_device.createComputePipelines(vk::PipelineCache{nullptr}, pipeline_create_infos);
+    this->perturbation_pipeline = pipelines.value[0];
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::update_perturbation_descriptor_set()
+{
+    std::array<vk::DescriptorBufferInfo, 4> buffer_infos;
+    buffer_infos[0].setBuffer(this->buffer).setOffset(0).setRange(this->buffer_size);
+    buffer_infos[1].setBuffer(this->palette_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    buffer_infos[2].setBuffer(this->orbit_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    buffer_infos[3].setBuffer(this->glitch_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    std::array<vk::WriteDescriptorSet, 4> writes;
+    for (uint32_t b = 0; b < writes.size(); ++b)
+        writes[b].setDstSet(this->perturbation_descriptor_set)
+                 .setDstBinding(b)
+                 .setDescriptorCount(1)
+                 .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                 .setPBufferInfo(&buffer_infos[b]);
+    this->logical_device.updateDescriptorSets(uint32_t(writes.size()), writes.data(), 0, nullptr);
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::render_perturbation(mandelbrot::DeepView const& view)
+{
+    if (not this->perturbation_pipeline) create_perturbation_pipeline();
+
+    auto beg_orbit = std::chrono::high_resolution_clock::now();
+    auto orbit = mandelbrot::compute_reference_orbit(view);
+    auto end_orbit = std::chrono::high_resolution_clock::now();
+    std::cout << "Orbite de référence (" << orbit.length() << " points) calculée sur cpu en "
+              << std::chrono::duration<double, std::milli>(end_orbit - beg_orbit).count() << "[ms]" << std::endl;
+
+    // Agrandissement éventuel de l'image, du buffer de l'orbite (deux doubles par point, deux flottants sans
+    // shaderFloat64 ; une orbite secondaire peut avoir jusqu'à max_iter+1 points) et des listes de pixels glitchés
+    // (compteur + deux listes). L'image étant le buffer du rendu principal (qui a pu être recréé), l'ensemble de
+    // descripteurs est relié de nouveau à chaque appel
+    const uint32_t nb_pixels = uint32_t(view.width) * uint32_t(view.height);
+    vk::DeviceSize needed_size = vk::DeviceSize(nb_pixels) * sizeof(Pixel);
+    if (needed_size > this->buffer_size)
+    {
+        create_buffer(needed_size);
+        update_descriptor_set();
+    }
+    const uint32_t orbit_points = uint32_t(view.max_iter) + 1;
+    if (orbit_points > this->orbit_capacity)
+    {
+        allocate_buffer(vk::DeviceSize(orbit_points) * 2 * sizeof(double), vk::BufferUsageFlagBits::eStorageBuffer,
+                        this->orbit_buffer, this->orbit_memory);
+        this->orbit_capacity = orbit_points;
+    }
+    if (nb_pixels > this->glitch_capacity)
+    {
+        allocate_buffer((1 + 2 * vk::DeviceSize(nb_pixels)) * sizeof(uint32_t),
+                        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                        this->glitch_buffer, this->glitch_memory);
+        this->glitch_capacity = nb_pixels;
+    }
+    update_perturbation_descriptor_set();
+
+    PerturbationParameters parameters{view.width, view.height, view.max_iter, 0, 0.f, 0.f, 0.f, 0u,
+                                      view.extent, 0., 0., mandelbrot::glitch_tolerance2,
+                                      0.f, 0.f, float(mandelbrot::glitch_tolerance2), 0u, 0u, 0u};
+
+    // Copie d'une orbite (entrelacée en dvec2 ou en vec2) et de sa position dans les paramètres ; la mémoire n'étant pas
+    // forcément cohérente, on la vide explicitement
+    auto upload_orbit = [this, &parameters](mandelbrot::ReferenceOrbit const& reference)
+    {
+        void* mapped_orbit = this->logical_device.mapMemory(this->orbit_memory, 0, VK_WHOLE_SIZE);
+        for (int m = 0; m < reference.length(); ++m)
+        {
+            if (this->float64_supported)
+            {
+                ((double*)mapped_orbit)[2*m]   = reference.zr[m];
+                ((double*)mapped_orbit)[2*m+1] = reference.zi[m];
+            }
+            else
+            {
+                ((float*)mapped_orbit)[2*m]   = float(reference.zr[m]);
+                ((float*)mapped_orbit)[2*m+1] = float(reference.zi[m]);
+            }
+        }
+        vk::MappedMemoryRange orbit_range;
+        orbit_range.setMemory(this->orbit_memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+        this->logical_device.flushMappedMemoryRanges(orbit_range);
+        this->logical_device.unmapMemory(this->orbit_memory);
+        parameters.orbit_length    = reference.length();
+        parameters.scale           = reference.scale;
+        parameters.inv_scale       = reference.inv_scale;
+        parameters.extent_scaled   = reference.extent_scaled;
+        parameters.offset_x        = reference.offset_x;
+        parameters.offset_y        = reference.offset_y;
+        parameters.offset_x_scaled = float(std::ldexp(reference.offset_x, -reference.scale_exponent));
+        parameters.offset_y_scaled = float(std::ldexp(reference.offset_y, -reference.scale_exponent));
+    };
+
+    // Un passage : remise à zéro du compteur, calcul de nb_threads pixels (tous ou ceux de la liste d'entrée), puis
+    // lecture du nombre de pixels glitchés rangés dans la liste de sortie
+    double gpu_time = 0.;
+    auto run_pass = [this, &parameters, &gpu_time](uint32_t nb_threads)
+    {
+        this->command_buffer.reset();
+        vk::CommandBufferBeginInfo begin_info;
+        begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        this->command_buffer.begin(begin_info);
+        this->command_buffer.fillBuffer(this->glitch_buffer, 0, sizeof(uint32_t), 0);
+        vk::MemoryBarrier fill_barrier;
+        fill_barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                    .setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+        this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+                                             1, &fill_barrier, 0, nullptr, 0, nullptr);
+        this->command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->perturbation_pipeline);
+        this->command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, this->perturbation_pipeline_layout, 0, 1, &this->perturbation_descriptor_set, 0, nullptr);
+        this->command_buffer.pushConstants(this->perturbation_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(PerturbationParameters), &parameters);
+        this->command_buffer.dispatch((nb_threads + perturbation_workgroup_size - 1)/perturbation_workgroup_size, 1, 1);
+        // Les écritures du shader doivent être visibles par l'hôte (lecture du compteur et des listes)
+        vk::MemoryBarrier host_barrier;
+        host_barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+                    .setDstAccessMask(vk::AccessFlagBits::eHostRead);
+        this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost, {},
+                                             1, &host_barrier, 0, nullptr, 0, nullptr);
+        this->command_buffer.end();
+
+        auto beg_time = std::chrono::high_resolution_clock::now();
+        this->pt_dbg_utils->create_messenger();
+        run_command_buffer();
+        this->pt_dbg_utils->destroy_messenger();
+        auto end_time = std::chrono::high_resolution_clock::now();
+        gpu_time += std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+
+        void* mapped_counter = this->logical_device.mapMemory(this->glitch_memory, 0, VK_WHOLE_SIZE);
+        vk::MappedMemoryRange counter_range;
+        counter_range.setMemory(this->glitch_memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+        this->logical_device.invalidateMappedMemoryRanges(counter_range);
+        uint32_t nb_glitched = *(uint32_t*)mapped_counter;
+        this->logical_device.unmapMemory(this->glitch_memory);
+        return nb_glitched;
+    };
+    // La liste de sortie d'un passage devient la liste d'entrée du suivant
+    auto swap_lists = [&parameters, nb_pixels](uint32_t nb_listed)
+    {
+        parameters.mode       = 1;
+        parameters.nb_listed  = nb_listed;
+        parameters.in_offset  = parameters.out_offset;
+        parameters.out_offset = parameters.out_offset == 0 ? nb_pixels : 0;
+    };
+
+    // Premier passage : tous les pixels avec l'orbite du centre
+    mandelbrot::PerturbationStats stats;
+    upload_orbit(orbit);
+    uint32_t nb_pending = run_pass(nb_pixels);
+    stats.nb_glitched = int(nb_pending);
+
+    // Seuls les pixels glitchés sont recalculés, avec une orbite secondaire centrée sur l'un d'eux. Le compteur atomique
+    // range les pixels dans un ordre quelconque : la liste est triée pour choisir le même pixel que
+    // compute_iterations_perturbation
+    while (nb_pending > 0 && stats.nb_secondary < mandelbrot::max_secondary_orbits)
+    {
+        uint32_t* mapped_glitch = (uint32_t*)this->logical_device.mapMemory(this->glitch_memory, 0, VK_WHOLE_SIZE);
+        vk::MappedMemoryRange glitch_range;
+        glitch_range.setMemory(this->glitch_memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+        this->logical_device.invalidateMappedMemoryRanges(glitch_range);
+        uint32_t* pending = mapped_glitch + 1 + parameters.out_offset;
+        std::sort(pending, pending + nb_pending);
+        const uint32_t p = pending[nb_pending/2];
+        this->logical_device.flushMappedMemoryRanges(glitch_range);
+        this->logical_device.unmapMemory(this->glitch_memory);
+
+        auto secondary = mandelbrot::compute_reference_orbit(view,
+                                                             mandelbrot::pixel_offset(int(p % uint32_t(view.width)), view.width,  view.extent),
+                                                             mandelbrot::pixel_offset(int(p / uint32_t(view.width)), view.height, view.extent));
+        ++stats.nb_secondary;
+        upload_orbit(secondary);
+        swap_lists(nb_pending);
+        nb_pending = run_pass(nb_pending);
+    }
+    stats.nb_unresolved = int(nb_pending);
+    if (nb_pending > 0)
+    {
+        // Les pixels restants sont calculés avec l'orbite du centre, sans détection
+        upload_orbit(orbit);
+        parameters.tolerance2        = 0.;
+        parameters.tolerance2_single = 0.f;
+        swap_lists(nb_pending);
+        run_pass(nb_pending);
+    }
+
+    this->rendered_view = mandelbrot::View{view.width, view.height, 0.f, 0.f, float(view.extent), view.max_iter};
+    this->rendered_format = mandelbrot::OutputFormat::rgba32f;
+    std::cout << "Temps calcul mandelbrot par perturbation sur gpu (" << view.width << "x" << view.height << ", étendue "
+              << view.extent << ", écarts en " << (this->float64_supported ? "double" : "simple") << " précision) = "
+              << gpu_time << "[ms]" << std::endl;
+    std::cout << "Pixels glitchés : " << stats.nb_glitched << ", recalculés avec " << stats.nb_secondary
+              << " orbites secondaires (" << stats.nb_unresolved << " calculés sans détection)" << std::endl;
+    if (stats.nb_unresolved > 0)
+        std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << stats.nb_unresolved
+                  << " pixels glitchés n'ont pu être recalculés avec une orbite secondaire" << std::endl;
+    return gpu_time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::create_precision_pipelines()
+{
+    // Les deux shaders n'utilisent que l'image (point de liaison 0) : on réutilise la disposition et l'ensemble de
+    // descripteurs du pipeline principal et seules les constantes poussées diffèrent
+    auto create_pipeline = [this](char const* filename, uint32_t push_constant_size, vk::ShaderModule& module,
+                                  vk::PipelineLayout& layout, vk::Pipeline& pipeline)
+    {
+        auto code = __details__::read_file(filename);
+        vk::ShaderModuleCreateInfo create_info;
+        create_info.setPCode(code.data())
+                   .setCodeSize(sizeof(uint32_t)*code.size());
+        module = this->logical_device.createShaderModule(create_info, nullptr);
+
+        vk::PipelineShaderStageCreateInfo shader_stage_create_info;
+        shader_stage_create_info.setStage(vk::ShaderStageFlagBits::eCompute)
+                                .setModule(module)
+                                .setPName("main");
+        vk::PushConstantRange push_constant_range;
+        push_constant_range.setStageFlags(vk::ShaderStageFlagBits::eCompute)
+                           .setOffset(0)
+                           .setSize(push_constant_size);
+        vk::PipelineLayoutCreateInfo pipeline_layout_create_info;
+        pipeline_layout_create_info.setSetLayoutCount(1)
+                                   .setPSetLayouts(&this->descriptor_set_layout)
+                                   .setPushConstantRangeCount(1)
+                                   .setPPushConstantRanges(&push_constant_range);
+        layout = this->logical_device.createPipelineLayout(pipeline_layout_create_info, nullptr);
+
+        std::vector<vk::ComputePipelineCreateInfo> pipeline_create_infos(1);
+        pipeline_create_infos[0].setStage(shader_stage_create_info);
+        pipeline_create_infos[0].setLayout(layout);
+        pipeline = this->logical_device.createComputePipelines(vk::PipelineCache{nullptr}, pipeline_create_infos).value[0];
+    };
+    // Codes compilés par : glslangValidator -V double_single.comp -o double_single.spv (idem pour double.comp)
+    create_pipeline("shaders/double_single.spv", sizeof(DoubleSingleParameters), this->double_single_shader_module,
+                    this->double_single_pipeline_layout, this->double_single_pipeline);
+    // Le module double.spv déclare la capacité Float64 : il serait refusé par un périphérique sans shaderFloat64
+    if (this->float64_supported)
+        create_pipeline("shaders/double.spv", sizeof(mandelbrot::PreciseView), this->double_shader_module,
+                        this->double_pipeline_layout, this->double_pipeline);
+}
+// --------------------------------------------------------------------------------------------------------------------
+mandelbrot::Precision
+ComputingPipeline::choose_precision(mandelbrot::PreciseView const& view) const
+{
+    using mandelbrot::Precision;
+    if (mandelbrot::is_precise_enough(Precision::single, view)) return Precision::single;
+    if (mandelbrot::is_precise_enough(Precision::double_single, view)) return Precision::double_single;
+    return this->float64_supported ? Precision::native_double : Precision::double_single;
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::render_precise(mandelbrot::PreciseView const& view, mandelbrot::Precision precision)
+{
+    using mandelbrot::Precision;
+    if (precision == Precision::native_double && not this->float64_supported)
+        throw std::runtime_error("Le périphérique ne propose pas la double précision dans les shaders (shaderFloat64)");
+    if (precision != Precision::single && not this->double_single_pipeline) create_precision_pipelines();
+
+    // Le shader principal (simple précision) écrit l'image au format output_format, les deux autres en flottants
+    auto format = (precision == Precision::single) ? this->output_format : mandelbrot::OutputFormat::rgba32f;
+    vk::DeviceSize needed_size = mandelbrot::image_size_in_bytes(format, std::size_t(view.width) * std::size_t(view.height));
+    if (needed_size > this->buffer_size)
+    {
+        create_buffer(needed_size);
+        update_descriptor_set();
+    }
+    // Paramètres de chaque shader : la fenêtre en simple précision, en double simple (centre découpé en hi + lo) ou en double
+    mandelbrot::View single_view{view.width, view.height, float(view.center_x), float(view.center_y), float(view.extent), view.max_iter};
+    MainParameters single_parameters{single_view, 0};
+    float center_x_hi = float(view.center_x), center_y_hi = float(view.center_y);
+    DoubleSingleParameters double_single_parameters{view.width, view.height,
+                                                    center_x_hi, float(view.center_x - double(center_x_hi)),
+                                                    center_y_hi, float(view.center_y - double(center_y_hi)),
+                                                    float(view.extent), view.max_iter};
+    vk::Pipeline pipeline = this->pipeline;
+    vk::PipelineLayout layout = this->pipeline_layout;
+    uint32_t push_constant_size = sizeof(MainParameters);
+    void const* push_constants = &single_parameters;
+    if (precision == Precision::double_single)
+    {
+        pipeline = this->double_single_pipeline;
+        layout = this->double_single_pipeline_layout;
+        push_constant_size = sizeof(DoubleSingleParameters);
+        push_constants = &double_single_parameters;
+    }
+    else if (precision == Precision::native_double)
+    {
+        pipeline = this->double_pipeline;
+        layout = this->double_pipeline_layout;
+        push_constant_size = sizeof(mandelbrot::PreciseView);
+        push_constants = &view;
+    }
+
+    this->command_buffer.reset();
+    vk::CommandBufferBeginInfo begin_info;
+    begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    this->command_buffer.begin(begin_info);
+    if (precision == Precision::single) record_image_clear(single_view);
+    this->command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+    this->command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, layout, 0, 1, &this->descriptor_set, 0, nullptr);
+    this->command_buffer.pushConstants(layout, vk::ShaderStageFlagBits::eCompute, 0, push_constant_size, push_constants);
+    this->command_buffer.dispatch( uint32_t(std::ceil(view.width/float(workgroup_size))), uint32_t(std::ceil(view.height/float(workgroup_size))), 1 );
+    this->command_buffer.end();
+
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    this->pt_dbg_utils->create_messenger();
+    run_command_buffer();
+    this->pt_dbg_utils->destroy_messenger();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double gpu_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+    this->rendered_view = single_view;
+    this->rendered_format = format;
+    std::cout << "Temps calcul mandelbrot sur gpu en arithmétique " << mandelbrot::precision_name(precision) << " = "
+              << gpu_time << "[ms]" << std::endl;
+    return gpu_time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::create_colorize_pipeline()
+{
+    // Disposition de l'ensemble de descripteurs du shader colorize.comp : image couleur (0), palette (1), carte des nombres
+    // d'itérations (2), histogramme (3) et fonction de répartition (4)
+    std::array<vk::DescriptorSetLayoutBinding, 5> bindings;
+    for (uint32_t b = 0; b < bindings.size(); ++b)
+        bindings[b].setBinding(b)
+                   .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                   .setDescriptorCount(1)
+                   .setStageFlags(vk::ShaderStageFlagBits::eCompute);
+    vk::DescriptorSetLayoutCreateInfo layout_create_info;
+    layout_create_info.setBindingCount(uint32_t(bindings.size()))
+                      .setPBindings(bindings.data());
+    this->colorize_descriptor_set_layout = this->logical_device.createDescriptorSetLayout(layout_create_info, nullptr);
+
+    vk::DescriptorSetAllocateInfo descriptor_set_allocate_info;
+    descriptor_set_allocate_info.setDescriptorPool(this->descriptor_pool)
+                                .setDescriptorSetCount(1)
+                                .setPSetLayouts(&this->colorize_descriptor_set_layout);
+    this->colorize_descriptor_set = this->logical_device.allocateDescriptorSets(descriptor_set_allocate_info)[0];
+
+    // Le code compilé a été obtenu par : glslangValidator -V colorize.comp -o colorize.spv
+    auto code = __details__::read_file("shaders/colorize.spv");
+    vk::ShaderModuleCreateInfo create_info;
+    create_info.setPCode(code.data())
+               .setCodeSize(sizeof(uint32_t)*code.size());
+    this->colorize_shader_module = this->logical_device.createShaderModule(create_info, nullptr);
+
+    vk::PipelineShaderStageCreateInfo shader_stage_create_info;
+    shader_stage_create_info.setStage(vk::ShaderStageFlagBits::eCompute)
+                            .setModule(this->colorize_shader_module)
+                            .setPName("main");
+    vk::PushConstantRange push_constant_range;
+    push_constant_range.setStageFlags(vk::ShaderStageFlagBits::eCompute)
+                       .setOffset(0)
+                       .setSize(sizeof(ColoringParameters));
+    vk::PipelineLayoutCreateInfo pipeline_layout_create_info;
+    pipeline_layout_create_info.setSetLayoutCount(1)
+                               .setPSetLayouts(&this->colorize_descriptor_set_layout)
+                               .setPushConstantRangeCount(1)
+                               .setPPushConstantRanges(&push_constant_range);
+    this->colorize_pipeline_layout = this->logical_device.createPipelineLayout(pipeline_layout_create_info, nullptr);
+
+    std::vector<vk::ComputePipelineCreateInfo> pipeline_create_infos(1);
+    pipeline_create_infos[0].setStage(shader_stage_create_info);
+    pipeline_create_infos[0].setLayout(this->colorize_pipeline_layout);
+    auto pipelines = this->logical_device.createComputePipelines(vk::PipelineCache{nullptr}, pipeline_create_infos);
+    this->colorize_pipeline = pipelines.value[0];
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::update_colorize_descriptor_set()
+{
+    std::array<vk::DescriptorBufferInfo, 5> buffer_infos;
+    buffer_infos[0].setBuffer(this->color_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    buffer_infos[1].setBuffer(this->palette_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    buffer_infos[2].setBuffer(this->buffer).setOffset(0).setRange(this->buffer_size);
+    buffer_infos[3].setBuffer(this->histogram_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    buffer_infos[4].setBuffer(this->cdf_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    std::array<vk::WriteDescriptorSet, 5> writes;
+    for (uint32_t b = 0; b < writes.size(); ++b)
+        writes[b].setDstSet(this->colorize_descriptor_set)
+                 .setDstBinding(b)
+                 .setDescriptorCount(1)
+                 .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                 .setPBufferInfo(&buffer_infos[b]);
+    this->logical_device.updateDescriptorSets(uint32_t(writes.size()), writes.data(), 0, nullptr);
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::recolor(mandelbrot::Coloring const& coloring)
+{
+    if (this->rendered_format != mandelbrot::OutputFormat::iteration_map)
+        throw std::runtime_error("Le dernier rendu n'est pas une carte des nombres d'itérations (format iteration_map)");
+    if (not this->colorize_pipeline) create_colorize_pipeline();
+    auto const& view = this->rendered_view;
+    const uint32_t nb_pixels = uint32_t(view.width) * uint32_t(view.height);
+    const uint32_t max_iter  = uint32_t(view.max_iter);
+
+    // Les buffers ne sont jamais réduits. La carte étant le buffer du dernier rendu (qui a pu être recréé), l'ensemble de
+    // descripteurs est relié de nouveau à chaque appel
+    if (nb_pixels > this->color_capacity)
+    {
+        allocate_buffer(vk::DeviceSize(nb_pixels) * sizeof(uint32_t), vk::BufferUsageFlagBits::eStorageBuffer,
+                        this->color_buffer, this->color_memory);
+        this->color_capacity = nb_pixels;
+    }
+    if (max_iter > this->histogram_capacity)
+    {
+        allocate_buffer(vk::DeviceSize(max_iter) * sizeof(uint32_t),
+                        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                        this->histogram_buffer, this->histogram_memory);
+        allocate_buffer(vk::DeviceSize(max_iter + 1) * sizeof(float), vk::BufferUsageFlagBits::eStorageBuffer,
+                        this->cdf_buffer, this->cdf_memory);
+        this->histogram_capacity = max_iter;
+    }
+    update_colorize_descriptor_set();
+
+    ColoringParameters parameters{int32_t(nb_pixels), view.max_iter, 0, uint32_t(coloring.mapping), coloring.density, coloring.offset};
+    const uint32_t nb_groups = (nb_pixels + colorize_workgroup_size - 1)/colorize_workgroup_size;
+    vk::MemoryBarrier compute_barrier;
+    compute_barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+                   .setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+
+    this->command_buffer.reset();
+    vk::CommandBufferBeginInfo begin_info;
+    begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    this->command_buffer.begin(begin_info);
+    this->command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->colorize_pipeline);
+    this->command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, this->colorize_pipeline_layout, 0, 1,
+                                            &this->colorize_descriptor_set, 0, nullptr);
+    if (coloring.mapping == mandelbrot::ColorMapping::equalized)
+    {
+        // Égalisation d'histogramme : histogramme (réduction globale par compteurs atomiques) puis fonction de répartition
+        this->command_buffer.fillBuffer(this->histogram_buffer, 0, vk::DeviceSize(max_iter) * sizeof(uint32_t), 0);
+        vk::MemoryBarrier fill_barrier;
+        fill_barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                    .setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+        this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+                                             1, &fill_barrier, 0, nullptr, 0, nullptr);
+        this->command_buffer.pushConstants(this->colorize_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(ColoringParameters), &parameters);
+        this->command_buffer.dispatch(nb_groups, 1, 1);
+        this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {},
+                                             1, &compute_barrier, 0, nullptr, 0, nullptr);
+        parameters.mode = 1;
+        this->command_buffer.pushConstants(this->colorize_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(ColoringParameters), &parameters);
+        this->command_buffer.dispatch(1, 1, 1);
+        this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {},
+                                             1, &compute_barrier, 0, nullptr, 0, nullptr);
+    }
+    parameters.mode = 2;
+    this->command_buffer.pushConstants(this->colorize_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(ColoringParameters), &parameters);
+    this->command_buffer.dispatch(nb_groups, 1, 1);
+    this->command_buffer.end();
+
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    this->pt_dbg_utils->create_messenger();
+    run_command_buffer();
+    this->pt_dbg_utils->destroy_messenger();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double gpu_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+    this->recolored_view = view;
+    std::cout << "Temps mise en couleur sur gpu ("
+              << (coloring.mapping == mandelbrot::ColorMapping::equalized ? "égalisation d'histogramme" : "linéaire")
+              << ") = " << gpu_time << "[ms]" << std::endl;
+    return gpu_time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::save_recolored_image(std::string const& filename)
+{
+    auto const& view = this->recolored_view;
+    vk::DeviceSize image_size = vk::DeviceSize(view.width) * vk::DeviceSize(view.height) * sizeof(uint32_t);
+    void* mapped_memory = this->logical_device.mapMemory(this->color_memory, 0, image_size);
+    save_image(mapped_memory, view.width, view.height, mandelbrot::OutputFormat::rgba8, filename);
+    this->logical_device.unmapMemory(this->color_memory);
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::create_supersample_pipeline()
+{
+    // Disposition de l'ensemble de descripteurs du shader supersample.comp : image (0), palette (1), nombres d'itérations
+    // au centre des pixels (2) et liste des pixels à suréchantillonner (3)
+    std::array<vk::DescriptorSetLayoutBinding, 4> bindings;
+    for (uint32_t b = 0; b < bindings.size(); ++b)
+        bindings[b].setBinding(b)
+                   .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                   .setDescriptorCount(1)
+                   .setStageFlags(vk::ShaderStageFlagBits::eCompute);
+    vk::DescriptorSetLayoutCreateInfo layout_create_info;
+    layout_create_info.setBindingCount(uint32_t(bindings.size()))
+                      .setPBindings(bindings.data());
+    this->supersample_descriptor_set_layout = this->logical_device.createDescriptorSetLayout(layout_create_info, nullptr);
+
+    vk::DescriptorSetAllocateInfo descriptor_set_allocate_info;
+    descriptor_set_allocate_info.setDescriptorPool(this->descriptor_pool)
+                                .setDescriptorSetCount(1)
+                                .setPSetLayouts(&this->supersample_descriptor_set_layout);
+    this->supersample_descriptor_set = this->logical_device.allocateDescriptorSets(descriptor_set_allocate_info)[0];
+
+    // Le code compilé a été obtenu par : glslangValidator -V supersample.comp -o supersample.spv
+    auto code = __details__::read_file("shaders/supersample.spv");
+    vk::ShaderModuleCreateInfo create_info;
+    create_info.setPCode(code.data())
+               .setCodeSize(sizeof(uint32_t)*code.size());
+    this->supersample_shader_module = this->logical_device.createShaderModule(create_info, nullptr);
+
+    // Mêmes constantes de spécialisation que shader.comp pour les raccourcis (constant_id = 0 et 1)
+    std::array<uint32_t, 2> specialization_data{ (this->shortcuts & mandelbrot::interior_test)    ? VK_TRUE : VK_FALSE,
+                                                 (this->shortcuts & mandelbrot::periodicity_test) ? VK_TRUE : VK_FALSE };
+    std::array<vk::SpecializationMapEntry, 2> specialization_entries;
+    for (uint32_t k = 0; k < specialization_entries.size(); ++k)
+        specialization_entries[k].setConstantID(k).setOffset(k*sizeof(uint32_t)).setSize(sizeof(uint32_t));
+    vk::SpecializationInfo specialization_info;
+    specialization_info.setMapEntryCount(uint32_t(specialization_entries.size()))
+                       .setPMapEntries(specialization_entries.data())
+                       .setDataSize(sizeof(specialization_data))
+                       .setPData(specialization_data.data());
+
+    vk::PipelineShaderStageCreateInfo shader_stage_create_info;
+    shader_stage_create_info.setStage(vk::ShaderStageFlagBits::eCompute)
+                            .setModule(this->supersample_shader_module)
+                            .setPName("main")
+                            .setPSpecializationInfo(&specialization_info);
+    vk::PushConstantRange push_constant_range;
+    push_constant_range.setStageFlags(vk::ShaderStageFlagBits::eCompute)
+                       .setOffset(0)
+                       .setSize(sizeof(SupersampleParameters));
+    vk::PipelineLayoutCreateInfo pipeline_layout_create_info;
+    pipeline_layout_create_info.setSetLayoutCount(1)
+                               .setPSetLayouts(&this->supersample_descriptor_set_layout)
+                               .setPushConstantRangeCount(1)
+                               .setPPushConstantRanges(&push_constant_range);
+    this->supersample_pipeline_layout = this->logical_device.createPipelineLayout(pipeline_layout_create_info, nullptr);
+
+    std::vector<vk::ComputePipelineCreateInfo> pipeline_create_infos(1);
+    pipeline_create_infos[0].setStage(shader_stage_create_info);
+    pipeline_create_infos[0].setLayout(this->supersample_pipeline_layout);
+    auto pipelines = this->logical_device.createComputePipelines(vk::PipelineCache{nullptr}, pipeline_create_infos);
+    this->supersample_pipeline = pipelines.value[0];
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::update_supersample_descriptor_set()
+{
+    std::array<vk::DescriptorBufferInfo, 4> buffer_infos;
+    buffer_infos[0].setBuffer(this->buffer).setOffset(0).setRange(this->buffer_size);
+    buffer_infos[1].setBuffer(this->palette_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    buffer_infos[2].setBuffer(this->counts_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    buffer_infos[3].setBuffer(this->refined_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+    std::array<vk::WriteDescriptorSet, 4> writes;
+    for (uint32_t b = 0; b < writes.size(); ++b)
+        writes[b].setDstSet(this->supersample_descriptor_set)
+                 .setDstBinding(b)
+                 .setDescriptorCount(1)
+                 .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                 .setPBufferInfo(&buffer_infos[b]);
+    this->logical_device.updateDescriptorSets(uint32_t(writes.size()), writes.data(), 0, nullptr);
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::render_antialiased(mandelbrot::View const& view, int samples, bool adaptive)
+{
+    if (not this->supersample_pipeline) create_supersample_pipeline();
+    const uint32_t nb_pixels = uint32_t(view.width) * uint32_t(view.height);
+
+    // Agrandissement éventuel des buffers : image (format rgba8), nombres d'itérations et liste (compteur + indices).
+    // L'image étant le buffer du rendu principal (qui a pu être recréé), l'ensemble de descripteurs est relié de nouveau
+    // à chaque appel
+    vk::DeviceSize needed_size = mandelbrot::image_size_in_bytes(mandelbrot::OutputFormat::rgba8, nb_pixels);
+    if (needed_size > this->buffer_size)
+    {
+        create_buffer(needed_size);
+        update_descriptor_set();
+    }
+    if (nb_pixels > this->supersample_capacity)
+    {
+        allocate_buffer(vk::DeviceSize(nb_pixels) * sizeof(int32_t), vk::BufferUsageFlagBits::eStorageBuffer,
+                        this->counts_buffer, this->counts_memory);
+        allocate_buffer((1 + vk::DeviceSize(nb_pixels)) * sizeof(uint32_t),
+                        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                        this->refined_buffer, this->refined_memory);
+        this->supersample_capacity = nb_pixels;
+    }
+    update_supersample_descriptor_set();
+
+    // Enregistrement : remise à zéro du compteur, centre des pixels, détection des bords puis suréchantillonnage. Le
+    // nombre de pixels à suréchantillonner n'est connu que du GPU : la dernière passe lance un thread par pixel et les
+    // threads au-delà de la liste s'arrêtent aussitôt
+    SupersampleParameters parameters{view, 0u, int32_t(samples), adaptive ? 0u : 1u};
+    const uint32_t nb_groups = (nb_pixels + supersample_workgroup_size - 1)/supersample_workgroup_size;
+    vk::MemoryBarrier compute_barrier;
+    compute_barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+                   .setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+
+    this->command_buffer.reset();
+    vk::CommandBufferBeginInfo begin_info;
+    begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    this->command_buffer.begin(begin_info);
+    this->command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->supersample_pipeline);
+    this->command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, this->supersample_pipeline_layout, 0, 1,
+                                            &this->supersample_descriptor_set, 0, nullptr);
+    this->command_buffer.fillBuffer(this->refined_buffer, 0, sizeof(uint32_t), 0);
+    vk::MemoryBarrier fill_barrier;
+    fill_barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+    this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+                                         1, &fill_barrier, 0, nullptr, 0, nullptr);
+    for (uint32_t mode = 0; mode < 3; ++mode)
+    {
+        if (mode > 0)
+            this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {},
+                                                 1, &compute_barrier, 0, nullptr, 0, nullptr);
+        parameters.mode = mode;
+        this->command_buffer.pushConstants(this->supersample_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0,
+                                           sizeof(SupersampleParameters), &parameters);
+        this->command_buffer.dispatch(nb_groups, 1, 1);
+    }
+    // Les écritures du shader doivent être visibles par l'hôte (lecture du compteur et de l'image)
+    vk::MemoryBarrier host_barrier;
+    host_barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eHostRead);
+    this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost, {},
+                                         1, &host_barrier, 0, nullptr, 0, nullptr);
+    this->command_buffer.end();
+
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    this->pt_dbg_utils->create_messenger();
+    run_command_buffer();
+    this->pt_dbg_utils->destroy_messenger();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double gpu_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+
+    void* mapped_counter = this->logical_device.mapMemory(this->refined_memory, 0, VK_WHOLE_SIZE);
+    vk::MappedMemoryRange counter_range;
+    counter_range.setMemory(this->refined_memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+    this->logical_device.invalidateMappedMemoryRanges(counter_range);
+    const uint32_t nb_refined = *(uint32_t*)mapped_counter;
+    this->logical_device.unmapMemory(this->refined_memory);
+    this->rendered_view = view;
+    this->rendered_format = mandelbrot::OutputFormat::rgba8;
+
+    const long long nb_samples = (long long)nb_pixels + (long long)nb_refined * samples * samples;
+    std::cout << "Temps " << (adaptive ? "anticrénelage adaptatif " : "suréchantillonnage uniforme ") << samples << "x"
+              << samples << " sur gpu = " << gpu_time << "[ms], " << nb_refined << " pixels suréchantillonnés ("
+              << 100.*double(nb_refined)/double(nb_pixels) << "%), " << nb_samples << " points calculés" << std::endl;
+    return gpu_time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::render_persistent(mandelbrot::View const& view, uint32_t nb_workgroups)
+{
+    if (not this->persistent_pipeline) this->persistent_pipeline = create_main_pipeline(true);
+    vk::DeviceSize needed_size = mandelbrot::image_size_in_bytes(this->output_format, std::size_t(view.width) * std::size_t(view.height));
+    if (needed_size > this->buffer_size)
+    {
+        create_buffer(needed_size);
+        update_descriptor_set();
+    }
+    this->rendered_view = view;
+    this->rendered_format = this->output_format;
+
+    // Même enregistrement que record_command_buffer, précédé de la remise à zéro du compteur de tuiles, mais avec un
+    // nombre fixe de groupes de travail (1D) : chaque groupe calcule des tuiles de workgroup_size x workgroup_size pixels
+    // tant qu'il en reste
+    this->command_buffer.reset();
+    vk::CommandBufferBeginInfo begin_info;
+    begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    this->command_buffer.begin(begin_info);
+    record_image_clear(view);
+    this->command_buffer.fillBuffer(this->tile_counter_buffer, 0, sizeof(uint32_t), 0);
+    vk::MemoryBarrier fill_barrier;
+    fill_barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+    this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+                                         1, &fill_barrier, 0, nullptr, 0, nullptr);
+    this->command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->persistent_pipeline);
+    this->command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, this->pipeline_layout, 0, 1, &this->descriptor_set, 0, nullptr);
+    MainParameters parameters{view, 0};
+    this->command_buffer.pushConstants(this->pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(MainParameters), &parameters);
+    this->command_buffer.dispatch(nb_workgroups, 1, 1);
+    this->command_buffer.end();
+
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    this->pt_dbg_utils->create_messenger();
+    run_command_buffer();
+    this->pt_dbg_utils->destroy_messenger();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double gpu_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+    std::cout << "Temps calcul mandelbrot sur gpu par threads persistants (" << view.width << "x" << view.height << ", "
+              << nb_workgroups << " groupes) = " << gpu_time << "[ms]" << std::endl;
+    return gpu_time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+uint32_t
+ComputingPipeline::benchmark_persistent(mandelbrot::View const& view, int nb_repetitions)
+{
+    // Référence : répartition statique (un groupe par tuile), meilleur temps sur nb_repetitions rendus. L'image sert à
+    // vérifier que les threads persistants calculent exactement les mêmes pixels.
+    double static_time = -1.;
+    for (int r = 0; r < nb_repetitions; ++r)
+    {
+        double time = render(view);
+        if (static_time < 0. || time < static_time) static_time = time;
+    }
+    vk::DeviceSize image_size = mandelbrot::image_size_in_bytes(this->output_format, std::size_t(view.width) * std::size_t(view.height));
+    std::vector<char> reference(image_size);
+    // La mémoire n'étant pas forcément cohérente, on invalide la plage mappée avant de la lire
+    vk::MappedMemoryRange image_range;
+    image_range.setMemory(this->buffer_memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+    void* mapped_memory = this->logical_device.mapMemory(this->buffer_memory, 0, image_size);
+    this->logical_device.invalidateMappedMemoryRanges(image_range);
+    std::memcpy(reference.data(), mapped_memory, image_size);
+    this->logical_device.unmapMemory(this->buffer_memory);
+
+    const uint32_t nb_tiles = uint32_t(std::ceil(view.width/float(workgroup_size))) * uint32_t(std::ceil(view.height/float(workgroup_size)));
+    uint32_t best_nb_workgroups = 0;
+    double best_time = -1.;
+    for (uint32_t nb_workgroups : persistent_workgroup_counts)
+    {
+        if (nb_workgroups > nb_tiles) break;
+        double persistent_time = -1.;
+        for (int r = 0; r < nb_repetitions; ++r)
+        {
+            double time = render_persistent(view, nb_workgroups);
+            if (persistent_time < 0. || time < persistent_time) persistent_time = time;
+        }
+        mapped_memory = this->logical_device.mapMemory(this->buffer_memory, 0, image_size);
+        this->logical_device.invalidateMappedMemoryRanges(image_range);
+        bool same_image = (std::memcmp(reference.data(), mapped_memory, image_size) == 0);
+        this->logical_device.unmapMemory(this->buffer_memory);
+        std::cout << "Threads persistants (" << nb_workgroups << " groupes pour " << nb_tiles << " tuiles) : "
+                  << persistent_time << "[ms], accélération par rapport à la répartition statique : "
+                  << static_time/persistent_time << std::endl;
+        if (not same_image)
+            std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal
+                      << " l'image calculée par threads persistants diffère de la répartition statique" << std::endl;
+        if (best_time < 0. || persistent_time < best_time)
+        {
+            best_time = persistent_time;
+            best_nb_workgroups = nb_workgroups;
+        }
+    }
+    if (best_time > 0.)
+        std::cout << "Meilleur nombre de groupes persistants : " << best_nb_workgroups << " (" << best_time << "[ms] contre "
+                  << static_time << "[ms] en répartition statique)" << std::endl;
+    return best_nb_workgroups;
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::render_profiled(mandelbrot::View const& view, mandelbrot::IterationProfile& profile)
+{
+    if (not this->profiling_pipeline) this->profiling_pipeline = create_main_pipeline(false, true);
+    vk::DeviceSize needed_size = mandelbrot::image_size_in_bytes(this->output_format, std::size_t(view.width) * std::size_t(view.height));
+    if (needed_size > this->buffer_size)
+    {
+        create_buffer(needed_size);
+        update_descriptor_set();
+    }
+    // Le compteur de tuiles est suivi du coût de chaque tuile (un entier par groupe de travail)
+    const uint32_t nb_tiles_x = uint32_t(std::ceil(view.width/float(workgroup_size)));
+    const uint32_t nb_tiles_y = uint32_t(std::ceil(view.height/float(workgroup_size)));
+    vk::DeviceSize counter_size = (1 + vk::DeviceSize(nb_tiles_x) * nb_tiles_y) * sizeof(uint32_t);
+    if (counter_size > this->tile_counter_size) create_tile_counter_buffer(counter_size);
+    this->rendered_view = view;
+    this->rendered_format = this->output_format;
+
+    // Même enregistrement que record_command_buffer avec le pipeline instrumenté
+    this->command_buffer.reset();
+    vk::CommandBufferBeginInfo begin_info;
+    begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    this->command_buffer.begin(begin_info);
+    record_image_clear(view);
+    this->command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->profiling_pipeline);
+    this->command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, this->pipeline_layout, 0, 1, &this->descriptor_set, 0, nullptr);
+    MainParameters parameters{view, 0};
+    this->command_buffer.pushConstants(this->pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(MainParameters), &parameters);
+    this->command_buffer.dispatch(nb_tiles_x, nb_tiles_y, 1);
+    this->command_buffer.end();
+
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    this->pt_dbg_utils->create_messenger();
+    run_command_buffer();
+    this->pt_dbg_utils->destroy_messenger();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double gpu_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+
+    // Chaque groupe a écrit le coût de sa tuile : pas besoin de remettre les coûts à zéro avant le calcul
+    profile.tile_size  = int(workgroup_size);
+    profile.nb_tiles_x = int(nb_tiles_x);
+    profile.nb_tiles_y = int(nb_tiles_y);
+    profile.tile_work.resize(std::size_t(nb_tiles_x) * nb_tiles_y);
+    profile.thread_busy_ms.clear();
+    profile.thread_rows.clear();
+    profile.thread_work.clear();
+    profile.elapsed_ms = gpu_time;
+    profile.work = 0;
+    vk::MappedMemoryRange counter_range;
+    counter_range.setMemory(this->tile_counter_memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+    auto* counters = static_cast<uint32_t*>(this->logical_device.mapMemory(this->tile_counter_memory, 0, counter_size));
+    this->logical_device.invalidateMappedMemoryRanges(counter_range);
+    for (std::size_t t = 0; t < profile.tile_work.size(); ++t)
+    {
+        profile.tile_work[t] = counters[1 + t];
+        profile.work += counters[1 + t];
+    }
+    this->logical_device.unmapMemory(this->tile_counter_memory);
+    std::cout << "Temps calcul mandelbrot instrumenté sur gpu (" << view.width << "x" << view.height << ") = "
+              << gpu_time << "[ms]" << std::endl;
+    return gpu_time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::profiling_computation()
+{
+    if (not this->fractal.is_standard())
+        throw std::runtime_error("L'instrumentation n'est disponible que pour l'ensemble de mandelbrot usuel");
+    auto const& view = this->view;
+    const std::size_t nb_pixels = std::size_t(view.width) * std::size_t(view.height);
+    std::vector<int> iterations(nb_pixels), reference(nb_pixels);
+
+    // Noyau CPU instrumenté, comparé au noyau le plus rapide pour vérifier qu'il calcule les mêmes nombres d'itérations
+    mandelbrot::IterationProfile cpu_profile;
+    mandelbrot::compute_iterations_profiled(view, this->shortcuts, iterations.data(), cpu_profile);
+    mandelbrot::compute_iterations(mandelbrot::detect_isa(), view, this->shortcuts, reference.data());
+    std::cout << "Temps calcul mandelbrot instrumenté sur cpu = " << cpu_profile.elapsed_ms << "[ms], "
+              << cpu_profile.thread_busy_ms.size() << " threads, déséquilibre (plus chargé/moyenne) : "
+              << mandelbrot::thread_imbalance(cpu_profile) << std::endl;
+    if (iterations != reference)
+        std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal
+                  << " le noyau instrumenté ne donne pas les mêmes nombres d'itérations que le noyau "
+                  << mandelbrot::isa_name(mandelbrot::detect_isa()) << std::endl;
+
+    mandelbrot::IterationProfile gpu_profile;
+    render_profiled(view, gpu_profile);
+    // Les deux calculs suivent les mêmes suites : seuls les écarts d'arrondi du GPU séparent leurs totaux
+    std::cout << "Itérations calculées : " << cpu_profile.work << " sur cpu, " << gpu_profile.work << " sur gpu" << std::endl;
+
+    mandelbrot::save_heatmap(cpu_profile, "mandelbrot_chaleur_cpu.png");
+    mandelbrot::save_heatmap(gpu_profile, "mandelbrot_chaleur_gpu.png");
+    mandelbrot::save_profile_summary("instrumentation.json", view, cpu_profile, &gpu_profile);
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::render_rows(mandelbrot::View const& view, int row_begin, int row_end)
+{
+    // Comme record_command_buffer, mais seules les lignes de groupes de travail couvrant la bande sont lancées
+    this->command_buffer.reset();
+    vk::CommandBufferBeginInfo begin_info;
+    begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    this->command_buffer.begin(begin_info);
+    this->command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->pipeline);
+    this->command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, this->pipeline_layout, 0, 1, &this->descriptor_set, 0, nullptr);
+    MainParameters parameters{view, row_begin};
+    this->command_buffer.pushConstants(this->pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(MainParameters), &parameters);
+    this->command_buffer.dispatch(uint32_t(std::ceil(view.width/float(workgroup_size))),
+                                  uint32_t(std::ceil((row_end - row_begin)/float(workgroup_size))), 1);
+    this->command_buffer.end();
+    run_command_buffer();
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::co_render(mandelbrot::View const& view, std::uint32_t* image)
+{
+    if (this->output_format != mandelbrot::OutputFormat::rgba8 || this->smooth_coloring || this->distance_estimation ||
+        not this->fractal.is_standard())
+        throw std::runtime_error("Le co-rendu CPU+GPU n'est disponible que pour l'ensemble de mandelbrot usuel au format "
+                                 "rgba8, sans coloration continue ni estimation de distance");
+    const int width = view.width, height = view.height;
+    const std::size_t nb_pixels = std::size_t(width) * std::size_t(height);
+    vk::DeviceSize needed_size = mandelbrot::image_size_in_bytes(this->output_format, nb_pixels);
+    if (needed_size > this->buffer_size)
+    {
+        create_buffer(needed_size);
+        update_descriptor_set();
+    }
+    auto isa = mandelbrot::detect_isa();
+    std::vector<int> iterations(nb_pixels);
+    void* mapped_memory = this->logical_device.mapMemory(this->buffer_memory, 0, needed_size);
+    vk::MappedMemoryRange image_range;
+    image_range.setMemory(this->buffer_memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+
+    /*
+    File partagée des lignes de l'image : les threads CPU prennent une ligne à la fois par l'avant, le thread pilotant le
+    GPU prend des lots de lignes consécutives par l'arrière. Le premier lot est une seule bande de co_rendering_tile_rows
+    lignes, qui mesure le débit du GPU ; la taille des suivants est la moitié de la part des lignes restantes que le GPU
+    calculerait pendant que le CPU calcule les autres (débits mesurés au fil du calcul), arrondie à un nombre entier de
+    bandes tant qu'elle en dépasse une, puis d'une ligne au moins en fin de file. Le coût des lignes est très inégal (une
+    ligne traversant l'ensemble coûte max_iter itérations par pixel) : une ligne par thread CPU borne le temps pendant
+    lequel le GPU, une fois la file vide, attend le dernier thread, et le GPU continue de prendre des lots jusqu'à la
+    dernière ligne non commencée, si bien que CPU et GPU finissent ensemble.
+    */
+    // Le thread pilotant le GPU attend la fin de chaque lot : il s'ajoute aux threads de calcul sur CPU
+    const int nb_cpu_threads = omp_get_max_threads();
+    std::mutex queue_mutex;
+    int front = 0, back = height;
+    std::atomic<int> nb_cpu_rows{0};
+    int nb_gpu_rows = 0, nb_batches = 0;
+
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    this->pt_dbg_utils->create_messenger();
+#   pragma omp parallel num_threads(nb_cpu_threads + 1)
+    {
+        if (omp_get_thread_num() == 0)
+        {
+            double gpu_rate = 0.; // Lignes par milliseconde du dernier lot
+            while (true)
+            {
+                int row_begin, row_end;
+                {
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    const int remaining = back - front;
+                    if (remaining == 0) break;
+                    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - beg_time).count();
+                    double cpu_rate = double(nb_cpu_rows.load())/elapsed;
+                    double share = (gpu_rate > 0. && cpu_rate > 0.) ? gpu_rate/(gpu_rate + cpu_rate) : 0.5;
+                    int batch = std::clamp(int(0.5*share*remaining), 1, remaining);
+                    if (gpu_rate == 0.) batch = std::min(co_rendering_tile_rows, remaining);
+                    else if (batch > co_rendering_tile_rows) batch -= batch % co_rendering_tile_rows;
+                    row_end = back;
+                    back -= batch;
+                    row_begin = back;
+                }
+                auto batch_beg = std::chrono::high_resolution_clock::now();
+                render_rows(view, row_begin, row_end);
+                this->logical_device.invalidateMappedMemoryRanges(image_range);
+                std::memcpy(image + std::size_t(row_begin)*width, static_cast<std::uint32_t*>(mapped_memory) + std::size_t(row_begin)*width,
+                            std::size_t(row_end - row_begin)*width*sizeof(std::uint32_t));
+                auto batch_end = std::chrono::high_resolution_clock::now();
+                gpu_rate = double(row_end - row_begin)/std::chrono::duration<double, std::milli>(batch_end - batch_beg).count();
+                nb_gpu_rows += row_end - row_begin;
+                ++nb_batches;
+            }
+        }
+        else
+        {
+            while (true)
+            {
+                int row;
+                {
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    if (front == back) break;
+                    row = front++;
+                }
+                mandelbrot::compute_iterations_rows(isa, view, this->shortcuts, row, row + 1, iterations.data());
+                mandelbrot::store_image(mandelbrot::OutputFormat::rgba8, width, view.max_iter,
+                                        iterations.data() + std::size_t(row)*width, image + std::size_t(row)*width);
+                ++nb_cpu_rows;
+            }
+        }
+    }
+    this->pt_dbg_utils->destroy_messenger();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    this->logical_device.unmapMemory(this->buffer_memory);
+    double time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+    std::cout << "Temps co-rendu cpu+gpu (" << width << "x" << height << ") = " << time << "[ms] : " << nb_gpu_rows
+              << " lignes sur gpu (" << nb_batches << " lots), " << nb_cpu_rows.load() << " sur cpu ("
+              << nb_cpu_threads << " threads)" << std::endl;
+    return time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+void
+ComputingPipeline::co_rendering_computation()
+{
+    auto const& view = this->view;
+    const int width = view.width, height = view.height;
+    auto isa = mandelbrot::detect_isa();
+    std::vector<int> iterations(width * height);
+    std::vector<uint32_t> cpu_image(width * height), co_image(width * height);
+
+    // Chaque processeur seul sur toute l'image, puis les deux ensemble
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    mandelbrot::compute_iterations(isa, view, this->shortcuts, iterations.data());
+    mandelbrot::store_image(mandelbrot::OutputFormat::rgba8, width * height, view.max_iter, iterations.data(), cpu_image.data());
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double cpu_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+    std::cout << "Temps calcul mandelbrot sur cpu seul = " << cpu_time << "[ms]" << std::endl;
+    double gpu_time = render(view);
+    double co_time = co_render(view, co_image.data());
+
+    long nb_differences = 0;
+    for (int p = 0; p < width * height; ++p)
+        if (co_image[p] != cpu_image[p]) ++nb_differences;
+    std::cout << "Accélération du co-rendu par rapport au cpu seul : " << cpu_time/co_time << ", au gpu seul : "
+              << gpu_time/co_time << ". " << nb_differences << " pixels différents du calcul sur cpu seul" << std::endl;
+    save_image(co_image.data(), width, height, mandelbrot::OutputFormat::rgba8, "mandelbrot_corendu.png");
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::render_animation(mandelbrot::View const& view, int nb_frames, int frames_in_flight, std::string const& prefix)
+{
+    const uint32_t nb_slots = uint32_t(std::max(1, std::min(frames_in_flight, nb_frames)));
+    vk::DeviceSize image_size = mandelbrot::image_size_in_bytes(this->output_format, std::size_t(view.width) * std::size_t(view.height));
+
+    /*
+    Ressources de chaque image en vol : buffer de stockage (mappé une fois pour toutes), ensemble de descripteurs (image,
+    palette et compteur de tuiles), buffer de commande réenregistré à chaque image et barrière signalée à la fin du calcul.
+    Les ensembles de descripteurs viennent d'un réservoir propre à l'animation, détruit avec les autres ressources.
+    */
+    struct Frame
+    {
+        vk::Buffer        buffer{nullptr};
+        vk::DeviceMemory  memory{nullptr};
+        void*             mapped_memory{nullptr};
+        vk::DescriptorSet descriptor_set;
+        vk::CommandBuffer command_buffer;
+        vk::Fence         fence;
+        int               index{-1};      // Numéro de l'image en cours de calcul dans ce buffer (-1 : aucune)
+    };
+    std::vector<Frame> frames(nb_slots);
+
+    vk::DescriptorPoolSize pool_size;
+    pool_size.setType(vk::DescriptorType::eStorageBuffer)
+             .setDescriptorCount(3*nb_slots);
+    vk::DescriptorPoolCreateInfo pool_create_info;
+    pool_create_info.setMaxSets(nb_slots)
+                    .setPoolSizeCount(1)
+                    .setPPoolSizes(&pool_size);
+    vk::DescriptorPool frame_descriptor_pool = this->logical_device.createDescriptorPool(pool_create_info, nullptr);
+    std::vector<vk::DescriptorSetLayout> layouts(nb_slots, this->descriptor_set_layout);
+    vk::DescriptorSetAllocateInfo set_allocate_info;
+    set_allocate_info.setDescriptorPool(frame_descriptor_pool)
+                     .setDescriptorSetCount(nb_slots)
+                     .setPSetLayouts(layouts.data());
+    auto descriptor_sets = this->logical_device.allocateDescriptorSets(set_allocate_info);
+    vk::CommandBufferAllocateInfo command_buffer_allocate_info;
+    command_buffer_allocate_info.setCommandPool(this->command_pool)
+                                .setLevel(vk::CommandBufferLevel::ePrimary)
+                                .setCommandBufferCount(nb_slots);
+    auto command_buffers = this->logical_device.allocateCommandBuffers(command_buffer_allocate_info);
+    for (uint32_t s = 0; s < nb_slots; ++s)
+    {
+        Frame& frame = frames[s];
+        allocate_buffer(image_size, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                        frame.buffer, frame.memory);
+        frame.mapped_memory = this->logical_device.mapMemory(frame.memory, 0, image_size);
+        frame.descriptor_set = descriptor_sets[s];
+        frame.command_buffer = command_buffers[s];
+        frame.fence = this->logical_device.createFence(vk::FenceCreateInfo{}, nullptr);
+
+        std::array<vk::DescriptorBufferInfo, 3> buffer_infos;
+        buffer_infos[0].setBuffer(frame.buffer).setOffset(0).setRange(image_size);
+        buffer_infos[1].setBuffer(this->palette_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+        buffer_infos[2].setBuffer(this->tile_counter_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+        std::array<vk::WriteDescriptorSet, 3> writes;
+        for (uint32_t b = 0; b < writes.size(); ++b)
+            writes[b].setDstSet(frame.descriptor_set)
+                     .setDstBinding(b)
+                     .setDescriptorCount(1)
+                     .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                     .setPBufferInfo(&buffer_infos[b]);
+        this->logical_device.updateDescriptorSets(uint32_t(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    // Attend la fin du calcul de l'image contenue dans frame puis la sauvegarde (pendant ce temps, le GPU calcule les
+    // images suivantes dans les autres buffers)
+    double wait_time = 0., encode_time = 0.;
+    auto finish = [&](Frame& frame)
+    {
+        auto beg_wait = std::chrono::high_resolution_clock::now();
+        vk::Result result = this->logical_device.waitForFences(1, &frame.fence, vk::True, 100'000'000'000);
+        if (result != vk::Result::eSuccess)
+            std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << " lors de la synchronisation avec la barrière" << std::endl;
+        auto end_wait = std::chrono::high_resolution_clock::now();
+        wait_time += std::chrono::duration<double, std::milli>(end_wait - beg_wait).count();
+        vk::MappedMemoryRange frame_range;
+        frame_range.setMemory(frame.memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+        this->logical_device.invalidateMappedMemoryRanges(frame_range);
+        std::string number = std::to_string(frame.index);
+        number.insert(0, number.size() < 5 ? 5 - number.size() : 0, '0');
+        save_image(frame.mapped_memory, view.width, view.height, this->output_format, prefix + number + ".png", view.max_iter);
+        encode_time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - end_wait).count();
+        frame.index = -1;
+    };
+
+    vk::MemoryBarrier host_barrier;
+    host_barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eHostRead);
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    this->pt_dbg_utils->create_messenger();
+    for (int k = 0; k < nb_frames; ++k)
+    {
+        Frame& frame = frames[k % nb_slots];
+        // Le buffer est libre dès que l'image qu'il contenait (k - nb_slots) est sauvegardée
+        if (frame.index >= 0) finish(frame);
+        this->logical_device.resetFences(1, &frame.fence);
+
+        mandelbrot::View frame_view = view;
+        frame_view.extent = view.extent * std::pow(animation_zoom_factor, float(k));
+        MainParameters parameters{frame_view, 0};
+        frame.command_buffer.reset();
+        vk::CommandBufferBeginInfo begin_info;
+        begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        frame.command_buffer.begin(begin_info);
+        record_image_clear(frame_view, frame.command_buffer, frame.buffer);
+        frame.command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->pipeline);
+        frame.command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, this->pipeline_layout, 0, 1, &frame.descriptor_set, 0, nullptr);
+        frame.command_buffer.pushConstants(this->pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(MainParameters), &parameters);
+        frame.command_buffer.dispatch(uint32_t(std::ceil(view.width/float(workgroup_size))), uint32_t(std::ceil(view.height/float(workgroup_size))), 1);
+        frame.command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost, {},
+                                             1, &host_barrier, 0, nullptr, 0, nullptr);
+        frame.command_buffer.end();
+
+        vk::SubmitInfo submit_info;
+        submit_info.setCommandBufferCount(1)
+                   .setPCommandBuffers(&frame.command_buffer);
+        vk::Result result = this->queue.submit(1, &submit_info, frame.fence);
+        if (result != vk::Result::eSuccess)
+            std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << " lors de la soumission du buffer de commande à la queue" << std::endl;
+        frame.index = k;
+    }
+    // Images encore en vol, dans l'ordre
+    for (int k = std::max(0, nb_frames - int(nb_slots)); k < nb_frames; ++k)
+        finish(frames[k % nb_slots]);
+    this->pt_dbg_utils->destroy_messenger();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+
+    for (auto& frame : frames)
+    {
+        this->logical_device.unmapMemory(frame.memory);
+        this->logical_device.freeMemory(frame.memory, nullptr);
+        this->logical_device.destroyBuffer(frame.buffer, nullptr);
+        this->logical_device.destroyFence(frame.fence, nullptr);
+    }
+    this->logical_device.freeCommandBuffers(this->command_pool, command_buffers);
+    this->logical_device.destroyDescriptorPool(frame_descriptor_pool, nullptr);
+
+    std::cout << "Animation de " << nb_frames << " images (" << view.width << "x" << view.height << ", " << nb_slots
+              << " en vol) : " << time << "[ms], " << 1000.*nb_frames/time << " images par seconde. Attente du gpu : "
+              << wait_time << "[ms], sauvegarde : " << encode_time << "[ms]" << std::endl;
+    return time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::render_streamed(mandelbrot::View const& view, std::string const& filename, int strip_rows)
+{
+    if (this->output_format != mandelbrot::OutputFormat::rgba8)
+        throw std::runtime_error("Le rendu en bandes n'est disponible qu'au format rgba8");
+    // Le dernier groupe de travail d'une bande ne doit pas déborder sur le buffer : la hauteur des bandes est un multiple
+    // de celle des groupes (seule la dernière bande de l'image est incomplète, ses lignes au-delà de l'image sont ignorées)
+    strip_rows = std::max(1, (strip_rows + workgroup_size - 1)/workgroup_size) * workgroup_size;
+    const int nb_strips = (view.height + strip_rows - 1)/strip_rows;
+    const uint32_t nb_slots = uint32_t(std::min(2, nb_strips));
+    const vk::DeviceSize strip_size = mandelbrot::image_size_in_bytes(this->output_format, std::size_t(view.width) * std::size_t(strip_rows));
+
+    /*
+    Ressources de chaque bande en vol, comme pour les images d'une animation (voir render_animation) : buffer de stockage
+    d'une bande (mappé une fois pour toutes), ensemble de descripteurs, buffer de commande et barrière.
+    */
+    struct Strip
+    {
+        vk::Buffer        buffer{nullptr};
+        vk::DeviceMemory  memory{nullptr};
+        void*             mapped_memory{nullptr};
+        vk::DescriptorSet descriptor_set;
+        vk::CommandBuffer command_buffer;
+        vk::Fence         fence;
+        int               row_begin{-1};  // Première ligne de la bande en cours de calcul dans ce buffer (-1 : aucune)
+        int               row_end{-1};
+    };
+    std::vector<Strip> strips(nb_slots);
+
+    vk::DescriptorPoolSize pool_size;
+    pool_size.setType(vk::DescriptorType::eStorageBuffer)
+             .setDescriptorCount(3*nb_slots);
+    vk::DescriptorPoolCreateInfo pool_create_info;
+    pool_create_info.setMaxSets(nb_slots)
+                    .setPoolSizeCount(1)
+                    .setPPoolSizes(&pool_size);
+    vk::DescriptorPool strip_descriptor_pool = this->logical_device.createDescriptorPool(pool_create_info, nullptr);
+    std::vector<vk::DescriptorSetLayout> layouts(nb_slots, this->descriptor_set_layout);
+    vk::DescriptorSetAllocateInfo set_allocate_info;
+    set_allocate_info.setDescriptorPool(strip_descriptor_pool)
+                     .setDescriptorSetCount(nb_slots)
+                     .setPSetLayouts(layouts.data());
+    auto descriptor_sets = this->logical_device.allocateDescriptorSets(set_allocate_info);
+    vk::CommandBufferAllocateInfo command_buffer_allocate_info;
+    command_buffer_allocate_info.setCommandPool(this->command_pool)
+                                .setLevel(vk::CommandBufferLevel::ePrimary)
+                                .setCommandBufferCount(nb_slots);
+    auto command_buffers = this->logical_device.allocateCommandBuffers(command_buffer_allocate_info);
+    for (uint32_t s = 0; s < nb_slots; ++s)
+    {
+        Strip& strip = strips[s];
+        allocate_buffer(strip_size, vk::BufferUsageFlagBits::eStorageBuffer, strip.buffer, strip.memory);
+        strip.mapped_memory = this->logical_device.mapMemory(strip.memory, 0, strip_size);
+        strip.descriptor_set = descriptor_sets[s];
+        strip.command_buffer = command_buffers[s];
+        strip.fence = this->logical_device.createFence(vk::FenceCreateInfo{}, nullptr);
+
+        std::array<vk::DescriptorBufferInfo, 3> buffer_infos;
+        buffer_infos[0].setBuffer(strip.buffer).setOffset(0).setRange(strip_size);
+        buffer_infos[1].setBuffer(this->palette_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+        buffer_infos[2].setBuffer(this->tile_counter_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+        std::array<vk::WriteDescriptorSet, 3> writes;
+        for (uint32_t b = 0; b < writes.size(); ++b)
+            writes[b].setDstSet(strip.descriptor_set)
+                     .setDstBinding(b)
+                     .setDescriptorCount(1)
+                     .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                     .setPBufferInfo(&buffer_infos[b]);
+        this->logical_device.updateDescriptorSets(uint32_t(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    mandelbrot::PngStreamWriter writer(filename, view.width, view.height);
+
+    // Attend la fin du calcul de la bande contenue dans strip puis l'ajoute au png (pendant ce temps, le GPU calcule la
+    // bande suivante dans l'autre buffer). Les bandes sont terminées dans l'ordre des lignes.
+    double wait_time = 0., encode_time = 0.;
+    auto finish = [&](Strip& strip)
+    {
+        auto beg_wait = std::chrono::high_resolution_clock::now();
+        vk::Result result = this->logical_device.waitForFences(1, &strip.fence, vk::True, 100'000'000'000);
+        if (result != vk::Result::eSuccess)
+            std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << " lors de la synchronisation avec la barrière" << std::endl;
+        auto end_wait = std::chrono::high_resolution_clock::now();
+        wait_time += std::chrono::duration<double, std::milli>(end_wait - beg_wait).count();
+        vk::MappedMemoryRange strip_range;
+        strip_range.setMemory(strip.memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+        this->logical_device.invalidateMappedMemoryRanges(strip_range);
+        writer.write_rows(static_cast<unsigned char const*>(strip.mapped_memory), strip.row_end - strip.row_begin);
+        encode_time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - end_wait).count();
+        strip.row_begin = strip.row_end = -1;
+    };
+
+    vk::MemoryBarrier host_barrier;
+    host_barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eHostRead);
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    this->pt_dbg_utils->create_messenger();
+    for (int k = 0; k < nb_strips; ++k)
+    {
+        Strip& strip = strips[k % nb_slots];
+        if (strip.row_begin >= 0) finish(strip);
+        this->logical_device.resetFences(1, &strip.fence);
+
+        const int row_begin = k * strip_rows, row_end = std::min(view.height, row_begin + strip_rows);
+        MainParameters parameters{view, row_begin, row_begin};
+        strip.command_buffer.reset();
+        vk::CommandBufferBeginInfo begin_info;
+        begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        strip.command_buffer.begin(begin_info);
+        strip.command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->pipeline);
+        strip.command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, this->pipeline_layout, 0, 1, &strip.descriptor_set, 0, nullptr);
+        strip.command_buffer.pushConstants(this->pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(MainParameters), &parameters);
+        strip.command_buffer.dispatch(uint32_t(std::ceil(view.width/float(workgroup_size))),
+                                      uint32_t(std::ceil((row_end - row_begin)/float(workgroup_size))), 1);
+        strip.command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost, {},
+                                             1, &host_barrier, 0, nullptr, 0, nullptr);
+        strip.command_buffer.end();
+
+        vk::SubmitInfo submit_info;
+        submit_info.setCommandBufferCount(1)
+                   .setPCommandBuffers(&strip.command_buffer);
+        vk::Result result = this->queue.submit(1, &submit_info, strip.fence);
+        if (result != vk::Result::eSuccess)
+            std::cerr << ansi::BRed << ansi::Black << " Erreur " << ansi::Normal << " lors de la soumission du buffer de commande à la queue" << std::endl;
+        strip.row_begin = row_begin;
+        strip.row_end   = row_end;
+    }
+    // Bandes encore en vol, dans l'ordre
+    for (int k = std::max(0, nb_strips - int(nb_slots)); k < nb_strips; ++k)
+        finish(strips[k % nb_slots]);
+    auto beg_close = std::chrono::high_resolution_clock::now();
+    writer.finish();
+    encode_time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - beg_close).count();
+    this->pt_dbg_utils->destroy_messenger();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+
+    for (auto& strip : strips)
+    {
+        this->logical_device.unmapMemory(strip.memory);
+        this->logical_device.freeMemory(strip.memory, nullptr);
+        this->logical_device.destroyBuffer(strip.buffer, nullptr);
+        this->logical_device.destroyFence(strip.fence, nullptr);
+    }
+    this->logical_device.freeCommandBuffers(this->command_pool, command_buffers);
+    this->logical_device.destroyDescriptorPool(strip_descriptor_pool, nullptr);
+
+    const double nb_pixels = double(view.width) * double(view.height);
+    std::cout << "Rendu en bandes " << view.width << "x" << view.height << " (" << nb_strips << " bandes de " << strip_rows
+              << " lignes) : " << time << "[ms], " << nb_pixels/(1000.*time) << " Mpixels/s. Attente du gpu : " << wait_time
+              << "[ms], filtrage et compression : " << encode_time << "[ms]" << std::endl;
+    std::cout << "Mémoire : " << double(nb_slots*strip_size + writer.memory_usage())/(1024*1024) << " Mo (" << nb_slots
+              << " bandes et écriture du png) au lieu de " << 2.*nb_pixels*sizeof(uint32_t)/(1024*1024)
+              << " Mo pour l'image entière et son encodage. Fichier " << filename << " : "
+              << double(writer.compressed_size())/(1024*1024) << " Mo" << std::endl;
+    return time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::render_tiles(std::vector<mandelbrot::View> const& views, std::vector<std::uint32_t*> const& images)
+{
+    if (this->output_format != mandelbrot::OutputFormat::rgba8)
+        throw std::runtime_error("Le rendu de tuiles n'est disponible qu'au format rgba8");
+    const uint32_t nb_tiles = uint32_t(views.size());
+    if (nb_tiles == 0) return 0.;
+
+    // Les tuiles sont rangées les unes après les autres dans un même buffer, chacune à un décalage multiple de
+    // l'alignement exigé pour les buffers de stockage
+    const vk::DeviceSize alignment = std::max<vk::DeviceSize>(4, this->physical_device.getProperties().limits.minStorageBufferOffsetAlignment);
+    std::vector<vk::DeviceSize> offsets(nb_tiles + 1, 0);
+    for (uint32_t t = 0; t < nb_tiles; ++t)
+    {
+        vk::DeviceSize size = mandelbrot::image_size_in_bytes(this->output_format, std::size_t(views[t].width) * std::size_t(views[t].height));
+        offsets[t + 1] = offsets[t] + (size + alignment - 1)/alignment*alignment;
+    }
+    if (offsets[nb_tiles] > this->tiles_capacity)
+    {
+        allocate_buffer(offsets[nb_tiles], vk::BufferUsageFlagBits::eStorageBuffer, this->tiles_buffer, this->tiles_memory);
+        this->tiles_capacity = offsets[nb_tiles];
+    }
+
+    // Un ensemble de descripteurs par tuile (sa partie du buffer, la palette et le compteur de tuiles), alloués dans un
+    // réservoir propre au lot
+    vk::DescriptorPoolSize pool_size;
+    pool_size.setType(vk::DescriptorType::eStorageBuffer)
+             .setDescriptorCount(3*nb_tiles);
+    vk::DescriptorPoolCreateInfo pool_create_info;
+    pool_create_info.setMaxSets(nb_tiles)
+                    .setPoolSizeCount(1)
+                    .setPPoolSizes(&pool_size);
+    vk::DescriptorPool tiles_descriptor_pool = this->logical_device.createDescriptorPool(pool_create_info, nullptr);
+    std::vector<vk::DescriptorSetLayout> layouts(nb_tiles, this->descriptor_set_layout);
+    vk::DescriptorSetAllocateInfo set_allocate_info;
+    set_allocate_info.setDescriptorPool(tiles_descriptor_pool)
+                     .setDescriptorSetCount(nb_tiles)
+                     .setPSetLayouts(layouts.data());
+    auto descriptor_sets = this->logical_device.allocateDescriptorSets(set_allocate_info);
+    std::vector<vk::DescriptorBufferInfo> buffer_infos(3*nb_tiles);
+    std::vector<vk::WriteDescriptorSet> writes(3*nb_tiles);
+    for (uint32_t t = 0; t < nb_tiles; ++t)
+    {
+        buffer_infos[3*t  ].setBuffer(this->tiles_buffer).setOffset(offsets[t]).setRange(offsets[t + 1] - offsets[t]);
+        buffer_infos[3*t+1].setBuffer(this->palette_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+        buffer_infos[3*t+2].setBuffer(this->tile_counter_buffer).setOffset(0).setRange(VK_WHOLE_SIZE);
+        for (uint32_t b = 0; b < 3; ++b)
+            writes[3*t+b].setDstSet(descriptor_sets[t])
+                         .setDstBinding(b)
+                         .setDescriptorCount(1)
+                         .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                         .setPBufferInfo(&buffer_infos[3*t+b]);
+    }
+    this->logical_device.updateDescriptorSets(uint32_t(writes.size()), writes.data(), 0, nullptr);
+
+    // Toutes les tuiles du lot sont calculées par un seul buffer de commande (un dispatch par tuile, sans barrière entre
+    // eux puisqu'ils écrivent dans des parties disjointes du buffer)
+    this->command_buffer.reset();
+    vk::CommandBufferBeginInfo begin_info;
+    begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    this->command_buffer.begin(begin_info);
+    this->command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->pipeline);
+    for (uint32_t t = 0; t < nb_tiles; ++t)
+    {
+        MainParameters parameters{views[t], 0};
+        this->command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, this->pipeline_layout, 0, 1, &descriptor_sets[t], 0, nullptr);
+        this->command_buffer.pushConstants(this->pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(MainParameters), &parameters);
+        this->command_buffer.dispatch(uint32_t(std::ceil(views[t].width/float(workgroup_size))),
+                                      uint32_t(std::ceil(views[t].height/float(workgroup_size))), 1);
+    }
+    vk::MemoryBarrier host_barrier;
+    host_barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eHostRead);
+    this->command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost, {},
+                                         1, &host_barrier, 0, nullptr, 0, nullptr);
+    this->command_buffer.end();
+
+    auto beg_time = std::chrono::high_resolution_clock::now();
+    this->pt_dbg_utils->create_messenger();
+    run_command_buffer();
+    this->pt_dbg_utils->destroy_messenger();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double gpu_time = std::chrono::duration<double, std::milli>(end_time - beg_time).count();
+
+    void* mapped_memory = this->logical_device.mapMemory(this->tiles_memory, 0, offsets[nb_tiles]);
+    vk::MappedMemoryRange tiles_range;
+    tiles_range.setMemory(this->tiles_memory).setOffset(0).setSize(VK_WHOLE_SIZE);
+    this->logical_device.invalidateMappedMemoryRanges(tiles_range);
+    for (uint32_t t = 0; t < nb_tiles; ++t)
+        std::memcpy(images[t], static_cast<char const*>(mapped_memory) + offsets[t],
+                    std::size_t(views[t].width) * std::size_t(views[t].height) * sizeof(std::uint32_t));
+    this->logical_device.unmapMemory(this->tiles_memory);
+    this->logical_device.destroyDescriptorPool(tiles_descriptor_pool, nullptr);
+    return gpu_time;
+}
+// --------------------------------------------------------------------------------------------------------------------
+double
+ComputingPipeline::run()
+{
+    initialize();
+    double gpu_time = render(this->view);
+    save_gpu_image("mandelbrot_gpu.png");
     // On libère toutes les ressources prises par Vulkan :
     clean_up();
+    return gpu_time;
 }
 
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include <memory>
 #include <vulkan/vulkan.hpp>
 #include "debug_utils.hpp"
+#include "cpu_kernels.hpp"
+#include "perturbation.hpp"
 #ifdef NDEBUG
 constexpr bool enableValidationLayers = false;
 #else
@@ -9,13 +11,10 @@ constexpr bool enableValidationLayers = true;
 
 namespace vulkan
 {
-constexpr const int width  = 3200; // Taille en x du rendu de l'ensemble de mandelbrot
-constexpr const int height = 2400; // Taille en y du rendu de l'ensemble de mandelbrot
-
 class ComputingPipeline
 {
 public:
-    struct Pixel { float r,g, b, a; };
+    using Pixel = mandelbrot::Pixel;
 
     ComputingPipeline() = default;
 
@@ -55,10 +54,16 @@ public:
     uint32_t find_memory_type(uint32_t memory_type_bits, vk::MemoryPropertyFlags properties);
 
     /**
-     * @brief Crée un buffer de stockage qui servira pour stocker l'image de mandelbrot.
+     * @brief Crée (ou recrée avec une nouvelle taille) le buffer de stockage qui servira pour stocker l'image de mandelbrot.
      * 
+     * @param size Taille du buffer en octets
+     */
+    void create_buffer(vk::DeviceSize size);
+
+    /**
+     * @brief Crée un buffer et alloue sa mémoire (visible par l'hôte). Si buffer existe déjà, il est d'abord détruit.
      */
-    void create_buffer();
+    void allocate_buffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::Buffer& buffer, vk::DeviceMemory& buffer_memory);
 
     //@name Gestion des descripteurs
     //@{
@@ -73,6 +78,23 @@ public:
      * 
      */
     void create_descriptor_set();
+
+    /**
+     * @brief Relie le buffer de stockage courant à l'ensemble de descripteurs (à refaire à chaque recréation du buffer)
+     */
+    void update_descriptor_set();
+
+    /**
+     * @brief Crée le buffer contenant la palette précalculée (mandelbrot::cosine_palette), la remplit et la relie au
+     *        point de liaison 1 de l'ensemble de descripteurs
+     */
+    void create_palette_buffer();
+
+    /**
+     * @brief Crée le compteur de tuiles des threads persistants (un entier, suivi du coût de chaque tuile pour
+     *        render_profiled) et le relie au point de liaison 2 de l'ensemble de descripteurs. L'ancien buffer est libéré.
+     */
+    void create_tile_counter_buffer(vk::DeviceSize size = sizeof(uint32_t));
     //@}
 
     /**
@@ -81,17 +103,432 @@ public:
      */
     void create_compute_pipeline();
 
+    /**
+     * @brief Crée un pipeline du shader principal avec les constantes de spécialisation courantes (raccourcis, format
+     *        de l'image, coloration continue). Le module et la disposition sont ceux de create_compute_pipeline.
+     *
+     * @param persistent_threads Si vrai, les groupes de travail prennent les tuiles dans le compteur de tuiles (voir
+     *                           render_persistent) au lieu d'en calculer une chacun
+     * @param profiling          Si vrai, chaque groupe écrit le nombre d'itérations de sa tuile (voir render_profiled)
+     */
+    vk::Pipeline create_main_pipeline(bool persistent_threads, bool profiling = false);
+
     void create_command_buffer();
 
+    /**
+     * @brief Enregistre dans le buffer de commande le calcul de l'ensemble de mandelbrot pour les paramètres view
+     */
+    void record_command_buffer(mandelbrot::View const& view);
+
+    /**
+     * @brief Enregistre la remise à zéro de l'image (format iterations16, dont les mots sont complétés par atomicOr) et
+     *        la barrière qui la rend visible au shader. Ne fait rien pour les autres formats.
+     */
+    void record_image_clear(mandelbrot::View const& view);
+
+    /**
+     * @brief Même chose dans le buffer de commande command_buffer pour l'image contenue dans buffer (animation)
+     */
+    void record_image_clear(mandelbrot::View const& view, vk::CommandBuffer command_buffer, vk::Buffer buffer);
+
     void run_command_buffer();
 
-    void run();
+    /**
+     * @brief Initialise Vulkan et crée le pipeline de calcul (le buffer de stockage est créé au premier rendu)
+     */
+    void initialize();
 
-    void save_rendered_image(Pixel* pmapped_memory, std::string const& filename);
+    /**
+     * @brief Calcule sur GPU l'ensemble de mandelbrot pour les paramètres view
+     *
+     * Le buffer de stockage est agrandi si besoin. Le pipeline n'est jamais recréé : on peut enchaîner des rendus de
+     * résolutions et de fenêtres différentes après un seul appel à initialize().
+     *
+     * @return Le temps (en millisecondes) d'exécution du buffer de commande
+     */
+    double render(mandelbrot::View const& view);
+
+    /**
+     * @brief Sauvegarde au format png l'image du dernier rendu GPU
+     */
+    void save_gpu_image(std::string const& filename);
+
+    //@name Calcul avec reprise (shader resume.comp)
+    //@{
+    /**
+     * @brief Crée le pipeline de calcul du shader resume.comp et son ensemble de descripteurs
+     */
+    void create_resume_pipeline();
+
+    /**
+     * @brief Relie l'image, les états des pixels et la liste des pixels actifs à l'ensemble de descripteurs de resume.comp
+     */
+    void update_resume_descriptor_set();
+
+    /**
+     * @brief Calcule sur GPU l'ensemble de mandelbrot en conservant l'état de la suite de chaque pixel
+     *
+     * Si le rendu précédent a la même taille et la même fenêtre avec un nombre maximal d'itérations inférieur ou égal,
+     * seuls les pixels n'ayant pas divergé (liste compacte) sont repris depuis leur dernier itéré. Sinon tous les pixels
+     * sont calculés depuis z = 0. Le pipeline est créé au premier appel (après initialize()).
+     *
+     * @return Le temps (en millisecondes) d'exécution du buffer de commande
+     */
+    double render_resumable(mandelbrot::View const& view);
+    //@}
+
+    //@name Zoom profond par perturbation (shaders perturbation_double.comp et perturbation.comp)
+    //@{
+    /**
+     * @brief Crée le pipeline de calcul du zoom profond et son ensemble de descripteurs
+     *
+     * Les écarts sont itérés en double précision (perturbation_double.comp) si le périphérique propose shaderFloat64,
+     * en simple précision avec facteur d'échelle (perturbation.comp, moins exact) sinon.
+     */
+    void create_perturbation_pipeline();
+
+    /**
+     * @brief Relie l'image, la palette, l'orbite de référence et les listes de pixels glitchés à l'ensemble de
+     *        descripteurs du zoom profond
+     */
+    void update_perturbation_descriptor_set();
+
+    /**
+     * @brief Calcule sur GPU l'ensemble de mandelbrot en zoom profond par la méthode des perturbations
+     *
+     * L'orbite de référence du centre est calculée sur CPU en précision étendue puis copiée dans un buffer de stockage
+     * (agrandi si besoin). Le pipeline est créé au premier appel (après initialize()). Comme dans
+     * cpu_perturbation_computation, les pixels glitchés (critère de Pauldelbrot) sont rangés par le shader dans une
+     * liste, puis eux seuls sont recalculés avec une orbite secondaire centrée sur l'un d'eux, jusqu'à
+     * mandelbrot::max_secondary_orbits orbites ; les pixels restants sont calculés avec l'orbite du centre sans détection.
+     *
+     * @return Le temps (en millisecondes) d'exécution des buffers de commande de tous les passages
+     */
+    double render_perturbation(mandelbrot::DeepView const& view);
+    //@}
+
+    //@name Choix de l'arithmétique (shaders shader.comp, double_single.comp et double.comp)
+    //@{
+    /**
+     * @brief Indique si le périphérique propose la double précision dans les shaders (fonctionnalité shaderFloat64)
+     */
+    bool supports_float64() const { return this->float64_supported; }
+
+    /**
+     * @brief Crée les pipelines de calcul en double simple et, si le périphérique le permet, en double précision
+     *
+     * Ces pipelines partagent l'ensemble de descripteurs du pipeline principal (seule l'image est utilisée).
+     */
+    void create_precision_pipelines();
+
+    /**
+     * @brief Choisit l'arithmétique d'un rendu d'après la fenêtre demandée et les fonctionnalités du périphérique
+     *
+     * La simple précision est choisie si elle suffit, sinon la double simple si elle suffit (elle n'utilise que les unités
+     * simple précision, bien plus nombreuses que les unités double précision sur la plupart des GPU), sinon la double
+     * précision native si elle est disponible. Au-delà, on prend l'arithmétique la plus précise disponible (il faut
+     * alors passer à la méthode des perturbations).
+     */
+    mandelbrot::Precision choose_precision(mandelbrot::PreciseView const& view) const;
+
+    /**
+     * @brief Calcule sur GPU l'ensemble de mandelbrot avec l'arithmétique demandée (après initialize())
+     *
+     * @return Le temps (en millisecondes) d'exécution du buffer de commande
+     */
+    double render_precise(mandelbrot::PreciseView const& view, mandelbrot::Precision precision);
+    //@}
+
+    //@name Rendu en deux passes : carte des nombres d'itérations puis mise en couleur (shader colorize.comp)
+    //@{
+    /**
+     * @brief Crée le pipeline de calcul du shader colorize.comp et son ensemble de descripteurs
+     */
+    void create_colorize_pipeline();
+
+    /**
+     * @brief Relie l'image couleur, la palette, la carte des nombres d'itérations (buffer du dernier rendu), l'histogramme
+     *        et la fonction de répartition à l'ensemble de descripteurs de colorize.comp
+     */
+    void update_colorize_descriptor_set();
+
+    /**
+     * @brief Met en couleur sur GPU la carte des nombres d'itérations du dernier rendu, sans itérer de nouveau
+     *
+     * Le dernier rendu doit avoir été fait au format mandelbrot::OutputFormat::iteration_map. L'image couleur (RGBA sur
+     * 4 octets) est écrite dans un buffer séparé : la carte est conservée et on peut enchaîner les mises en couleur. Le
+     * pipeline est créé au premier appel (après initialize()).
+     *
+     * @return Le temps (en millisecondes) d'exécution du buffer de commande
+     */
+    double recolor(mandelbrot::Coloring const& coloring);
+
+    /**
+     * @brief Sauvegarde au format png l'image de la dernière mise en couleur GPU (recolor)
+     */
+    void save_recolored_image(std::string const& filename);
+    //@}
+
+    //@name Équilibrage de charge par threads persistants (shader shader.comp)
+    //@{
+    /**
+     * @brief Calcule sur GPU l'ensemble de mandelbrot avec nb_workgroups groupes de travail persistants
+     *
+     * Chaque groupe tire une tuile de workgroup_size x workgroup_size pixels dans un compteur atomique, la calcule, puis
+     * recommence jusqu'à ce que l'image soit finie : le coût très inégal des tuiles (intérieur de l'ensemble contre
+     * pixels divergeant tôt) est réparti dynamiquement. Même image et même format que render. Le pipeline est créé au
+     * premier appel (après initialize()).
+     *
+     * @return Le temps (en millisecondes) d'exécution du buffer de commande
+     */
+    double render_persistent(mandelbrot::View const& view, uint32_t nb_workgroups);
+
+    /**
+     * @brief Compare la répartition statique (render) aux threads persistants pour plusieurs nombres de groupes
+     *
+     * Chaque configuration est rendue nb_repetitions fois (on garde le meilleur temps) et son image est comparée à celle
+     * de la répartition statique.
+     *
+     * @return Le nombre de groupes persistants le plus rapide (0 si l'image a moins de tuiles que le plus petit essayé)
+     */
+    uint32_t benchmark_persistent(mandelbrot::View const& view, int nb_repetitions = 5);
+    //@}
+
+    //@name Instrumentation (noyau CPU instrumenté et shader shader.comp)
+    //@{
+    /**
+     * @brief Calcule l'image comme render (un groupe de travail par tuile) en relevant le nombre d'itérations calculées
+     *        par chaque groupe de travail
+     *
+     * Les coûts sont écrits par le shader à la suite du compteur de tuiles, agrandi si besoin. Le pipeline est créé au
+     * premier appel (après initialize()).
+     *
+     * @param profile Reçoit le coût des tuiles et la durée du calcul (sans les champs des threads)
+     * @return Le temps (en millisecondes) d'exécution du buffer de commande
+     */
+    double render_profiled(mandelbrot::View const& view, mandelbrot::IterationProfile& profile);
+
+    /**
+     * @brief Calcule l'image des paramètres courants avec le noyau CPU instrumenté et le shader instrumenté, puis
+     *        sauvegarde les cartes de chaleur des tuiles (mandelbrot_chaleur_cpu.png, mandelbrot_chaleur_gpu.png) et le
+     *        résumé instrumentation.json. Ensemble de mandelbrot usuel seulement. Après initialize().
+     */
+    void profiling_computation();
+    //@}
+
+    /**
+     * @brief Calcule et sauvegarde une animation de zoom de nb_frames images avec frames_in_flight images en vol
+     *
+     * L'image k a l'étendue view.extent*0.98^k et est sauvegardée dans prefix suivi de k sur cinq chiffres (.png). Le
+     * pipeline est celui de initialize() ; chaque image en vol a son buffer de stockage, son ensemble de descripteurs,
+     * son buffer de commande et sa barrière : pendant que le CPU encode l'image k, le GPU calcule les suivantes.
+     *
+     * @return Le temps total (en millisecondes), calcul et sauvegarde compris
+     */
+    double render_animation(mandelbrot::View const& view, int nb_frames, int frames_in_flight, std::string const& prefix);
+
+    /**
+     * @brief Calcule sur GPU un lot de tuiles (format rgba8) en une seule soumission
+     *
+     * Chaque tuile a sa partie d'un même buffer de stockage et son ensemble de descripteurs : le lot est enregistré dans
+     * un seul buffer de commande (un dispatch par tuile) et on n'attend qu'une fois la fin du calcul. Utilisé par le
+     * serveur de tuiles (mandelbrot::TileServer). Après initialize().
+     *
+     * @param images Pour chaque tuile, un tableau de views[t].width*views[t].height pixels recevant l'image
+     * @return Le temps (en millisecondes) d'exécution du buffer de commande
+     */
+    double render_tiles(std::vector<mandelbrot::View> const& views, std::vector<std::uint32_t*> const& images);
+
+    /**
+     * @brief Calcule sur GPU une image de taille quelconque (format rgba8) par bandes horizontales écrites au fur et à
+     *        mesure dans le png filename, sans jamais garder l'image entière en mémoire
+     *
+     * Deux buffers de strip_rows lignes (arrondi à un multiple de la hauteur des groupes de travail) sont utilisés
+     * alternativement : pendant que le CPU filtre et compresse une bande (mandelbrot::PngStreamWriter), le GPU calcule
+     * la suivante. La mémoire utilisée ne dépend que de la largeur de l'image. Après initialize().
+     *
+     * @return Le temps total (en millisecondes), calcul et écriture compris
+     */
+    double render_streamed(mandelbrot::View const& view, std::string const& filename, int strip_rows = 256);
+
+    //@name Co-rendu CPU+GPU (noyaux CPU et shader shader.comp)
+    //@{
+    /**
+     * @brief Calcule sur GPU les lignes row_begin <= i < row_end de l'image (le buffer de stockage doit contenir toute
+     *        l'image, à laquelle les lignes sont écrites à leur place) et attend la fin du calcul
+     */
+    void render_rows(mandelbrot::View const& view, int row_begin, int row_end);
+
+    /**
+     * @brief Calcule une image (format rgba8) en partageant ses bandes de lignes entre les threads OpenMP et le GPU
+     *
+     * Une file de lignes alimente à la fois les threads CPU (une ligne à la fois) et un thread pilotant le GPU (des lots
+     * de lignes consécutives, de plus en plus petits à mesure que la file se vide, jusqu'à une seule ligne), pour que CPU
+     * et GPU finissent ensemble.
+     * Seuls le format rgba8 et les nombres d'itérations entiers sont pris en charge. Après initialize().
+     *
+     * @param image Tableau de view.width*view.height pixels recevant l'image
+     * @return Le temps (en millisecondes) du co-rendu
+     */
+    double co_render(mandelbrot::View const& view, std::uint32_t* image);
+
+    /**
+     * @brief Compare pour les paramètres courants le co-rendu CPU+GPU au calcul sur CPU seul et sur GPU seul, puis
+     *        sauvegarde l'image co-rendue dans mandelbrot_corendu.png. Après initialize().
+     */
+    void co_rendering_computation();
+    //@}
+
+    //@name Anticrénelage par suréchantillonnage adaptatif (shader supersample.comp)
+    //@{
+    /**
+     * @brief Crée le pipeline de calcul du shader supersample.comp (avec les raccourcis courants comme constantes de
+     *        spécialisation) et son ensemble de descripteurs
+     */
+    void create_supersample_pipeline();
+
+    /**
+     * @brief Relie l'image, la palette, la carte des nombres d'itérations et la liste des pixels à suréchantillonner à
+     *        l'ensemble de descripteurs de supersample.comp
+     */
+    void update_supersample_descriptor_set();
+
+    /**
+     * @brief Calcule sur GPU une image anticrénelée (format rgba8) en ne suréchantillonnant que les bords
+     *
+     * Mêmes trois passes que mandelbrot::compute_antialiased, enchaînées dans un seul buffer de commande : centre de
+     * chaque pixel, détection des bords (liste compacte remplie par compteur atomique) puis samples x samples points
+     * dans chaque pixel de la liste. Le pipeline est créé au premier appel (après initialize()). L'image se sauvegarde
+     * ensuite avec save_gpu_image.
+     *
+     * @param adaptive Si faux, tous les pixels sont suréchantillonnés (suréchantillonnage uniforme, pour comparaison)
+     * @return Le temps (en millisecondes) d'exécution du buffer de commande
+     */
+    double render_antialiased(mandelbrot::View const& view, int samples, bool adaptive = true);
+    //@}
+
+    /**
+     * @brief Initialise Vulkan, calcule l'ensemble de mandelbrot sur GPU pour les paramètres courants, le sauvegarde dans
+     *        mandelbrot_gpu.png et libère les ressources
+     *
+     * @return Le temps (en millisecondes) d'exécution du buffer de commande
+     */
+    double run();
+
+    void save_rendered_image(Pixel* pmapped_memory, int width, int height, std::string const& filename);
+
+    /**
+     * @brief Sauvegarde au format png une image au format format (voir mandelbrot::OutputFormat)
+     *
+     * Aux formats rgba8 et iterations16, les octets de l'image sont ceux attendus par l'encodeur : ils lui sont passés
+     * tels quels (directement depuis la mémoire mappée pour une image calculée sur GPU). Une carte des nombres
+     * d'itérations (format iteration_map) est d'abord mise en couleur linéairement sur CPU, d'où le paramètre max_iter.
+     */
+    void save_image(void const* pixels, int width, int height, mandelbrot::OutputFormat format, std::string const& filename,
+                    int max_iter = 0);
 
     void clean_up();
 
+    /**
+     * @brief Calcule l'ensemble de mandelbrot sur CPU et le sauvegarde dans mandelbrot_cpu.png
+     *
+     * Le calcul des itérations utilise le jeu d'instructions vectorielles le plus large disponible (choisi à l'exécution)
+     * et est comparé, pixel par pixel, au calcul scalaire.
+     */
     void cpu_computation();
+
+    /**
+     * @brief Calcule sur CPU la carte des nombres d'itérations (continus si la coloration continue est choisie) puis la
+     *        met en couleur avec chacun des paramètres colorings, sans itérer de nouveau, et sauvegarde les images dans
+     *        mandelbrot_cpu_couleurs_k.png (k = 1, 2, ...)
+     */
+    void cpu_recolor_computation(std::vector<mandelbrot::Coloring> const& colorings);
+
+    /**
+     * @brief Calcule sur CPU une image anticrénelée par suréchantillonnage adaptatif (samples x samples points dans les
+     *        pixels des bords seulement), affiche la proportion de pixels suréchantillonnés et le coût par rapport à un
+     *        suréchantillonnage uniforme, puis la sauvegarde dans mandelbrot_cpu_anticrenelage.png
+     */
+    void cpu_antialiased_computation(int samples);
+
+    /**
+     * @brief Calcule sur CPU l'ensemble de mandelbrot pour les paramètres courants puis reprend le calcul jusqu'à max_iter
+     *        itérations, compare au calcul complet et sauvegarde le résultat dans mandelbrot_cpu_reprise.png
+     */
+    void cpu_resume_computation(int max_iter);
+
+    /**
+     * @brief Calcule sur CPU l'ensemble de mandelbrot en zoom profond par la méthode des perturbations, le compare au
+     *        calcul scalaire et, sur quelques pixels, au calcul direct en précision étendue, puis le sauvegarde dans
+     *        mandelbrot_cpu_profond.png
+     */
+    void cpu_perturbation_computation(mandelbrot::DeepView const& view);
+
+    /**
+     * @brief Calcule sur CPU l'ensemble de mandelbrot dans les trois arithmétiques (simple, double simple, double),
+     *        affiche leurs débits et leurs écarts au calcul en double, puis sauvegarde dans mandelbrot_cpu_precision.png
+     *        le rendu de la première arithmétique assez précise
+     *
+     * @return Le nombre total d'itérations du calcul en double (pour évaluer le débit des calculs GPU)
+     */
+    long long cpu_precision_computation(mandelbrot::PreciseView const& view);
+
+    /**
+     * @brief Choisit les raccourcis (combinaison de mandelbrot::Shortcut) utilisés par les calculs CPU et GPU
+     *
+     * Sur GPU, les raccourcis sont transmis au shader par des constantes de spécialisation : le compilateur du pilote
+     * élimine donc entièrement le code des tests non demandés.
+     */
+    void set_shortcuts(unsigned shortcuts) { this->shortcuts = shortcuts; }
+
+    /**
+     * @brief Choisit les paramètres du rendu (taille de l'image, fenêtre, nombre d'itérations) utilisés par cpu_computation et run
+     */
+    void set_view(mandelbrot::View const& view) { this->view = view; }
+
+    /**
+     * @brief Choisit le format de l'image écrite par cpu_computation et par le shader principal (render, run)
+     *
+     * Sur GPU, le format est une constante de spécialisation de shader.comp : il doit être choisi avant initialize().
+     * Les autres shaders (reprise, perturbation, double simple et double) écrivent toujours des couleurs en flottants.
+     */
+    void set_output_format(mandelbrot::OutputFormat format) { this->output_format = format; }
+
+    /**
+     * @brief Active la coloration continue (nombre d'itérations normalisé, voir mandelbrot::compute_iterations_smooth)
+     *
+     * Comme le format de l'image, c'est une constante de spécialisation de shader.comp : à choisir avant initialize().
+     */
+    void set_smooth_coloring(bool smooth) { this->smooth_coloring = smooth; }
+
+    /**
+     * @brief Active l'estimation de la distance au bord (voir mandelbrot::compute_distance_estimates) : les couleurs sont
+     *        assombries près du bord, ce qui fait apparaître les filaments avec un seul point par pixel
+     *
+     * Constante de spécialisation de shader.comp (à choisir avant initialize()), qui implique la coloration continue.
+     */
+    void set_distance_estimation(bool distance) { this->distance_estimation = distance; }
+
+    /**
+     * @brief Choisit la fractale calculée par cpu_computation et par le shader principal (famille, exposant, constante
+     *        de julia, voir mandelbrot::FractalFamily)
+     *
+     * Constantes de spécialisation de shader.comp, à choisir avant initialize(). Les autres modes de calcul ne
+     * concernent que l'ensemble de mandelbrot usuel.
+     */
+    void set_fractal(mandelbrot::FractalFamily const& fractal) { this->fractal = fractal; }
+
+    /**
+     * @brief Calcule l'image de cpu_computation par subdivision de Mariani-Silver (voir
+     *        mandelbrot::compute_iterations_subdivision) au lieu du calcul pixel par pixel, auquel elle est comparée
+     */
+    void set_subdivision(bool subdivision) { this->subdivision = subdivision; }
+
+    /**
+     * @brief Ajoute à cpu_computation la vérification du noyau générique des familles de fractales : son instanciation
+     *        pour l'ensemble de mandelbrot usuel est comparée aux noyaux dédiés (un calcul scalaire de plus)
+     */
+    void set_verification(bool verification) { this->verification = verification; }
 private:    
     /**
      * @brief Une instance contenant un contexte pour utiliser Vulkan
@@ -135,6 +572,16 @@ private:
     vk::PipelineLayout pipeline_layout;
     vk::ShaderModule   compute_shader_module;
 
+    // Constantes poussées du shader principal : paramètres du rendu, première ligne calculée (non nulle seulement pour
+    // les bandes du co-rendu CPU+GPU, voir render_rows, et du rendu en bandes) et ligne de l'image rangée au début du
+    // buffer (non nulle seulement pour le rendu en bandes, voir render_streamed, dont le buffer ne contient qu'une bande)
+    struct MainParameters
+    {
+        mandelbrot::View view;
+        int32_t first_row;
+        int32_t buffer_first_row = 0;
+    };
+
     /**
      * @brief Le buffer de commande utilisé pour enregistrer les commandes qui seront soumises à la queue de commande
      * 
@@ -214,9 +661,27 @@ private:
      * buffer est le tableau contigü 1D stocké sur la mémoire du périphérique 
      * buffer_memory est la partie du device qui va allouer/désallouer le buffer (sur la mémoire GPU ou la RAM selon ce qu'on aura définit dedans)
      */
-    vk::Buffer              buffer;
-    vk::DeviceMemory        buffer_memory;
-    uint32_t                buffer_size;
+    vk::Buffer              buffer{nullptr};
+    vk::DeviceMemory        buffer_memory{nullptr};
+    vk::DeviceSize          buffer_size{0};
+
+    // Palette précalculée (Palette::size couleurs RGBA en flottants), lue par shader.comp au point de liaison 1
+    vk::Buffer              palette_buffer{nullptr};
+    vk::DeviceMemory        palette_memory{nullptr};
+
+    // Compteur de tuiles des threads persistants (point de liaison 2) et pipeline correspondant (créé au premier appel
+    // de render_persistent, avec le module et la disposition du pipeline principal)
+    vk::Buffer              tile_counter_buffer{nullptr};
+    vk::DeviceMemory        tile_counter_memory{nullptr};
+    vk::Pipeline            persistent_pipeline{nullptr};
+    vk::DeviceSize          tile_counter_size{0};
+    // Pipeline instrumenté de render_profiled (créé au premier appel, même module et même disposition)
+    vk::Pipeline            profiling_pipeline{nullptr};
+
+    // Buffer des lots de tuiles de render_tiles (agrandi si besoin, jamais réduit)
+    vk::Buffer              tiles_buffer{nullptr};
+    vk::DeviceMemory        tiles_memory{nullptr};
+    vk::DeviceSize          tiles_capacity{0};
 
     /**
      * @brief Le queue de commande
@@ -242,6 +707,134 @@ private:
     uint32_t queue_family_index;    
 
     std::vector<const char *> enabled_layers{}, enabled_extensions{};
+    bool float64_supported{false}; // Fonctionnalité shaderFloat64 activée sur le périphérique logique
+
+    unsigned shortcuts{mandelbrot::no_shortcut}; // Raccourcis pour les points intérieurs (voir mandelbrot::Shortcut)
+    mandelbrot::View view{};                     // Paramètres du rendu utilisés par cpu_computation et run
+    mandelbrot::View rendered_view{};            // Paramètres du dernier rendu GPU (image contenue dans le buffer)
+    mandelbrot::OutputFormat output_format{mandelbrot::OutputFormat::rgba8};     // Format de l'image du shader principal
+    mandelbrot::OutputFormat rendered_format{mandelbrot::OutputFormat::rgba32f}; // Format de l'image contenue dans le buffer
+    bool smooth_coloring{false};                 // Coloration continue (cpu_computation et shader principal)
+    bool distance_estimation{false};             // Estimation de la distance au bord (cpu_computation et shader principal)
+    mandelbrot::FractalFamily fractal{};         // Fractale calculée par cpu_computation et le shader principal
+    bool subdivision{false};                     // Calcul CPU par subdivision de Mariani-Silver (cpu_computation)
+    bool verification{false};                    // Vérification du noyau générique des familles (cpu_computation)
+
+    /**
+     * @brief Ressources du calcul avec reprise (shader resume.comp)
+     *
+     * state_buffer contient l'état de la suite de chaque pixel (z, n, drapeau de divergence) et active_buffer un compteur
+     * suivi de deux listes de pixels actifs de resume_capacity indices chacune, utilisées alternativement en entrée et en sortie.
+     */
+    struct ResumeParameters
+    {
+        mandelbrot::View view;
+        uint32_t mode, nb_active_in, in_offset, out_offset;
+    };
+    vk::DescriptorSetLayout resume_descriptor_set_layout;
+    vk::DescriptorSet       resume_descriptor_set;
+    vk::PipelineLayout      resume_pipeline_layout;
+    vk::Pipeline            resume_pipeline{nullptr};
+    vk::ShaderModule        resume_shader_module;
+    vk::Buffer              state_buffer{nullptr}, active_buffer{nullptr};
+    vk::DeviceMemory        state_memory{nullptr}, active_memory{nullptr};
+    uint32_t                resume_capacity{0};   // Nombre de pixels que peuvent contenir state_buffer et chaque liste active
+    uint32_t                nb_active{0};         // Nombre de pixels actifs après le dernier calcul
+    uint32_t                active_in_offset{0};  // Position de la liste d'entrée de la prochaine reprise dans active[]
+    mandelbrot::View        resume_view{0, 0, 0.f, 0.f, 0.f, 0}; // Paramètres du dernier calcul avec reprise
+
+    /**
+     * @brief Ressources du zoom profond (shader perturbation_double.comp si le périphérique propose shaderFloat64,
+     *        perturbation.comp sinon)
+     *
+     * orbit_buffer contient l'orbite de référence (orbit_capacity points complexes en double précision, ou en simple
+     * précision pour perturbation.comp). glitch_buffer contient un compteur suivi de deux listes de glitch_capacity
+     * indices de pixels glitchés : liste d'entrée et liste de sortie d'un passage, échangées à chaque orbite secondaire.
+     */
+    struct PerturbationParameters
+    {
+        int32_t  width, height, max_iter, orbit_length;
+        float    scale, inv_scale, extent_scaled;                   // perturbation.comp
+        uint32_t mode;                                              // 0 : tous les pixels, 1 : pixels de la liste d'entrée
+        double   extent, offset_x, offset_y, tolerance2;            // perturbation_double.comp (déplacement 32)
+        float    offset_x_scaled, offset_y_scaled, tolerance2_single; // perturbation.comp (déplacement 64)
+        uint32_t nb_listed, in_offset, out_offset;                  // Listes d'entrée et de sortie (déplacement 76)
+    };
+    vk::DescriptorSetLayout perturbation_descriptor_set_layout;
+    vk::DescriptorSet       perturbation_descriptor_set;
+    vk::PipelineLayout      perturbation_pipeline_layout;
+    vk::Pipeline            perturbation_pipeline{nullptr};
+    vk::ShaderModule        perturbation_shader_module;
+    vk::Buffer              orbit_buffer{nullptr};
+    vk::DeviceMemory        orbit_memory{nullptr};
+    uint32_t                orbit_capacity{0};
+    vk::Buffer              glitch_buffer{nullptr};
+    vk::DeviceMemory        glitch_memory{nullptr};
+    uint32_t                glitch_capacity{0};
+
+    /**
+     * @brief Pipelines en double simple (double_single.comp) et en double précision (double.comp)
+     *
+     * Les constantes poussées du shader en double précision sont la structure mandelbrot::PreciseView elle-même.
+     */
+    struct DoubleSingleParameters
+    {
+        int32_t width, height;
+        float   center_x_hi, center_x_lo, center_y_hi, center_y_lo;
+        float   extent;
+        int32_t max_iter;
+    };
+    vk::PipelineLayout      double_single_pipeline_layout;
+    vk::Pipeline            double_single_pipeline{nullptr};
+    vk::ShaderModule        double_single_shader_module;
+    vk::PipelineLayout      double_pipeline_layout;
+    vk::Pipeline            double_pipeline{nullptr};
+    vk::ShaderModule        double_shader_module;
+
+    /**
+     * @brief Ressources de la mise en couleur d'une carte des nombres d'itérations (shader colorize.comp)
+     *
+     * color_buffer reçoit l'image couleur (color_capacity pixels), histogram_buffer et cdf_buffer l'histogramme et la
+     * fonction de répartition de l'égalisation d'histogramme (histogram_capacity cases et une valeur de plus).
+     */
+    struct ColoringParameters
+    {
+        int32_t  nb_pixels, max_iter;
+        uint32_t mode, mapping;
+        float    density, offset;
+    };
+    vk::DescriptorSetLayout colorize_descriptor_set_layout;
+    vk::DescriptorSet       colorize_descriptor_set;
+    vk::PipelineLayout      colorize_pipeline_layout;
+    vk::Pipeline            colorize_pipeline{nullptr};
+    vk::ShaderModule        colorize_shader_module;
+    vk::Buffer              color_buffer{nullptr}, histogram_buffer{nullptr}, cdf_buffer{nullptr};
+    vk::DeviceMemory        color_memory{nullptr}, histogram_memory{nullptr}, cdf_memory{nullptr};
+    uint32_t                color_capacity{0};
+    uint32_t                histogram_capacity{0};
+    mandelbrot::View        recolored_view{};     // Paramètres du rendu dont l'image couleur est contenue dans color_buffer
+
+    /**
+     * @brief Ressources de l'anticrénelage adaptatif (shader supersample.comp)
+     *
+     * counts_buffer contient le nombre d'itérations au centre de chaque pixel et refined_buffer un compteur suivi de la
+     * liste des pixels à suréchantillonner (supersample_capacity pixels chacun).
+     */
+    struct SupersampleParameters
+    {
+        mandelbrot::View view;
+        uint32_t mode;
+        int32_t  samples;
+        uint32_t refine_all;
+    };
+    vk::DescriptorSetLayout supersample_descriptor_set_layout;
+    vk::DescriptorSet       supersample_descriptor_set;
+    vk::PipelineLayout      supersample_pipeline_layout;
+    vk::Pipeline            supersample_pipeline{nullptr};
+    vk::ShaderModule        supersample_shader_module;
+    vk::Buffer              counts_buffer{nullptr}, refined_buffer{nullptr};
+    vk::DeviceMemory        counts_memory{nullptr}, refined_memory{nullptr};
+    uint32_t                supersample_capacity{0};
 
 
 };
@@ -5,10 +5,21 @@
 #include <cstdlib>
 #include <chrono>
 #include <string>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <charconv>
+#include <stdexcept>
 using namespace std::string_literals;
 #include "kompute/Kompute.hpp"
 
 #include "shader/mulmatmat_h.hpp"
+#include "shader/mulmatmat_optim4_h.hpp"
+#include "shader/mulmatmat_batched_h.hpp"
+#include "shader/mulmatmat_subgroup_h.hpp"
+#include "shader/gen_tensor_matrix_h.hpp"
+#include "shader/compute_error_h.hpp"
+#include "shader/reduce_error_h.hpp"
 
 extern "C" void 
 sgemm_(const char& trA, const char& trB, int const& M, int const& N, int const& K, float const& alpha, 
@@ -67,76 +78,711 @@ float compute_error( std::pair<std::vector<float>, std::vector<float>> const& A,
 }
 //
 const std::uint32_t workgroup_size = 16;
+// --------------------------------------------------------------------------------------
+// Calcul de nb_batch produits C_b = A_b.B_b de petites matrices dim x dim, sur CPU (un sgemm par produit,
+// les produits étant répartis entre les threads) puis sur GPU en un seul dispatch (voir shader/mulmatmat_batched.comp)
+int run_batched_products(kp::Manager& mgr, std::uint32_t nb_batch, std::uint32_t dim)
+{
+    const std::uint32_t mat_size = dim*dim;
+    std::vector<std::pair<std::vector<float>,std::vector<float>>> tensors_A, tensors_B;
+    tensors_A.reserve(nb_batch); tensors_B.reserve(nb_batch);
+    std::vector<float> A(std::size_t(nb_batch)*mat_size), B(std::size_t(nb_batch)*mat_size);
+    for (std::uint32_t b = 0; b < nb_batch; ++b)
+    {
+        tensors_A.push_back(get_tensor_matrix(dim, dim+1.f, 0.5f + 0.01f*b));
+        tensors_B.push_back(get_tensor_matrix(dim, 341.f, 0.25f - 0.01f*b));
+        auto A_b = compute_mat_from_tensor(tensors_A.back().first, tensors_A.back().second);
+        auto B_b = compute_mat_from_tensor(tensors_B.back().first, tensors_B.back().second);
+        std::copy(A_b.begin(), A_b.end(), A.begin() + std::size_t(b)*mat_size);
+        std::copy(B_b.begin(), B_b.end(), B.begin() + std::size_t(b)*mat_size);
+    }
+    std::vector<float> C(A.size(), 0.f);
+    // Vérifie chaque produit du lot et renvoie la plus grande erreur relative
+    auto check_batch = [&](std::vector<float> const& C_all)
+    {
+        float max_error = 0.f;
+        for (std::uint32_t b = 0; b < nb_batch; ++b)
+        {
+            std::vector<float> C_b(C_all.begin() + std::size_t(b)*mat_size, C_all.begin() + std::size_t(b+1)*mat_size);
+            max_error = std::max(max_error, compute_error(tensors_A[b], tensors_B[b], C_b));
+        }
+        return max_error;
+    };
+    const double nb_ops = double(nb_batch)*dim*dim*dim;
+
+    std::cout << "Calcul par lots blas (openblas) : " << nb_batch << " produits de taille " << dim << std::endl;
+    std::cout << "-----------------------------------" << std::endl;
+    auto beg_cpu = std::chrono::high_resolution_clock::now();
+#   pragma omp parallel for schedule(static)
+    for (int b = 0; b < int(nb_batch); ++b)
+    {
+        int d = int(dim);
+        std::size_t offset = std::size_t(b)*mat_size;
+        // sgemm travaille en ordre colonne : calculer C^t = B^t.A^t donne directement C rangé par ligne
+        sgemm_('N', 'N', d, d, d, 1.0f, B.data()+offset, d, A.data()+offset, d, 0.f, C.data()+offset, d);
+    }
+    auto end_cpu = std::chrono::high_resolution_clock::now();
+    auto duree_cpu = std::chrono::duration<double>(end_cpu - beg_cpu).count();
+    std::cout << "Temps calcul blas par lots (en secondes) : " << duree_cpu << std::endl;
+    std::cout << "Performance : " << nb_ops/duree_cpu/1024./1024./1024. << " Giga flops" << std::endl;
+    std::cout << "Erreur L2 relatif maximale sur les produits blas : " << check_batch(C) << std::endl;
+
+    std::cout << "Calcul Vulkan par lots" << std::endl;
+    std::cout << "----------------------" << std::endl;
+    std::vector<float>(A.size(), 0.f).swap(C);
+    std::shared_ptr<kp::TensorT<float>> mat_A = mgr.tensor(A);
+    std::shared_ptr<kp::TensorT<float>> mat_B = mgr.tensor(B);
+    std::shared_ptr<kp::TensorT<float>> mat_C = mgr.tensor(C);
+    const std::vector<std::shared_ptr<kp::Memory>> params = { mat_A, mat_B, mat_C };
+
+    // maxComputeWorkGroupCount[2] vaut au moins 65535 : au delà, on découpe le lot en plusieurs dispatchs
+    const std::uint32_t max_groups_z = 65535;
+    const std::uint32_t groups_z = std::min(nb_batch, max_groups_z);
+    auto push_constants = [&](std::uint32_t batch_offset)
+    {
+        return std::vector<std::uint32_t>{dim, dim, dim, dim, dim, dim, mat_size, mat_size, mat_size, nb_batch, batch_offset};
+    };
+    std::vector<std::uint32_t> shader(shader::MULMATMAT_BATCHED_COMP_SPV.begin(), shader::MULMATMAT_BATCHED_COMP_SPV.end());
+    std::shared_ptr<kp::Algorithm> algo =
+        mgr.algorithm(params, shader, kp::Workgroup({ (dim+workgroup_size-1)/workgroup_size, (dim+workgroup_size-1)/workgroup_size, groups_z }), {},
+                      push_constants(0));
+
+    std::shared_ptr<kp::Sequence> sq = mgr.sequence();
+    auto beg_computation = std::chrono::high_resolution_clock::now();
+    sq->eval<kp::OpSyncDevice>(params);
+    sq->clear();
+    for (std::uint32_t batch_offset = 0; batch_offset < nb_batch; batch_offset += groups_z)
+        sq->record<kp::OpAlgoDispatch>(algo, push_constants(batch_offset));
+    auto beg_kernel = std::chrono::high_resolution_clock::now();
+    sq->eval();
+    auto end_kernel = std::chrono::high_resolution_clock::now();
+    sq->eval<kp::OpSyncLocal>(params);
+    auto end_computation = std::chrono::high_resolution_clock::now();
+    double duree = std::chrono::duration<double>(end_computation - beg_computation).count();
+    double duree_noyau = std::chrono::duration<double>(end_kernel - beg_kernel).count();
+    std::cout << "Temps calcul par lots avec transferts (en secondes): " << duree << std::endl;
+    std::cout << "Performance avec transferts : " << nb_ops/duree/1024./1024./1024. << " Giga flops" << std::endl;
+    std::cout << "Temps du noyau seul (en secondes): " << duree_noyau << std::endl;
+    std::cout << "Performance du noyau seul : " << nb_ops/duree_noyau/1024./1024./1024. << " Giga flops" << std::endl;
+    std::cout << "Accélération GPU (noyau seul) / CPU : " << duree_cpu/duree_noyau << std::endl;
+    std::cout << "Erreur L2 relatif maximale sur les produits Vulkan : " << check_batch(mat_C->vector()) << std::endl;
+
+    return EXIT_SUCCESS;
+}
+// --------------------------------------------------------------------------------------
+// Instance, périphérique logique et queues du calcul par flot. Ils sont créés ici et non par kp::Manager : le calcul par
+// flot soumet lui-même ses tampons de commandes pour les chaîner par des sémaphores, ce que kp::Sequence ne permet pas.
+// Le gestionnaire est ensuite construit sur ces ressources (il ne les détruit pas, il doit être détruit avant elles).
+//
+// On prend une famille de calcul et si possible une famille dédiée aux transferts (sans calcul ni graphisme), qui
+// correspond en général aux moteurs DMA du GPU. À défaut, on demande une seconde queue de la famille de calcul, et sinon
+// on se contente d'une seule queue.
+struct StreamDevice
+{
+    std::shared_ptr<vk::Instance>       instance;
+    std::shared_ptr<vk::PhysicalDevice> physical_device;
+    std::shared_ptr<vk::Device>         device;
+    std::uint32_t compute_family = 0, transfer_family = 0;
+    vk::Queue     compute_queue, transfer_queue;
+    bool          has_two_queues = false;
+
+    StreamDevice()
+    {
+        vk::ApplicationInfo application_info;
+        application_info.setPApplicationName("kompute_mat_mat_mul")
+                        .setApiVersion(VK_API_VERSION_1_1);
+        vk::InstanceCreateInfo instance_create_info;
+        instance_create_info.setPApplicationInfo(&application_info);
+        instance = std::make_shared<vk::Instance>(vk::createInstance(instance_create_info));
+        auto physical_devices = instance->enumeratePhysicalDevices();
+        if (physical_devices.empty()) throw std::runtime_error("Aucun périphérique Vulkan disponible");
+        physical_device = std::make_shared<vk::PhysicalDevice>(physical_devices[0]);
+
+        auto families = physical_device->getQueueFamilyProperties();
+        while (compute_family < families.size() && !(families[compute_family].queueFlags & vk::QueueFlagBits::eCompute))
+            ++compute_family;
+        if (compute_family == families.size()) throw std::runtime_error("Aucune famille de queues de calcul");
+        transfer_family = compute_family;
+        for (std::uint32_t i = 0; i < families.size(); ++i)
+        {
+            auto flags = families[i].queueFlags;
+            if ( (flags & vk::QueueFlagBits::eTransfer) && !(flags & vk::QueueFlagBits::eCompute) && !(flags & vk::QueueFlagBits::eGraphics) )
+            {
+                transfer_family = i;
+                break;
+            }
+        }
+        has_two_queues = (transfer_family != compute_family) || (families[compute_family].queueCount > 1);
+
+        const float priorities[2] = { 1.f, 1.f };
+        std::vector<vk::DeviceQueueCreateInfo> queue_create_infos(transfer_family != compute_family ? 2 : 1);
+        queue_create_infos[0].setQueueFamilyIndex(compute_family)
+                             .setQueueCount(transfer_family == compute_family && has_two_queues ? 2 : 1)
+                             .setPQueuePriorities(priorities);
+        if (transfer_family != compute_family)
+            queue_create_infos[1].setQueueFamilyIndex(transfer_family)
+                                 .setQueueCount(1)
+                                 .setPQueuePriorities(priorities);
+        vk::DeviceCreateInfo device_create_info;
+        device_create_info.setQueueCreateInfoCount(std::uint32_t(queue_create_infos.size()))
+                          .setPQueueCreateInfos(queue_create_infos.data());
+        device = std::make_shared<vk::Device>(physical_device->createDevice(device_create_info));
+        compute_queue  = device->getQueue(compute_family, 0);
+        transfer_queue = device->getQueue(transfer_family, (transfer_family == compute_family && has_two_queues) ? 1 : 0);
+    }
+    StreamDevice(StreamDevice const&) = delete;
+    StreamDevice& operator=(StreamDevice const&) = delete;
+    ~StreamDevice()
+    {
+        device->destroy();
+        instance->destroy();
+    }
+};
+// --------------------------------------------------------------------------------------
+// Produit C = A.B de matrices dim x dim plus grandes que la mémoire du périphérique.
+//
+// C est découpé en blocs C_IJ de taille panel x panel, calculés à partir du panneau de lignes A_I (panel x dim) et du
+// panneau de colonnes B_J (dim x panel). Seuls deux jeux de panneaux (A_I, B_J, C_IJ) résident sur le périphérique
+// (emplacement s%2 pour le bloc s). Chaque étape s soumet :
+//   - sur la queue de calcul, le calcul du bloc s, qui attend (sémaphore uploaded) l'envoi de ses panneaux ;
+//   - sur la queue de transfert, le rapatriement du bloc s, qui attend (sémaphore computed) la fin de son calcul, suivi de
+//     l'envoi des panneaux du bloc s+2 dans le même emplacement, qui débloque le calcul de ce bloc.
+// Le GPU enchaîne donc seul envoi, calcul et rapatriement. Pendant ce temps, l'hôte génère les panneaux du bloc s+2 dans
+// la mémoire de transit (libérée par l'envoi du bloc s) puis vérifie le bloc s-1 dès son arrivée (barrière de fin de
+// transfert) : ni A, ni B, ni C ne sont jamais stockés en entier (ni sur le périphérique, ni sur l'hôte).
+//
+// Les tenseurs de Kompute sont en partage exclusif : quand les deux queues sont de familles différentes, chaque passage
+// d'un panneau d'une queue à l'autre est un transfert de propriété (barrière de libération sur la queue de départ et
+// barrière d'acquisition identique sur la queue d'arrivée). Les panneaux réécrits entièrement (A et B par la copie, C par
+// le noyau) n'ont pas besoin de revenir à la queue d'origine : leur ancien contenu est perdu, ce qui est voulu.
+int run_streamed_product(StreamDevice& stream_device, kp::Manager& mgr, std::uint32_t dim, std::uint32_t panel)
+{
+    panel = std::min(panel, dim);
+    vk::Device& device = *stream_device.device;
+    const std::uint32_t compute_family  = stream_device.compute_family;
+    const std::uint32_t transfer_family = stream_device.transfer_family;
+    // NB : pas de liaisons structurées ici, elles ne peuvent pas être capturées par les lambdas en C++17
+    const auto tensor_A = get_tensor_matrix(dim, dim+1.f, 0.5f);
+    const auto tensor_B = get_tensor_matrix(dim, 341.f, 0.25f);
+    auto const& A_u = tensor_A.first;
+    auto const& A_vt= tensor_A.second;
+    auto const& B_u = tensor_B.first;
+    auto const& B_vt= tensor_B.second;
+    float scal = 0.f;
+    for (std::size_t i = 0; i < dim; ++i ) scal += A_vt[i]*B_u[i];
+
+    const std::uint32_t nb_panels = (dim + panel - 1)/panel;
+    const std::uint32_t nb_steps  = nb_panels * nb_panels;
+    auto tile_rows = [&](std::uint32_t I) { return std::min(panel, dim - I*panel); };
+
+    std::cout << "Calcul Vulkan par flot de panneaux" << std::endl;
+    std::cout << "----------------------------------" << std::endl;
+    std::cout << "Mémoire périphérique utilisée : " << 2.*(2.*panel*dim + double(panel)*panel)*sizeof(float)/1024./1024. << " Mo pour "
+              << 3.*dim*dim*sizeof(float)/1024./1024. << " Mo de matrices" << std::endl;
+    if (!stream_device.has_two_queues)
+        std::cout << "Attention : une seule queue disponible, les transferts ne pourront pas recouvrir le calcul" << std::endl;
+    else if (transfer_family != compute_family)
+        std::cout << "Transferts sur la famille de queues dédiée " << transfer_family << std::endl;
+
+    vk::CommandPoolCreateInfo pool_create_info;
+    pool_create_info.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer)
+                    .setQueueFamilyIndex(compute_family);
+    vk::CommandPool compute_pool = device.createCommandPool(pool_create_info);
+    pool_create_info.setQueueFamilyIndex(transfer_family);
+    vk::CommandPool transfer_pool = device.createCommandPool(pool_create_info);
+
+    // Deux emplacements pour les panneaux sur le périphérique (double tampon), avec leurs tampons de commandes
+    struct Slot
+    {
+        std::shared_ptr<kp::TensorT<float>> A, B, C;
+        std::shared_ptr<kp::Algorithm>     algo;
+        std::vector<std::uint32_t>          push_constants;
+        std::uint32_t I = ~0u;               // Indice du panneau A_I actuellement dans l'emplacement
+        bool          upload_A = false;
+        vk::CommandBuffer compute_commands, transfer_commands;
+        vk::Semaphore     uploaded, computed;
+        vk::Fence         transferred;       // Fin du dernier transfert soumis (rapatriement et/ou envoi)
+        bool              in_flight = false;
+        int               downloaded_step = -1; // Bloc rapatrié par le dernier transfert, à vérifier
+    };
+    std::vector<std::uint32_t> shader(shader::MULMATMAT_BATCHED_COMP_SPV.begin(), shader::MULMATMAT_BATCHED_COMP_SPV.end());
+    std::array<Slot,2> slots;
+    for (auto& slot : slots)
+    {
+        slot.A = mgr.tensor(std::vector<float>(std::size_t(panel)*dim, 0.f));
+        slot.B = mgr.tensor(std::vector<float>(std::size_t(panel)*dim, 0.f));
+        slot.C = mgr.tensor(std::vector<float>(std::size_t(panel)*panel, 0.f));
+        slot.algo = mgr.algorithm({slot.A, slot.B, slot.C}, shader,
+                                  kp::Workgroup({ (panel+workgroup_size-1)/workgroup_size, (panel+workgroup_size-1)/workgroup_size, 1 }), {},
+                                  std::vector<std::uint32_t>(11, 0u));
+        vk::CommandBufferAllocateInfo allocate_info;
+        allocate_info.setCommandPool(compute_pool)
+                     .setLevel(vk::CommandBufferLevel::ePrimary)
+                     .setCommandBufferCount(1);
+        slot.compute_commands = device.allocateCommandBuffers(allocate_info)[0];
+        allocate_info.setCommandPool(transfer_pool);
+        slot.transfer_commands = device.allocateCommandBuffers(allocate_info)[0];
+        slot.uploaded    = device.createSemaphore(vk::SemaphoreCreateInfo());
+        slot.computed    = device.createSemaphore(vk::SemaphoreCreateInfo());
+        slot.transferred = device.createFence(vk::FenceCreateInfo());
+    }
+
+    // Génération sur l'hôte des panneaux du bloc step dans la mémoire de transit de son emplacement
+    auto pack_step = [&](std::uint32_t step)
+    {
+        Slot& slot = slots[step%2];
+        const std::uint32_t I = step / nb_panels, J = step % nb_panels;
+        const std::uint32_t M = tile_rows(I), N = tile_rows(J);
+        slot.upload_A = (slot.I != I);
+        if (slot.upload_A)
+        {
+            float* A_panel = slot.A->data();
+#           pragma omp parallel for
+            for (int r = 0; r < int(M); ++r)
+                for (std::uint32_t k = 0; k < dim; ++k)
+                    A_panel[std::size_t(r)*dim + k] = A_u[I*panel + r] * A_vt[k];
+            slot.I = I;
+        }
+        float* B_panel = slot.B->data();
+#       pragma omp parallel for
+        for (int k = 0; k < int(dim); ++k)
+            for (std::uint32_t c = 0; c < N; ++c)
+                B_panel[std::size_t(k)*N + c] = B_u[k] * B_vt[J*panel + c];
+        //                      M, N, K,   lda, ldb, ldc,   strides, nb_batch, batch_offset
+        slot.push_constants = { M, N, dim, dim, N,   N,     0, 0, 0, 1,        0 };
+    };
+    // Vérification d'un bloc rapatrié (même calcul que compute_error, accumulé bloc par bloc)
+    double err = 0., frob_C = 0.;
+    auto check_step = [&](std::uint32_t step)
+    {
+        const float* C_tile = slots[step%2].C->data();
+        const std::uint32_t I = step / nb_panels, J = step % nb_panels;
+        const std::uint32_t M = tile_rows(I), N = tile_rows(J);
+        double err_tile = 0., frob_tile = 0.;
+#       pragma omp parallel for reduction(+:err_tile,frob_tile)
+        for (int r = 0; r < int(M); ++r)
+            for (std::uint32_t c = 0; c < N; ++c)
+            {
+                float c_attended = scal * A_u[I*panel + r] * B_vt[J*panel + c];
+                float delta = C_tile[std::size_t(r)*N + c] - c_attended;
+                frob_tile += c_attended*c_attended;
+                err_tile  += delta*delta;
+            }
+        err += err_tile; frob_C += frob_tile;
+    };
+
+    // Kompute n'expose pas le buffer du périphérique d'un tenseur : on le lit dans la description de liaison qu'il
+    // construit pour les ensembles de descripteurs
+    auto device_buffer = [](std::shared_ptr<kp::TensorT<float>> const& tensor)
+    {
+        return tensor->constructDescriptorSet(vk::DescriptorSet{}, 0).pBufferInfo->buffer;
+    };
+    // Transfert de propriété de buffers de la famille src à la famille dst (simple barrière si les familles sont les
+    // mêmes). La même barrière est enregistrée par la queue qui libère (dst_access ignoré) et par celle qui acquiert
+    // (src_access ignoré).
+    auto record_ownership = [&](vk::CommandBuffer& commands, std::vector<std::shared_ptr<kp::TensorT<float>>> const& tensors,
+                                vk::AccessFlags src_access, vk::AccessFlags dst_access,
+                                vk::PipelineStageFlags src_stage, vk::PipelineStageFlags dst_stage,
+                                std::uint32_t src_family, std::uint32_t dst_family)
+    {
+        if (src_family == dst_family) src_family = dst_family = VK_QUEUE_FAMILY_IGNORED;
+        std::vector<vk::BufferMemoryBarrier> barriers(tensors.size());
+        for (std::size_t t = 0; t < tensors.size(); ++t)
+            barriers[t].setSrcAccessMask(src_access)
+                       .setDstAccessMask(dst_access)
+                       .setSrcQueueFamilyIndex(src_family)
+                       .setDstQueueFamilyIndex(dst_family)
+                       .setBuffer(device_buffer(tensors[t]))
+                       .setOffset(0)
+                       .setSize(VK_WHOLE_SIZE);
+        commands.pipelineBarrier(src_stage, dst_stage, vk::DependencyFlags(), nullptr, barriers, nullptr);
+    };
+    auto uploaded_tensors = [&](Slot const& slot) -> std::vector<std::shared_ptr<kp::TensorT<float>>>
+    {
+        if (slot.upload_A) return {slot.A, slot.B};
+        return {slot.B};
+    };
+
+    // Calcul du bloc step : acquisition des panneaux envoyés, noyau, libération de C vers la queue de transfert
+    auto submit_compute = [&](std::uint32_t step)
+    {
+        Slot& slot = slots[step%2];
+        vk::CommandBuffer& commands = slot.compute_commands;
+        commands.reset();
+        commands.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        record_ownership(commands, uploaded_tensors(slot), vk::AccessFlags(), vk::AccessFlagBits::eShaderRead,
+                         vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+                         transfer_family, compute_family);
+        slot.algo->setPushConstants(slot.push_constants);
+        slot.algo->recordBindCore(commands);
+        slot.algo->recordBindPush(commands);
+        slot.algo->recordDispatch(commands);
+        record_ownership(commands, {slot.C}, vk::AccessFlagBits::eShaderWrite, vk::AccessFlags(),
+                         vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eBottomOfPipe,
+                         compute_family, transfer_family);
+        commands.end();
+        const vk::PipelineStageFlags wait_stage = vk::PipelineStageFlagBits::eComputeShader;
+        vk::SubmitInfo submit_info;
+        submit_info.setWaitSemaphoreCount(1).setPWaitSemaphores(&slot.uploaded).setPWaitDstStageMask(&wait_stage)
+                   .setCommandBufferCount(1).setPCommandBuffers(&commands)
+                   .setSignalSemaphoreCount(1).setPSignalSemaphores(&slot.computed);
+        stream_device.compute_queue.submit(submit_info, nullptr);
+    };
+    // Rapatriement du bloc download_step (s'il est positif) puis envoi des panneaux du bloc upload_step (s'il est
+    // positif, déjà générés par pack_step) dans le même emplacement
+    auto submit_transfer = [&](std::uint32_t slot_index, int download_step, int upload_step)
+    {
+        Slot& slot = slots[slot_index];
+        vk::CommandBuffer& commands = slot.transfer_commands;
+        commands.reset();
+        commands.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        if (download_step >= 0)
+        {
+            record_ownership(commands, {slot.C}, vk::AccessFlags(), vk::AccessFlagBits::eTransferRead,
+                             vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
+                             compute_family, transfer_family);
+            slot.C->recordCopyFromDeviceToStaging(commands);
+            vk::MemoryBarrier host_barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+            commands.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost,
+                                     vk::DependencyFlags(), host_barrier, nullptr, nullptr);
+        }
+        if (upload_step >= 0)
+        {
+            auto tensors = uploaded_tensors(slot);
+            for (auto const& tensor : tensors) tensor->recordCopyFromStagingToDevice(commands);
+            record_ownership(commands, tensors, vk::AccessFlagBits::eTransferWrite, vk::AccessFlags(),
+                             vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe,
+                             transfer_family, compute_family);
+        }
+        commands.end();
+        const vk::PipelineStageFlags wait_stage = vk::PipelineStageFlagBits::eTransfer;
+        vk::SubmitInfo submit_info;
+        submit_info.setCommandBufferCount(1).setPCommandBuffers(&commands);
+        if (download_step >= 0)
+            submit_info.setWaitSemaphoreCount(1).setPWaitSemaphores(&slot.computed).setPWaitDstStageMask(&wait_stage);
+        if (upload_step >= 0)
+            submit_info.setSignalSemaphoreCount(1).setPSignalSemaphores(&slot.uploaded);
+        stream_device.transfer_queue.submit(submit_info, slot.transferred);
+        slot.in_flight = true;
+        slot.downloaded_step = download_step;
+    };
+    // Attend le dernier transfert de l'emplacement et vérifie le bloc qu'il a rapatrié
+    auto finish_transfer = [&](std::uint32_t slot_index)
+    {
+        Slot& slot = slots[slot_index];
+        if (!slot.in_flight) return;
+        if (device.waitForFences(slot.transferred, VK_TRUE, UINT64_MAX) != vk::Result::eSuccess)
+            throw std::runtime_error("Échec de l'attente d'un transfert");
+        device.resetFences(slot.transferred);
+        slot.in_flight = false;
+        if (slot.downloaded_step >= 0) check_step(std::uint32_t(slot.downloaded_step));
+        slot.downloaded_step = -1;
+    };
+
+    auto beg_computation = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t step = 0; step < std::min(nb_steps, 2u); ++step)
+    {
+        pack_step(step);
+        submit_transfer(step, -1, int(step));
+    }
+    for (std::uint32_t step = 0; step < nb_steps; ++step)
+    {
+        const std::uint32_t k = step%2;
+        submit_compute(step);
+        // Pendant le calcul du bloc step (et le rapatriement du bloc step-1), l'hôte attend l'envoi des panneaux du bloc
+        // step, génère ceux du bloc step+2 dans la mémoire de transit ainsi libérée et soumet le transfert suivant
+        finish_transfer(k);
+        const bool upload_next = (step + 2 < nb_steps);
+        if (upload_next) pack_step(step+2);
+        submit_transfer(k, int(step), upload_next ? int(step+2) : -1);
+        // Vérification du bloc step-1 dès son arrivée, toujours pendant le calcul du bloc step
+        finish_transfer(1-k);
+    }
+    finish_transfer(0);
+    finish_transfer(1);
+    auto end_computation = std::chrono::high_resolution_clock::now();
+
+    double duree = std::chrono::duration<double>(end_computation - beg_computation).count();
+    std::cout << "Temps calcul par flot (en secondes): " << duree << std::endl;
+    std::cout << "Performance soutenue : " << (double(dim)*dim*dim)/duree/1024./1024./1024. << " Giga flops" << std::endl;
+    std::cout << "Erreur L2 relatif sur le résultat trouvé par flot : " << std::sqrt(err/frob_C) << std::endl;
+
+    // Débit de référence : le noyau seul sur le dernier bloc, dont les panneaux sont encore sur le périphérique. Depuis
+    // son rapatriement, le bloc C de l'emplacement appartient à la famille de transfert : la queue de transfert le libère
+    // (en signalant le sémaphore uploaded, libre à ce stade) et le noyau l'acquiert avant de l'écrire
+    {
+        const std::uint32_t k = (nb_steps-1)%2;
+        Slot& slot = slots[k];
+        const std::uint32_t I = (nb_steps-1) / nb_panels, J = (nb_steps-1) % nb_panels;
+        vk::CommandBuffer& release = slot.transfer_commands;
+        release.reset();
+        release.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        record_ownership(release, {slot.C}, vk::AccessFlagBits::eTransferRead, vk::AccessFlags(),
+                         vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe,
+                         transfer_family, compute_family);
+        release.end();
+        vk::SubmitInfo release_info;
+        release_info.setCommandBufferCount(1).setPCommandBuffers(&release)
+                    .setSignalSemaphoreCount(1).setPSignalSemaphores(&slot.uploaded);
+        stream_device.transfer_queue.submit(release_info, slot.transferred);
+        slot.in_flight = true;
+        finish_transfer(k);
+
+        vk::CommandBuffer& commands = slot.compute_commands;
+        commands.reset();
+        commands.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        record_ownership(commands, {slot.C}, vk::AccessFlags(), vk::AccessFlagBits::eShaderWrite,
+                         vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+                         transfer_family, compute_family);
+        slot.algo->recordBindCore(commands);
+        slot.algo->recordBindPush(commands);
+        slot.algo->recordDispatch(commands);
+        commands.end();
+        vk::Fence kernel_done = device.createFence(vk::FenceCreateInfo());
+        const vk::PipelineStageFlags wait_stage = vk::PipelineStageFlagBits::eComputeShader;
+        vk::SubmitInfo submit_info;
+        submit_info.setWaitSemaphoreCount(1).setPWaitSemaphores(&slot.uploaded).setPWaitDstStageMask(&wait_stage)
+                   .setCommandBufferCount(1).setPCommandBuffers(&commands);
+        auto beg_kernel = std::chrono::high_resolution_clock::now();
+        stream_device.compute_queue.submit(submit_info, kernel_done);
+        if (device.waitForFences(kernel_done, VK_TRUE, UINT64_MAX) != vk::Result::eSuccess)
+            throw std::runtime_error("Échec de l'attente du noyau");
+        auto end_kernel = std::chrono::high_resolution_clock::now();
+        device.destroyFence(kernel_done);
+        double duree_noyau = std::chrono::duration<double>(end_kernel - beg_kernel).count();
+        std::cout << "Performance du noyau seul sur un bloc : "
+                  << (double(tile_rows(I))*tile_rows(J)*dim)/duree_noyau/1024./1024./1024. << " Giga flops" << std::endl;
+    }
+
+    for (auto& slot : slots)
+    {
+        device.destroySemaphore(slot.uploaded);
+        device.destroySemaphore(slot.computed);
+        device.destroyFence(slot.transferred);
+    }
+    device.destroyCommandPool(compute_pool);
+    device.destroyCommandPool(transfer_pool);
+    return EXIT_SUCCESS;
+}
+// --------------------------------------------------------------------------------------
+// Renvoie la taille des sous-groupes du périphérique utilisé par le gestionnaire si les shaders de calcul y supportent les
+// opérations de sous-groupe de base et subgroupShuffle (nécessaires à shader/mulmatmat_subgroup.comp), et zéro sinon.
+std::uint32_t query_subgroup_size(kp::Manager& mgr)
+{
+    auto properties = mgr.listDevices()[0].getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceSubgroupProperties>();
+    auto const& subgroup = properties.get<vk::PhysicalDeviceSubgroupProperties>();
+    std::cout << "Taille des sous-groupes : " << subgroup.subgroupSize << std::endl;
+    if ( !(subgroup.supportedStages & vk::ShaderStageFlagBits::eCompute) ) return 0;
+    if ( !(subgroup.supportedOperations & vk::SubgroupFeatureFlagBits::eBasic) ) return 0;
+    if ( !(subgroup.supportedOperations & vk::SubgroupFeatureFlagBits::eShuffle) ) return 0;
+    return subgroup.subgroupSize;
+}
+// --------------------------------------------------------------------------------------
+// Lit un entier strictement positif (représentable sur 32 bits) : renvoie false si l'argument n'en est pas un
+bool parse_positive(char const* arg, std::uint32_t& value)
+{
+    char const* end = arg + std::strlen(arg);
+    std::uint32_t parsed = 0;
+    auto [ptr, ec] = std::from_chars(arg, end, parsed);
+    if (ec != std::errc() || ptr != end || parsed == 0) return false;
+    value = parsed;
+    return true;
+}
+// --------------------------------------------------------------------------------------
+// Affiche l'utilisation du programme (voir ci-dessous) et renvoie le code d'échec
+int usage(char const* program)
+{
+    std::cerr << "Utilisation :" << std::endl
+              << "   " << program << " [dim] [noblas] [subgroup|optim4]" << std::endl
+              << "   " << program << " batch [nb_batch] [dim]" << std::endl
+              << "   " << program << " stream [dim] [panel]" << std::endl;
+    return EXIT_FAILURE;
+}
+// --------------------------------------------------------------------------------------
+// Utilisation :
+//    kompute_mat_mat_mul [dim] [noblas] [subgroup|optim4] : produit de deux matrices dim x dim (1024 par défaut), sans le calcul blas si noblas,
+//                                                       avec le noyau à opérations de sous-groupe si subgroup (et si le périphérique le permet),
+//                                                       avec le niveau OPTIM 4 de shader/mulmatmat.glsl au lieu de OPTIM 3 si optim4
+//    kompute_mat_mat_mul batch [nb_batch] [dim]       : nb_batch produits de matrices dim x dim (4096 produits 64x64 par défaut)
+//    kompute_mat_mat_mul stream [dim] [panel]         : produit par flot de panneaux de largeur panel (16384 et 1024 par défaut)
 int main(int nargs, char *vargs[])
 {
+    if (nargs > 1 && vargs[1] == "stream"s)
+    {
+        std::uint32_t dim_stream = 16384;
+        std::uint32_t panel      = 1024;
+        if ( nargs > 4 || (nargs > 2 && !parse_positive(vargs[2], dim_stream)) || (nargs > 3 && !parse_positive(vargs[3], panel)) )
+            return usage(vargs[0]);
+        StreamDevice stream_device;
+        kp::Manager mgr(stream_device.instance, stream_device.physical_device, stream_device.device);
+        return run_streamed_product(stream_device, mgr, dim_stream, panel);
+    }
+
     kp::Manager mgr;
+    if (nargs > 1 && vargs[1] == "batch"s)
+    {
+        std::uint32_t nb_batch = 4096;
+        std::uint32_t dim_batch= 64;
+        if ( nargs > 4 || (nargs > 2 && !parse_positive(vargs[2], nb_batch)) || (nargs > 3 && !parse_positive(vargs[3], dim_batch)) )
+            return usage(vargs[0]);
+        return run_batched_products(mgr, nb_batch, dim_batch);
+    }
+
     std::uint32_t dim = 1024;
-    if (nargs > 1)
-        dim = std::stoul(vargs[1]);
+    // Le calcul blas a besoin des matrices construites sur l'hôte, ce qui devient très long pour les grandes dimensions.
+    bool with_blas = true;
+    bool with_subgroup = false;
+    bool with_optim4   = false;
+    for (int iarg = 1; iarg < nargs; ++iarg)
+    {
+        if (vargs[iarg] == "noblas"s) with_blas = false;
+        else if (vargs[iarg] == "subgroup"s) with_subgroup = true;
+        else if (vargs[iarg] == "optim4"s) with_optim4 = true;
+        else if (!parse_positive(vargs[iarg], dim))
+        {
+            std::cerr << "Argument inconnu : " << vargs[iarg] << std::endl;
+            return usage(vargs[0]);
+        }
+    }
+    // optim4 choisit le niveau du noyau en mémoire partagée, qui n'est pas utilisé avec subgroup
+    if (with_subgroup && with_optim4)
+        return usage(vargs[0]);
+    // Les shaders indexent les matrices dim x dim en entiers 32 bits : au-delà de 65535, dim*dim n'est plus
+    // représentable et seul le produit par flot (qui ne garde que des panneaux sur le périphérique) convient
+    if (dim > 65535)
+    {
+        std::cerr << "Dimension " << dim << " trop grande pour un produit en mémoire du périphérique (65535 au plus), "
+                  << "utiliser le mode stream" << std::endl;
+        return EXIT_FAILURE;
+    }
 
     auto [A_u,A_vt] = get_tensor_matrix(dim, dim+1.f, 0.5f);
     auto [B_u,B_vt] = get_tensor_matrix(dim, 341.f, 0.25f);
 
-    auto A = compute_mat_from_tensor( A_u, A_vt);
-    auto B = compute_mat_from_tensor( B_u, B_vt);
-    std::vector<float> C(A.size(), 0.f);
+    if (with_blas)
+    {
+        auto A = compute_mat_from_tensor( A_u, A_vt);
+        auto B = compute_mat_from_tensor( B_u, B_vt);
+        std::vector<float> C(dim*dim, 0.f);
 
-    std::cout << "Calcul blas (openblas) :" << std::endl;
-    std::cout << "------------------------" << std::endl;
-    std::vector<float>(dim*dim, 0.f).swap(C);
-    char tr='T';
-    int  dimb = int(A_u.size());
-    auto beg_computation2 = std::chrono::high_resolution_clock::now();
-    sgemm_(tr, tr, dimb, dimb, dimb, 1.0f, A.data(), dimb, B.data(), dimb, 0.f, C.data(), dimb );
-    auto end_computation2 = std::chrono::high_resolution_clock::now();
-    auto duree2 = std::chrono::duration<double>(end_computation2 - beg_computation2).count();
-    std::cout << "Temps calcul blas (en secondes) : " << duree2 << std::endl;
-    std::cout << "Performance : " << (double(dim)*dim*dim)/duree2/1024./1024./1024. << " Giga flops" << std::endl;
-
-    // On recalcule la transposée de C pour la vérification (merci le Fortran !)
-    std::vector<float> Ct(dim*dim);
-    for (std::size_t i = 0; i < dim; ++i)
-        for (std::size_t j = 0; j < dim; ++j)
-            Ct[i*dim+j] = C[j*dim+i];
-
-    std::cout << "Erreur L2 relatif sur le résultat trouvé en blas : ";
-    auto error2 = compute_error({A_u,A_vt}, {B_u,B_vt}, Ct);
-    std::cout << error2 << std::endl;
+        std::cout << "Calcul blas (openblas) :" << std::endl;
+        std::cout << "------------------------" << std::endl;
+        char tr='T';
+        int  dimb = int(A_u.size());
+        auto beg_computation2 = std::chrono::high_resolution_clock::now();
+        sgemm_(tr, tr, dimb, dimb, dimb, 1.0f, A.data(), dimb, B.data(), dimb, 0.f, C.data(), dimb );
+        auto end_computation2 = std::chrono::high_resolution_clock::now();
+        auto duree2 = std::chrono::duration<double>(end_computation2 - beg_computation2).count();
+        std::cout << "Temps calcul blas (en secondes) : " << duree2 << std::endl;
+        std::cout << "Performance : " << (double(dim)*dim*dim)/duree2/1024./1024./1024. << " Giga flops" << std::endl;
+
+        // On recalcule la transposée de C pour la vérification (merci le Fortran !)
+        std::vector<float> Ct(dim*dim);
+        for (std::size_t i = 0; i < dim; ++i)
+            for (std::size_t j = 0; j < dim; ++j)
+                Ct[i*dim+j] = C[j*dim+i];
+
+        std::cout << "Erreur L2 relatif sur le résultat trouvé en blas : ";
+        auto error2 = compute_error({A_u,A_vt}, {B_u,B_vt}, Ct);
+        std::cout << error2 << std::endl;
+    }
 
 
     std::cout << "Calcul Vulkan" << std::endl;
     std::cout << "-------------" << std::endl;
-    std::vector<float>(dim*dim, 0.f).swap(C);
-    std::shared_ptr<kp::TensorT<float>> mat_A = mgr.tensor(A);
-    std::shared_ptr<kp::TensorT<float>> mat_B = mgr.tensor(B);
-    std::shared_ptr<kp::TensorT<float>> mat_C = mgr.tensor(C);
-    
+    // Seuls les vecteurs générateurs des matrices de test sont envoyés au périphérique : A, B et C ne résident que dans la
+    // mémoire du périphérique (pas de mémoire de transit sur l'hôte) et sont construites/vérifiées par des shaders.
+    std::shared_ptr<kp::TensorT<float>> vec_A_u  = mgr.tensor(A_u);
+    std::shared_ptr<kp::TensorT<float>> vec_A_vt = mgr.tensor(A_vt);
+    std::shared_ptr<kp::TensorT<float>> vec_B_u  = mgr.tensor(B_u);
+    std::shared_ptr<kp::TensorT<float>> vec_B_vt = mgr.tensor(B_vt);
+    std::shared_ptr<kp::Tensor> mat_A = mgr.tensor(nullptr, dim*dim, sizeof(float), kp::Memory::DataTypes::eFloat, kp::Memory::MemoryTypes::eStorage);
+    std::shared_ptr<kp::Tensor> mat_B = mgr.tensor(nullptr, dim*dim, sizeof(float), kp::Memory::DataTypes::eFloat, kp::Memory::MemoryTypes::eStorage);
+    std::shared_ptr<kp::Tensor> mat_C = mgr.tensor(nullptr, dim*dim, sizeof(float), kp::Memory::DataTypes::eFloat, kp::Memory::MemoryTypes::eStorage);
+    const std::uint32_t nb_error_groups = 256;
+    std::shared_ptr<kp::TensorT<float>> partials = mgr.tensor(std::vector<float>(3*nb_error_groups, 0.f));
+    std::shared_ptr<kp::TensorT<float>> error_out= mgr.tensor(std::vector<float>(3, 0.f));
+
     const std::vector<std::shared_ptr<kp::Memory>> params = { mat_A, mat_B, mat_C };
 
+    std::shared_ptr<kp::Sequence> sq = mgr.sequence();
 
-    std::vector<std::uint32_t> shader(shader::MULMATMAT_COMP_SPV.begin(), shader::MULMATMAT_COMP_SPV.end());
-    std::shared_ptr<kp::Algorithm> algo = 
-        //mgr.algorithm(params, shader, kp::Workgroup({ (dim+workgroup_size-1)/workgroup_size, (dim+workgroup_size-1)/workgroup_size}), {}, 
-        mgr.algorithm(params, shader, kp::Workgroup({ (dim+127)/128, (dim+127)/128}), {}, 
-                      std::vector<std::uint32_t>{dim});
+    // Génération de A et B sur le périphérique
+    std::vector<std::uint32_t> gen_shader(shader::GEN_TENSOR_MATRIX_COMP_SPV.begin(), shader::GEN_TENSOR_MATRIX_COMP_SPV.end());
+    kp::Workgroup gen_workgroup({ (dim+workgroup_size-1)/workgroup_size, (dim+workgroup_size-1)/workgroup_size, 1 });
+    std::shared_ptr<kp::Algorithm> gen_A = mgr.algorithm({vec_A_u, vec_A_vt, mat_A}, gen_shader, gen_workgroup, {}, std::vector<std::uint32_t>{dim});
+    std::shared_ptr<kp::Algorithm> gen_B = mgr.algorithm({vec_B_u, vec_B_vt, mat_B}, gen_shader, gen_workgroup, {}, std::vector<std::uint32_t>{dim});
+    auto beg_generation = std::chrono::high_resolution_clock::now();
+    sq->eval<kp::OpSyncDevice>({vec_A_u, vec_A_vt, vec_B_u, vec_B_vt});
+    sq->clear();
+    sq->record<kp::OpAlgoDispatch>(gen_A)
+      ->record<kp::OpAlgoDispatch>(gen_B)
+      ->eval();
+    auto end_generation = std::chrono::high_resolution_clock::now();
+    std::cout << "Temps génération de A et B sur le périphérique (en secondes): "
+              << std::chrono::duration<double>(end_generation - beg_generation).count() << std::endl;
 
-    std::shared_ptr<kp::Sequence> sq = mgr.sequence()
-        ->record<kp::OpSyncDevice>(params)
-        ->record<kp::OpAlgoDispatch>(algo)
-        ->record<kp::OpSyncLocal>(params);
+    // Si le périphérique ne propose pas les opérations de sous-groupe nécessaires, on revient au noyau à mémoire partagée
+    std::uint32_t subgroup_size = (with_subgroup ? query_subgroup_size(mgr) : 0);
+    if (with_subgroup && subgroup_size == 0)
+        std::cout << "Opérations de sous-groupe non supportées : utilisation du noyau à mémoire partagée" << std::endl;
+    std::shared_ptr<kp::Algorithm> algo;
+    if (subgroup_size > 0)
+    {
+        std::cout << "Noyau à opérations de sous-groupe" << std::endl;
+        std::vector<std::uint32_t> shader(shader::MULMATMAT_SUBGROUP_COMP_SPV.begin(), shader::MULMATMAT_SUBGROUP_COMP_SPV.end());
+        // Un groupe de travail de subgroup_size threads calcule 16 lignes (WPT dans le shader) de 4*subgroup_size colonnes
+        // de C (TN = 4 colonnes par thread)
+        algo = mgr.algorithm(params, shader, kp::Workgroup({ (dim+4*subgroup_size-1)/(4*subgroup_size), (dim+15)/16, 1 }),
+                             std::vector<std::uint32_t>{subgroup_size}, std::vector<std::uint32_t>{dim});
+    }
+    else
+    {
+        std::cout << "Noyau en mémoire partagée, niveau OPTIM " << (with_optim4 ? 4 : 3) << std::endl;
+        std::vector<std::uint32_t> shader = with_optim4
+            ? std::vector<std::uint32_t>(shader::MULMATMAT_OPTIM4_COMP_SPV.begin(), shader::MULMATMAT_OPTIM4_COMP_SPV.end())
+            : std::vector<std::uint32_t>(shader::MULMATMAT_COMP_SPV.begin(), shader::MULMATMAT_COMP_SPV.end());
+        algo =
+            //mgr.algorithm(params, shader, kp::Workgroup({ (dim+workgroup_size-1)/workgroup_size, (dim+workgroup_size-1)/workgroup_size}), {}, 
+            // Pour OPTIM = 3 ou 4 dans le shader, chaque groupe de travail calcule un bloc 128x128 de C
+            mgr.algorithm(params, shader, kp::Workgroup({ (dim+127)/128, (dim+127)/128}), {}, 
+                          std::vector<std::uint32_t>{dim});
+    }
 
-    auto beg_computation = std::chrono::high_resolution_clock::now();
-    sq->eval();
-    auto end_computation = std::chrono::high_resolution_clock::now();
-    double duree = std::chrono::duration<double>(end_computation - beg_computation).count();
-    std::cout << "Temps calcul matrice matrice (en secondes): " << duree <<  std::endl;
-    std::cout << "Performance qui fait flops : " << (double(dim)*dim*dim)/duree/1024./1024./1024. << "Gigo flops (d'après retour vers le futur)" << std::endl;
+    // C'est la performance du noyau seul qu'on compare d'un niveau OPTIM à l'autre (argument optim4)
+    auto beg_kernel = std::chrono::high_resolution_clock::now();
+    sq->eval<kp::OpAlgoDispatch>(algo);
+    auto end_kernel = std::chrono::high_resolution_clock::now();
+    double duree_noyau = std::chrono::duration<double>(end_kernel - beg_kernel).count();
+    std::cout << "Temps du noyau seul (en secondes): " << duree_noyau <<  std::endl;
+    std::cout << "Performance qui fait flops : " << (double(dim)*dim*dim)/duree_noyau/1024./1024./1024. << "Gigo flops (d'après retour vers le futur)" << std::endl;
 
-    std::cout << "Erreur L2 relatif sur le résultat trouvé en Vulkan: ";
-    auto C_out = mat_C->vector();
-    auto error = compute_error({A_u,A_vt}, {B_u,B_vt}, C_out);
-    std::cout << error << std::endl;
+    // Vérification sur le périphérique : réduction parallèle de l'erreur, seules trois valeurs reviennent sur l'hôte
+    float scal = 0.f;
+    for (std::size_t i = 0; i < A_vt.size(); ++i ) scal += A_vt[i]*B_u[i];
+    std::uint32_t scal_bits;
+    std::memcpy(&scal_bits, &scal, sizeof(float));
+    std::vector<std::uint32_t> error_shader(shader::COMPUTE_ERROR_COMP_SPV.begin(), shader::COMPUTE_ERROR_COMP_SPV.end());
+    std::vector<std::uint32_t> reduce_shader(shader::REDUCE_ERROR_COMP_SPV.begin(), shader::REDUCE_ERROR_COMP_SPV.end());
+    std::shared_ptr<kp::Algorithm> error_algo  = mgr.algorithm({vec_A_u, vec_B_vt, mat_C, partials}, error_shader,
+                                                               kp::Workgroup({nb_error_groups, 1, 1}), {}, std::vector<std::uint32_t>{dim, scal_bits});
+    std::shared_ptr<kp::Algorithm> reduce_algo = mgr.algorithm({partials, error_out}, reduce_shader,
+                                                               kp::Workgroup({1, 1, 1}), {}, std::vector<std::uint32_t>{nb_error_groups});
+    auto beg_check = std::chrono::high_resolution_clock::now();
+    sq->eval<kp::OpAlgoDispatch>(error_algo);
+    sq->eval<kp::OpAlgoDispatch>(reduce_algo);
+    sq->eval<kp::OpSyncLocal>({error_out});
+    auto end_check = std::chrono::high_resolution_clock::now();
+    std::cout << "Temps vérification sur le périphérique (en secondes): "
+              << std::chrono::duration<double>(end_check - beg_check).count() << std::endl;
 
+    auto errors = error_out->vector();
+    if (errors[2] > 1.E-6)
+    {
+        std::cout << "Écart maximal trop grand sur C : " << std::sqrt(errors[2]) << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Erreur L2 relatif sur le résultat trouvé en Vulkan: " << std::sqrt(errors[0]/errors[1]) << std::endl;
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}